@@ -0,0 +1,231 @@
+#include "BatchScorer.h"
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define EQUATIX_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int N = GameRules::BoardSize;
+
+// Packed tile word: points with the piece premium in the low 16 bits, then
+// the number of unused double and triple equation squares, 8 bits each.
+constexpr int PointsMask = 0xffff;
+constexpr int DoubleShift = 16;
+constexpr int TripleShift = 24;
+
+constexpr uint32_t kPow3[16] = {1, 3, 9, 27, 81, 243, 729, 2187, 6561, 19683, 59049, 177147,
+                                531441, 1594323, 4782969, 14348907};
+
+inline uint32_t runScore(uint32_t w) {
+    return ((w & PointsMask) << ((w >> DoubleShift) & 0xff)) * kPow3[(w >> TripleShift) & 15];
+}
+
+void scoreScalar(const uint32_t* packed, const ScoreBatch& b, uint32_t* tileSums, uint32_t* runSums, int* out) {
+    size_t tiles = b.cells.size(), runs = b.runBounds.size() - 1, moves = b.moveBounds.size() - 1;
+    uint32_t acc = 0;
+    tileSums[0] = 0;
+    for (size_t i = 0; i < tiles; ++i) {
+        acc += packed[b.cells[i] << 4 | b.symbols[i]];
+        tileSums[i + 1] = acc;
+    }
+    acc = 0;
+    runSums[0] = 0;
+    for (size_t r = 0; r < runs; ++r) {
+        acc += runScore(tileSums[b.runBounds[r + 1]] - tileSums[b.runBounds[r]]);
+        runSums[r + 1] = acc;
+    }
+    for (size_t m = 0; m < moves; ++m)
+        out[m] = int(runSums[b.moveBounds[m + 1]] - runSums[b.moveBounds[m]]);
+}
+
+#ifdef EQUATIX_X86_KERNELS
+
+constexpr uint32_t kPow2[16] = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768};
+
+__attribute__((target("sse4.1")))
+inline __m128i scan4(__m128i x) {
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    return _mm_add_epi32(x, _mm_slli_si128(x, 8));
+}
+
+// SSE has no gathers, so lookups stay scalar; the sums and the unpacking
+// are vectorized.
+__attribute__((target("sse4.1")))
+void scoreSse41(const uint32_t* packed, const ScoreBatch& b, uint32_t* tileSums, uint32_t* runSums, int* out) {
+    size_t tiles = b.cells.size(), runs = b.runBounds.size() - 1, moves = b.moveBounds.size() - 1;
+    const uint8_t *c = b.cells.data(), *s = b.symbols.data();
+    const uint32_t *rb = b.runBounds.data(), *mb = b.moveBounds.data();
+
+    tileSums[0] = 0;
+    __m128i carry = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= tiles; i += 4) {
+        __m128i v = _mm_setr_epi32(int(packed[c[i] << 4 | s[i]]), int(packed[c[i+1] << 4 | s[i+1]]),
+                                   int(packed[c[i+2] << 4 | s[i+2]]), int(packed[c[i+3] << 4 | s[i+3]]));
+        v = _mm_add_epi32(scan4(v), carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(tileSums + 1 + i), v);
+        carry = _mm_shuffle_epi32(v, 0xff);
+    }
+    for (uint32_t acc = tileSums[i]; i < tiles; ++i) tileSums[i + 1] = acc += packed[c[i] << 4 | s[i]];
+
+    runSums[0] = 0;
+    carry = _mm_setzero_si128();
+    const __m128i points = _mm_set1_epi32(PointsMask), byte = _mm_set1_epi32(0xff);
+    size_t r = 0;
+    for (; r + 4 <= runs; r += 4) {
+        uint32_t w[4];
+        for (int k = 0; k < 4; ++k) w[k] = tileSums[rb[r + k + 1]] - tileSums[rb[r + k]];
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w));
+        __m128i d = _mm_and_si128(_mm_srli_epi32(v, DoubleShift), byte);
+        __m128i t = _mm_srli_epi32(v, TripleShift);
+        alignas(16) uint32_t dd[4], tt[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(dd), d);
+        _mm_store_si128(reinterpret_cast<__m128i*>(tt), t);
+        __m128i mul = _mm_setr_epi32(int(kPow2[dd[0] & 15] * kPow3[tt[0] & 15]), int(kPow2[dd[1] & 15] * kPow3[tt[1] & 15]),
+                                     int(kPow2[dd[2] & 15] * kPow3[tt[2] & 15]), int(kPow2[dd[3] & 15] * kPow3[tt[3] & 15]));
+        v = _mm_mullo_epi32(_mm_and_si128(v, points), mul);
+        v = _mm_add_epi32(scan4(v), carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(runSums + 1 + r), v);
+        carry = _mm_shuffle_epi32(v, 0xff);
+    }
+    for (uint32_t acc = runSums[r]; r < runs; ++r)
+        runSums[r + 1] = acc += runScore(tileSums[rb[r + 1]] - tileSums[rb[r]]);
+
+    for (size_t m = 0; m < moves; ++m) out[m] = int(runSums[mb[m + 1]] - runSums[mb[m]]);
+}
+
+__attribute__((target("avx2")))
+inline __m256i scan8(__m256i x) {
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+    // Carry the low half's total into the high half
+    __m256i t = _mm256_shuffle_epi32(x, 0xff);
+    return _mm256_add_epi32(x, _mm256_permute2x128_si256(t, t, 0x08));
+}
+
+__attribute__((target("avx2")))
+void scoreAvx2(const uint32_t* packed, const ScoreBatch& b, uint32_t* tileSums, uint32_t* runSums, int* out) {
+    size_t tiles = b.cells.size(), runs = b.runBounds.size() - 1, moves = b.moveBounds.size() - 1;
+    const uint8_t *c = b.cells.data(), *s = b.symbols.data();
+    const uint32_t *rb = b.runBounds.data(), *mb = b.moveBounds.data();
+    const int *sums = reinterpret_cast<const int*>(tileSums);
+    const __m256i last = _mm256_set1_epi32(7);
+
+    tileSums[0] = 0;
+    __m256i carry = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= tiles; i += 8) {
+        __m256i cell = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(c + i)));
+        __m256i sym = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + i)));
+        __m256i v = _mm256_i32gather_epi32(reinterpret_cast<const int*>(packed),
+                                           _mm256_or_si256(_mm256_slli_epi32(cell, 4), sym), 4);
+        v = _mm256_add_epi32(scan8(v), carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(tileSums + 1 + i), v);
+        carry = _mm256_permutevar8x32_epi32(v, last);
+    }
+    for (uint32_t acc = tileSums[i]; i < tiles; ++i) tileSums[i + 1] = acc += packed[c[i] << 4 | s[i]];
+
+    runSums[0] = 0;
+    carry = _mm256_setzero_si256();
+    const __m256i points = _mm256_set1_epi32(PointsMask), byte = _mm256_set1_epi32(0xff);
+    size_t r = 0;
+    for (; r + 8 <= runs; r += 8) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rb + r));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rb + r + 1));
+        __m256i v = _mm256_sub_epi32(_mm256_i32gather_epi32(sums, hi, 4), _mm256_i32gather_epi32(sums, lo, 4));
+        __m256i d = _mm256_and_si256(_mm256_srli_epi32(v, DoubleShift), byte);
+        __m256i t = _mm256_srli_epi32(v, TripleShift);
+        v = _mm256_sllv_epi32(_mm256_and_si256(v, points), d);
+        v = _mm256_mullo_epi32(v, _mm256_i32gather_epi32(reinterpret_cast<const int*>(kPow3), t, 4));
+        v = _mm256_add_epi32(scan8(v), carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(runSums + 1 + r), v);
+        carry = _mm256_permutevar8x32_epi32(v, last);
+    }
+    for (uint32_t acc = runSums[r]; r < runs; ++r)
+        runSums[r + 1] = acc += runScore(tileSums[rb[r + 1]] - tileSums[rb[r]]);
+
+    const int *rsums = reinterpret_cast<const int*>(runSums);
+    size_t m = 0;
+    for (; m + 8 <= moves; m += 8) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mb + m));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mb + m + 1));
+        __m256i v = _mm256_sub_epi32(_mm256_i32gather_epi32(rsums, hi, 4), _mm256_i32gather_epi32(rsums, lo, 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + m), v);
+    }
+    for (; m < moves; ++m) out[m] = int(runSums[mb[m + 1]] - runSums[mb[m]]);
+}
+
+#endif // EQUATIX_X86_KERNELS
+
+} // namespace
+
+void ScoreBatch::clear(const char* board) {
+    if (board) std::memcpy(m_board, board, sizeof m_board);
+    else std::memset(m_board, 0, sizeof m_board);
+    cells.clear();
+    symbols.clear();
+    runBounds.assign(1, 0);
+    moveBounds.assign(1, 0);
+}
+
+void ScoreBatch::add(const TilePlacement* tiles, int n) {
+    for (int i = 0; i < n; ++i) m_board[tiles[i].row*N + tiles[i].col] = tiles[i].ch;
+    ScoringRun runs[2 * GameRules::MaxRackTiles];
+    int count = GameRules::scoringRuns(m_board, tiles, n, runs);
+    for (int k = 0; k < count; ++k) {
+        const ScoringRun &run = runs[k];
+        for (int t = 0; t < run.length; ++t) {
+            int cell = run.vertical ? (run.start + t)*N + run.line : run.line*N + run.start + t;
+            addTile(cell, m_board[cell]);
+        }
+        endRun();
+    }
+    endMove();
+    for (int i = 0; i < n; ++i) m_board[tiles[i].row*N + tiles[i].col] = '\0';
+}
+
+BatchScorer::BatchScorer(const bool* multiplierUsed, const RuleEngine& rules) : m_kernel(bestKernel()) {
+    std::memset(m_packed, 0, sizeof m_packed);
+    for (int cell = 0; cell < GameRules::CellCount; ++cell) {
+        MultiplierType mt = multiplierUsed[cell] ? None : GameRules::multiplierAt(cell / N, cell % N);
+        uint32_t piece = mt == DoublePiece ? 2 : mt == TriplePiece ? 3 : 1;
+        uint32_t equation = mt == DoubleEquation ? 1u << DoubleShift : mt == TripleEquation ? 1u << TripleShift : 0;
+        for (int sym = 0; sym < GameRules::SymbolCount; ++sym)
+            m_packed[cell << 4 | sym] = uint32_t(rules.tileScore(GameRules::symbolChar(sym))) * piece | equation;
+    }
+}
+
+bool BatchScorer::supported(Kernel k) {
+#ifdef EQUATIX_X86_KERNELS
+    if (k == Kernel::Avx2) return __builtin_cpu_supports("avx2");
+    if (k == Kernel::Sse41) return __builtin_cpu_supports("sse4.1");
+#endif
+    return k == Kernel::Scalar;
+}
+
+BatchScorer::Kernel BatchScorer::bestKernel() {
+    static const Kernel best = supported(Kernel::Avx2) ? Kernel::Avx2
+                             : supported(Kernel::Sse41) ? Kernel::Sse41 : Kernel::Scalar;
+    return best;
+}
+
+const char* BatchScorer::kernelName(Kernel k) {
+    switch (k) {
+    case Kernel::Avx2: return "avx2";
+    case Kernel::Sse41: return "sse4.1";
+    default: return "scalar";
+    }
+}
+
+void BatchScorer::score(const ScoreBatch& batch, int* out) {
+    m_tileSums.resize(batch.cells.size() + 1);
+    m_runSums.resize(batch.runBounds.size());
+#ifdef EQUATIX_X86_KERNELS
+    if (m_kernel == Kernel::Avx2) return scoreAvx2(m_packed, batch, m_tileSums.data(), m_runSums.data(), out);
+    if (m_kernel == Kernel::Sse41) return scoreSse41(m_packed, batch, m_tileSums.data(), m_runSums.data(), out);
+#endif
+    scoreScalar(m_packed, batch, m_tileSums.data(), m_runSums.data(), out);
+}
@@ -0,0 +1,71 @@
+#ifndef BATCHSCORER_H
+#define BATCHSCORER_H
+
+#include "RuleVariants.h"
+#include <cstdint>
+#include <vector>
+
+// Candidate moves for one position in structure-of-arrays form, as input to
+// BatchScorer. Run r covers tiles [runBounds[r], runBounds[r+1]) of cells and
+// symbols; candidate m covers runs [moveBounds[m], moveBounds[m+1]).
+class ScoreBatch {
+public:
+    ScoreBatch() { clear(nullptr); }
+
+    // Start a batch on a board without any candidate's tiles.
+    void clear(const char* board);
+    // Append a candidate; its runs are the ones GameRules::scoreTurn counts.
+    void add(const TilePlacement* tiles, int n);
+    // Or build a candidate whose runs the caller already knows, run by run.
+    void addTile(int cell, char ch) {
+        cells.push_back(uint8_t(cell));
+        symbols.push_back(uint8_t(GameRules::symbolIndex(ch)));
+    }
+    void endRun() { runBounds.push_back(uint32_t(cells.size())); }
+    void endMove() { moveBounds.push_back(uint32_t(runBounds.size() - 1)); }
+    int size() const { return int(moveBounds.size()) - 1; }
+
+    std::vector<uint8_t> cells;         // GameRules cell index
+    std::vector<uint8_t> symbols;       // GameRules::symbolIndex
+    std::vector<uint32_t> runBounds;
+    std::vector<uint32_t> moveBounds;
+
+private:
+    char m_board[GameRules::CellCount];
+};
+
+// Scores a whole ScoreBatch in three passes over flat arrays:
+//   1. one table lookup per tile, keyed by cell and symbol, gives its points
+//      with the piece premium plus counts of equation premiums, packed into
+//      one 32-bit word; a running sum of these words follows
+//   2. each run's total is the difference of two running sums, unpacked and
+//      multiplied out
+//   3. each candidate's score is the difference of two running sums of runs
+// The words never carry between fields within a run, so differences of
+// wrapped sums are exact. Each pass has an AVX2 and an SSE4.1 version, chosen
+// at run time, and a scalar one for other CPUs.
+class BatchScorer {
+public:
+    enum class Kernel { Scalar, Sse41, Avx2 };
+
+    // multiplierUsed as for GameRules::scoreTurn; tile values from rules.
+    explicit BatchScorer(const bool* multiplierUsed, const RuleEngine& rules = RuleEngine::get(RuleVariant::Standard));
+
+    static bool supported(Kernel k);
+    static Kernel bestKernel();
+    static const char* kernelName(Kernel k);
+
+    Kernel kernel() const { return m_kernel; }
+    void setKernel(Kernel k) { if (supported(k)) m_kernel = k; }
+
+    // out gets batch.size() scores.
+    void score(const ScoreBatch& batch, int* out);
+
+private:
+    Kernel m_kernel;
+    uint32_t m_packed[GameRules::CellCount * 16];
+    std::vector<uint32_t> m_tileSums;   // scratch, running sums
+    std::vector<uint32_t> m_runSums;
+};
+
+#endif // BATCHSCORER_H
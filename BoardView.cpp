@@ -4,12 +4,28 @@
 #include <QDropEvent>
 #include <QMimeData>
 #include <QBrush>
+#include <QPainter>
 #include <QDebug>
+#include "TurnTrace.h"
 
 static const char* kMimeType = "application/x-equatix-tile";
 
+namespace {
+
+QColor multiplierColor(MultiplierType mt) {
+    switch (mt) {
+    case DoublePiece: return QColor(173,216,230);    // light blue
+    case TriplePiece: return QColor(0,191,255);      // deep sky blue
+    case DoubleEquation: return QColor(255,182,193); // light pink
+    case TripleEquation: return QColor(255,69,0);    // orange red
+    default: return QColor();
+    }
+}
+
+} // namespace
+
 BoardView::BoardView(int n, QWidget *parent)
-    : QTableWidget(n, n, parent), N(n)
+    : QTableWidget(n, n, parent), N(n), m_cells(n*n, '\0'), m_locked(n*n, false), m_used(n*n, false)
 {
     setAcceptDrops(true);
     setDragDropMode(QAbstractItemView::DropOnly);
@@ -19,68 +35,55 @@ BoardView::BoardView(int n, QWidget *parent)
     setEditTriggers(QAbstractItemView::NoEditTriggers);
     setFrameStyle(QFrame::NoFrame);
 
-    initializeMultipliers();
-
-    for (int r=0;r<N;++r) {
-        setRowHeight(r, 40);
-        setColumnWidth(r, 40);
-        for (int c=0;c<N;++c) {
-            QTableWidgetItem *it = new QTableWidgetItem("");
-            it->setTextAlignment(Qt::AlignCenter);
-            it->setData(Qt::UserRole+1, false); // locked?
-            it->setData(Qt::UserRole+3, false); // multiplier used?
-
-            MultiplierType mt = m_multiplierMap.value({r,c}, None);
-            it->setData(Qt::UserRole+2, mt);
-
-            // set base color for multiplier
-            switch(mt) {
-            case DoublePiece: it->setBackground(QColor(173,216,230)); break; // light blue
-            case TriplePiece: it->setBackground(QColor(0,191,255)); break;   // deep sky blue
-            case DoubleEquation: it->setBackground(QColor(255,182,193)); break; // light pink
-            case TripleEquation: it->setBackground(QColor(255,69,0)); break; // orange red
-            default: break;
-            }
-
-            setItem(r,c,it);
-        }
-    }
+    // Uniform sizes let the headers skip per-section bookkeeping
+    horizontalHeader()->setDefaultSectionSize(40);
+    verticalHeader()->setDefaultSectionSize(40);
 
-    setStyleSheet("QTableWidget::item{ font-weight: 700; font-size: 16px; }");
+    // A font instead of a style sheet keeps QStyleSheetStyle out of startup
+    QFont f = font();
+    f.setBold(true);
+    f.setPixelSize(16);
+    setFont(f);
 }
 
-void BoardView::initializeMultipliers() {
-    // Triple Equation (like triple word score)
-    QList<QPair<int,int>> tripleEq = {{0,0},{0,7},{0,14},{7,0},{7,14},{14,0},{14,7},{14,14}};
-    for (auto p : tripleEq) m_multiplierMap[p] = TripleEquation;
-
-    // Double Equation
-    QList<QPair<int,int>> doubleEq = {
-        {1,1},{2,2},{3,3},{4,4},{7,7},{10,10},{11,11},{12,12},{13,13},
-        {1,13},{2,12},{3,11},{4,10},{10,4},{11,3},{12,2},{13,1}
-    };
-    for (auto p : doubleEq) m_multiplierMap[p] = DoubleEquation;
+QTableWidgetItem* BoardView::tileItem(int r, int c, QChar ch) {
+    auto *it = new QTableWidgetItem(QString(ch));
+    it->setTextAlignment(Qt::AlignCenter);
+    setItem(r, c, it);
+    m_cells[r*N + c] = ch.toLatin1();
+    return it;
+}
 
-    // Triple Piece
-    QList<QPair<int,int>> triplePc = {
-        {1,5},{1,9},{5,1},{5,5},{5,9},{5,13},{9,1},{9,5},{9,9},{9,13},{13,5},{13,9}
-    };
-    for (auto p : triplePc) m_multiplierMap[p] = TriplePiece;
+void BoardView::removeTile(int r, int c) {
+    // The premium square, if any, shows through again
+    delete takeItem(r, c);
+    m_cells[r*N + c] = '\0';
+}
 
-    // Double Piece
-    QList<QPair<int,int>> doublePc = {
-        {0,3},{0,11},{2,6},{2,8},{3,0},{3,7},{3,14},
-        {6,2},{6,6},{6,8},{6,12},{7,3},{7,11},
-        {8,2},{8,6},{8,8},{8,12},{11,0},{11,7},{11,14},
-        {12,6},{12,8},{14,3},{14,11}
-    };
-    for (auto p : doublePc) m_multiplierMap[p] = DoublePiece;
+void BoardView::paintBackground() {
+    int s = horizontalHeader()->defaultSectionSize();
+    if (m_background.isNull() || m_backgroundCell != s) {
+        qreal dpr = viewport()->devicePixelRatioF();
+        m_background = QPixmap(QSize(s * N, s * N) * dpr);
+        m_background.setDevicePixelRatio(dpr);
+        m_background.fill(Qt::transparent);
+        QPainter p(&m_background);
+        for (int r = 0; r < N; ++r)
+            for (int c = 0; c < N; ++c) {
+                QColor color = multiplierColor(multiplierAt(r, c));
+                if (color.isValid()) p.fillRect(c * s, r * s, s, s, color);
+            }
+        m_backgroundCell = s;
+    }
+    QPainter p(viewport());
+    p.drawPixmap(columnViewportPosition(0), rowViewportPosition(0), m_background);
 }
 
 void BoardView::resizeEvent(QResizeEvent* e) {
     QTableWidget::resizeEvent(e);
     int s = qMax(1, qMin(width() / N, height() / N));
-    for (int i = 0; i < N; ++i) { setRowHeight(i, s); setColumnWidth(i, s); }
+    horizontalHeader()->setDefaultSectionSize(s);
+    verticalHeader()->setDefaultSectionSize(s);
     int gridW = s * N, gridH = s * N;
     int left  = qMax(0, (width()  - gridW) / 2);
     int top   = qMax(0, (height() - gridH) / 2);
@@ -88,6 +91,16 @@ void BoardView::resizeEvent(QResizeEvent* e) {
     viewport()->update();
 }
 
+bool BoardView::viewportEvent(QEvent* e) {
+    // QTableView paints from here, so this times the whole board repaint
+    if (e->type() == QEvent::Paint) {
+        TracePhase trace("repaint");
+        paintBackground();
+        return QTableWidget::viewportEvent(e);
+    }
+    return QTableWidget::viewportEvent(e);
+}
+
 void BoardView::dragEnterEvent(QDragEnterEvent* e) {
     if (e->mimeData()->hasFormat(kMimeType)) e->acceptProposedAction();
 }
@@ -105,30 +118,46 @@ void BoardView::dropEvent(QDropEvent* e) {
     int r = rowAt(pos.y());
     int c = columnAt(pos.x());
     if (r < 0 || c < 0) return;
-    QTableWidgetItem* it = item(r,c);
-    if (!it) return;
-    if (it->data(Qt::UserRole+1).toBool()) return; // locked
-    if (!it->text().isEmpty()) return; // occupied
     if (!e->mimeData()->hasFormat(kMimeType)) return;
 
     QByteArray ba = e->mimeData()->data(kMimeType);
     if (ba.isEmpty()) return;
     QChar ch(ba.at(0));
-    if (!isAllowed(ch)) return;
+    if (!placeTile(r, c, ch)) return;
+    e->acceptProposedAction();
+}
+
+bool BoardView::placeTile(int r, int c, QChar ch) {
+    if (!inside(r, c) || item(r, c)) return false; // occupied or locked
+    if (!isAllowed(ch)) return false;
 
-    it->setText(QString(ch));
-    it->setBackground(QColor(255,248,200)); // temporary highlight
+    tileItem(r, c, ch)->setBackground(QColor(255,248,200)); // temporary highlight
     m_newThisTurn.insert({r,c});
-    e->acceptProposedAction();
+    emit tilePlaced(r, c, ch);
+    return true;
+}
+
+void BoardView::restoreLockedTile(int r, int c, QChar ch) {
+    if (!inside(r, c)) return;
+    tileItem(r, c, ch)->setBackground(QColor(235,255,235)); // locked color
+    m_locked[r*N + c] = true;
+    m_used[r*N + c] = true;
+}
+
+void BoardView::clearLockedTile(int r, int c) {
+    if (!inside(r, c)) return;
+    removeTile(r, c);
+    m_locked[r*N + c] = false;
+    m_used[r*N + c] = false;
 }
 
 void BoardView::lockNewTiles() {
     for (auto rc : m_newThisTurn) {
         QTableWidgetItem* it = item(rc.first, rc.second);
         if (it) {
-            it->setData(Qt::UserRole+1, true);
+            m_locked[rc.first*N + rc.second] = true;
             // mark multiplier as used (consumed) when locking
-            it->setData(Qt::UserRole+3, true);
+            m_used[rc.first*N + rc.second] = true;
             it->setBackground(QColor(235,255,235)); // locked color
         }
     }
@@ -140,63 +169,29 @@ void BoardView::rollbackNewTiles(QList<QChar> &returned) {
         QTableWidgetItem* it = item(rc.first, rc.second);
         if (it && !it->text().isEmpty()) {
             returned.append(it->text().at(0));
-            it->setText("");
-
-            // restore multiplier color (only if multiplier not previously used)
-            bool used = it->data(Qt::UserRole+3).toBool();
-            MultiplierType mt = static_cast<MultiplierType>(it->data(Qt::UserRole+2).toInt());
-            if (!used) {
-                switch(mt) {
-                case DoublePiece: it->setBackground(QColor(173,216,230)); break;
-                case TriplePiece: it->setBackground(QColor(0,191,255)); break;
-                case DoubleEquation: it->setBackground(QColor(255,182,193)); break;
-                case TripleEquation: it->setBackground(QColor(255,69,0)); break;
-                default: it->setBackground(QBrush()); break;
-                }
-            } else {
-                // if multiplier already used, set a neutral background
-                it->setBackground(QBrush());
-            }
+            removeTile(rc.first, rc.second);
         }
     }
     m_newThisTurn.clear();
 }
 
 void BoardView::clearNewMarks() {
-    for (int r=0;r<N;++r) for (int c=0;c<N;++c) {
-            QTableWidgetItem* it = item(r,c);
-            if (it && !it->data(Qt::UserRole+1).toBool()) {
-                MultiplierType mt = static_cast<MultiplierType>(it->data(Qt::UserRole+2).toInt());
-                bool used = it->data(Qt::UserRole+3).toBool();
-                if (!used) {
-                    switch(mt) {
-                    case DoublePiece: it->setBackground(QColor(173,216,230)); break;
-                    case TriplePiece: it->setBackground(QColor(0,191,255)); break;
-                    case DoubleEquation: it->setBackground(QColor(255,182,193)); break;
-                    case TripleEquation: it->setBackground(QColor(255,69,0)); break;
-                    default: it->setBackground(QBrush()); break;
-                    }
-                } else {
-                    it->setBackground(QBrush());
-                }
-            }
-        }
+    // Drop the highlight; the square underneath shows through
+    for (auto rc : m_newThisTurn) {
+        QTableWidgetItem* it = item(rc.first, rc.second);
+        if (it && !m_locked[rc.first*N + rc.second]) it->setBackground(QBrush());
+    }
     m_newThisTurn.clear();
 }
 
 // Accessors for multipliers / used
 MultiplierType BoardView::multiplierAt(int r, int c) const {
-    QTableWidgetItem* it = item(r,c);
-    if (!it) return None;
-    return static_cast<MultiplierType>(it->data(Qt::UserRole+2).toInt());
+    // Layout lives in GameRules so offline tools score against the same board.
+    return inside(r, c) ? GameRules::multiplierAt(r, c) : None;
 }
 bool BoardView::multiplierUsedAt(int r, int c) const {
-    QTableWidgetItem* it = item(r,c);
-    if (!it) return false;
-    return it->data(Qt::UserRole+3).toBool();
+    return inside(r, c) && m_used[r*N + c];
 }
 void BoardView::setMultiplierUsedAt(int r, int c, bool used) {
-    QTableWidgetItem* it = item(r,c);
-    if (!it) return;
-    it->setData(Qt::UserRole+3, used);
+    if (inside(r, c)) m_used[r*N + c] = used;
 }
@@ -5,18 +5,16 @@
 #include <QTableWidget>
 #include <QSet>
 #include <QPair>
-#include <QMap>
+#include <QPixmap>
+#include <QVector>
+#include "GameRules.h"
 
 struct Placement { int row; int col; QChar ch; };
 
-enum MultiplierType {
-    None,
-    DoublePiece,
-    TriplePiece,
-    DoubleEquation,
-    TripleEquation
-};
-
+// Only squares holding a tile have a QTableWidgetItem; premium squares are
+// painted from one cached background pixmap, rebuilt when the cell size
+// changes. Tiles, locked and multiplier-used state are mirrored in plain
+// arrays, so the rules can read the board without touching the items.
 class BoardView : public QTableWidget {
     Q_OBJECT
 public:
@@ -27,24 +25,46 @@ public:
     void rollbackNewTiles(QList<QChar> &returned); // returns chars to rack
     void clearNewMarks();
 
+    // Put a tile on an empty square as part of the current turn.
+    bool placeTile(int r, int c, QChar ch);
+    // Put a tile from an earlier turn back on the board (autosave recovery),
+    // or take it off again when stepping back through the game.
+    void restoreLockedTile(int r, int c, QChar ch);
+    void clearLockedTile(int r, int c);
+
+    // Row-major as GameRules expects: '\0' for an empty square.
+    const char* cells() const { return m_cells.constData(); }
+    const bool* multipliersUsed() const { return m_used.constData(); }
+
     // accessors for multipliers / used status
     MultiplierType multiplierAt(int r, int c) const;
     bool multiplierUsedAt(int r, int c) const;
     void setMultiplierUsedAt(int r, int c, bool used);
 
+signals:
+    void tilePlaced(int row, int col, QChar ch);
+
 protected:
     void dragEnterEvent(QDragEnterEvent* e) override;
     void dragMoveEvent(QDragMoveEvent* e) override;
     void dropEvent(QDropEvent* e) override;
     void resizeEvent(QResizeEvent* e) override;
+    bool viewportEvent(QEvent* e) override;
 
 private:
     bool isAllowed(QChar ch) const;
-    void initializeMultipliers();
+    bool inside(int r, int c) const { return r >= 0 && r < N && c >= 0 && c < N; }
+    QTableWidgetItem* tileItem(int r, int c, QChar ch);
+    void removeTile(int r, int c);
+    void paintBackground();
 
     int N;
     QSet<QPair<int,int>> m_newThisTurn;
-    QMap<QPair<int,int>, MultiplierType> m_multiplierMap;
+    QVector<char> m_cells;
+    QVector<bool> m_locked;
+    QVector<bool> m_used;
+    QPixmap m_background;      // premium squares at the current cell size
+    int m_backgroundCell = 0;
 };
 
 #endif // BOARDVIEW_H
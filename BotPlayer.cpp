@@ -0,0 +1,205 @@
+#include "BotPlayer.h"
+#include "GameState.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using Rack = std::array<int, GameRules::SymbolCount>;
+
+// Tiles not on the board or our rack: the opponent's rack plus the bag.
+struct Unseen {
+    Rack counts;
+    int oppOthers;  // non-equals tiles on the opponent's rack
+    int oppEquals;
+};
+
+Unseen unseen(const GameState& game) {
+    Unseen u;
+    for (int s = 0; s < GameRules::SymbolCount; ++s)
+        u.counts[size_t(s)] = GameRules::tileCount(GameRules::symbolChar(s));
+    for (int i = 0; i < GameRules::CellCount; ++i)
+        if (char ch = game.board()[i]) --u.counts[size_t(GameRules::symbolIndex(ch))];
+    const int *own = game.rack(game.currentPlayer());
+    int others = 0;
+    for (int s = 0; s < GameRules::SymbolCount; ++s) {
+        u.counts[size_t(s)] -= own[s];
+        if (s != GameRules::EqualsSymbol) others += u.counts[size_t(s)];
+    }
+    const TileBag &bag = game.bag();
+    u.oppOthers = std::max(0, others - bag.otherTilesCount());
+    int bagEquals = GameRules::tileCount('=') - bag.equalsCursor();
+    u.oppEquals = std::max(0, u.counts[GameRules::EqualsSymbol] - bagEquals);
+    return u;
+}
+
+// A rack the opponent could be holding. Exact once the bag is empty.
+Rack sampleRack(const Unseen& u, std::mt19937_64& rng) {
+    int8_t pool[GameRules::CellCount];
+    int n = 0;
+    for (int s = 0; s < GameRules::OtherSymbolCount; ++s)
+        for (int k = 0; k < u.counts[size_t(s)]; ++k) pool[n++] = int8_t(s);
+    Rack rack {};
+    for (int i = 0; i < u.oppOthers && i < n; ++i) {
+        int j = i + int(rng() % uint64_t(n - i));
+        std::swap(pool[i], pool[j]);
+        ++rack[size_t(pool[i])];
+    }
+    rack[GameRules::EqualsSymbol] = u.oppEquals;
+    return rack;
+}
+
+// Of the k best moves, the one scoring most less the opponent's best reply,
+// averaged over racks. The same racks are used for every candidate.
+const Move& lookahead(const GameState& game, std::vector<Move>& moves, int k, const std::vector<Rack>& racks) {
+    k = std::min<int>(k, int(moves.size()));
+    std::partial_sort(moves.begin(), moves.begin() + k, moves.end(),
+                      [](const Move& a, const Move& b) { return a.score > b.score; });
+    char cells[GameRules::CellCount];
+    bool used[GameRules::CellCount];
+    const Move *best = &moves[0];
+    double bestValue = -1e9;
+    for (int i = 0; i < k; ++i) {
+        const Move &m = moves[size_t(i)];
+        std::memcpy(cells, game.board(), sizeof cells);
+        std::memcpy(used, game.multipliersUsed(), sizeof used);
+        for (int t = 0; t < m.count; ++t) {
+            int cell = m.tiles[t].row * GameRules::BoardSize + m.tiles[t].col;
+            cells[cell] = m.tiles[t].ch;
+            used[cell] = true;
+        }
+        long long replies = 0;
+        for (const Rack &r : racks) {
+            Move reply;
+            if (MoveGenerator(cells, used, r.data()).best(reply)) replies += reply.score;
+        }
+        double value = m.score - double(replies) / double(racks.size());
+        if (value > bestValue) {
+            bestValue = value;
+            best = &m;
+        }
+    }
+    return *best;
+}
+
+BotAction placing(const Move& m) {
+    BotAction a;
+    a.kind = BotAction::Place;
+    a.move = m;
+    return a;
+}
+
+class GreedyBot : public BotPlayer {
+public:
+    explicit GreedyBot(std::string name) : BotPlayer(std::move(name)) {}
+
+    BotAction choose(const GameState& game, std::mt19937_64&) const override {
+        Move m;
+        return MoveGenerator(game).best(m) ? placing(m) : swapOrPass(game);
+    }
+};
+
+class SimulationBot : public BotPlayer {
+public:
+    SimulationBot(std::string name, int candidates, int samples)
+        : BotPlayer(std::move(name)), m_candidates(candidates), m_samples(samples) {}
+
+    BotAction choose(const GameState& game, std::mt19937_64& rng) const override {
+        std::vector<Move> moves = MoveGenerator(game).all();
+        if (moves.empty()) return swapOrPass(game);
+        Unseen u = unseen(game);
+        std::vector<Rack> racks;
+        for (int i = 0; i < m_samples; ++i) racks.push_back(sampleRack(u, rng));
+        return placing(lookahead(game, moves, m_candidates, racks));
+    }
+
+private:
+    int m_candidates;
+    int m_samples;
+};
+
+class EndgameBot : public BotPlayer {
+public:
+    static constexpr int Samples = 8;   // while the bag still hides some tiles
+
+    EndgameBot(std::string name, int threshold, int candidates)
+        : BotPlayer(std::move(name)), m_threshold(threshold), m_candidates(candidates) {}
+
+    BotAction choose(const GameState& game, std::mt19937_64& rng) const override {
+        if (game.bag().otherTilesCount() > m_threshold) {
+            Move m;
+            return MoveGenerator(game).best(m) ? placing(m) : swapOrPass(game);
+        }
+        std::vector<Move> moves = MoveGenerator(game).all();
+        if (moves.empty()) return swapOrPass(game);
+        Unseen u = unseen(game);
+        std::vector<Rack> racks;
+        int samples = game.bag().otherTilesCount() == 0 ? 1 : Samples;
+        for (int i = 0; i < samples; ++i) racks.push_back(sampleRack(u, rng));
+        return placing(lookahead(game, moves, m_candidates, racks));
+    }
+
+private:
+    int m_threshold;
+    int m_candidates;
+};
+
+// "name:a:b" with both numbers optional and positive.
+bool parseSpec(const char* spec, const char* kind, int& a, int& b) {
+    size_t len = std::strlen(kind);
+    if (std::strncmp(spec, kind, len) != 0) return false;
+    const char *p = spec + len;
+    for (int *v : {&a, &b}) {
+        if (*p == '\0') return true;
+        if (*p != ':') return false;
+        char *end;
+        long x = std::strtol(p + 1, &end, 10);
+        if (end == p + 1 || x < 0 || x > 1000) return false;
+        *v = int(x);
+        p = end;
+    }
+    return *p == '\0';
+}
+
+} // namespace
+
+std::unique_ptr<BotPlayer> BotPlayer::create(const char* spec) {
+    if (std::strcmp(spec, "greedy") == 0) return std::make_unique<GreedyBot>(spec);
+    int candidates = 6, samples = 8;
+    if (parseSpec(spec, "sim", candidates, samples) && candidates > 0 && samples > 0)
+        return std::make_unique<SimulationBot>(spec, candidates, samples);
+    int threshold = 7;
+    candidates = 6;
+    if (parseSpec(spec, "endgame", threshold, candidates) && candidates > 0)
+        return std::make_unique<EndgameBot>(spec, threshold, candidates);
+    return nullptr;
+}
+
+bool BotPlayer::apply(GameState& game, const BotAction& action, int& points) {
+    points = 0;
+    switch (action.kind) {
+    case BotAction::Place: {
+        RuleCheck check;
+        return game.place(action.move.tiles, action.move.count, check, points);
+    }
+    case BotAction::Swap:
+        return game.swap(action.swap, action.swapCount);
+    case BotAction::Pass:
+        game.pass();
+        return true;
+    }
+    return false;
+}
+
+BotAction BotPlayer::swapOrPass(const GameState& game) {
+    BotAction a;
+    const int *rack = game.rack(game.currentPlayer());
+    int room = game.bag().otherTilesCount();
+    for (int s = 0; s < GameRules::OtherSymbolCount; ++s)
+        for (int k = 0; k < rack[s] && a.swapCount < room; ++k) a.swap[a.swapCount++] = GameRules::symbolChar(s);
+    a.kind = a.swapCount ? BotAction::Swap : BotAction::Pass;
+    return a;
+}
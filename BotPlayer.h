@@ -0,0 +1,55 @@
+#ifndef BOTPLAYER_H
+#define BOTPLAYER_H
+
+#include "MoveGenerator.h"
+#include <memory>
+#include <random>
+#include <string>
+
+class GameState;
+
+// What a bot does on its turn.
+struct BotAction {
+    enum Kind : uint8_t { Place, Swap, Pass };
+    Kind kind = Pass;
+    Move move;                                  // Place
+    char swap[GameRules::RackOthers] = {};      // Swap
+    int swapCount = 0;
+};
+
+// A computer player. Bots see only what a player at the table would: the
+// board, their own rack and the size of the bag. Anything random comes from
+// the rng passed in, so a game replays exactly from its seeds.
+//
+// Specs, as given to create():
+//   greedy             highest-scoring move
+//   sim[:K[:S]]        of the K best moves, the one that scores most after
+//                      the opponent's best reply, averaged over S racks the
+//                      opponent might hold (default 6, 8)
+//   endgame[:T[:K]]    greedy until the bag has T or fewer tiles (default 7),
+//                      then like sim over K moves against the racks the
+//                      opponent can hold, exactly once the bag is empty
+class BotPlayer {
+public:
+    virtual ~BotPlayer() = default;
+
+    const std::string& name() const { return m_name; }
+    virtual BotAction choose(const GameState& game, std::mt19937_64& rng) const = 0;
+
+    // nullptr if the spec is not understood.
+    static std::unique_ptr<BotPlayer> create(const char* spec);
+
+    // Play an action for the current player; false if the game rejects it.
+    static bool apply(GameState& game, const BotAction& action, int& points);
+
+protected:
+    explicit BotPlayer(std::string name) : m_name(std::move(name)) {}
+
+    // No move: swap the whole rack if the bag allows, else pass.
+    static BotAction swapOrPass(const GameState& game);
+
+private:
+    std::string m_name;
+};
+
+#endif // BOTPLAYER_H
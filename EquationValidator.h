@@ -5,21 +5,18 @@
 #include <QChar>
 #include <QString>
 #include "BoardView.h"
+#include "TurnInput.h"
 
 class EquationValidator {
 public:
-    // Validate all runs affected by new placements on board
-    // board: snapshot of chars (null QChar means empty)
-    // newPlacements: list of placements (row,col,ch)
-    // returns true if all affected runs with length>=2 that contain '=' are valid equations.
-    static bool validate(const QVector<QVector<QChar>>& board,
-                         const QSet<QPair<int,int>>& newTiles,
-                         QString &errorMessage);
+    // Copy the board and this turn's tiles into turn (see TurnInput::capture).
+    static void capture(const BoardView& board, TurnInput& turn);
+
+    // Message for a rejected turn, as shown to the player. The rules
+    // themselves live in GameRules::validate, run by GameState::place.
+    static QString describe(const RuleCheck& check, const char* board);
 private:
-    static QString readRunH(const QVector<QVector<QChar>>& b, int r, int c);
-    static QString readRunV(const QVector<QVector<QChar>>& b, int r, int c);
-    static bool isTrueEquation(const QString& run, QString &why);
-    static std::optional<long long> evalExpr(const QString& s);
+    static QString reason(EquationError why, long long lhs, long long rhs);
 };
 
 #endif // EQUATIONVALIDATOR_H
@@ -0,0 +1,155 @@
+#include "EquatixApi.h"
+#include "GameState.h"
+
+#include <cstring>
+#include <new>
+
+struct eqx_game {
+    explicit eqx_game(uint64_t seed, RuleVariant variant) : state(seed, variant) {}
+    GameState state;
+};
+
+static_assert(EQX_BOARD_SIZE == GameRules::BoardSize && EQX_CELL_COUNT == GameRules::CellCount);
+static_assert(EQX_SYMBOL_COUNT == GameRules::SymbolCount && EQX_MAX_TILES == GameRules::MaxRackTiles);
+static_assert(EQX_STATE_SIZE == sizeof(GameSnapshot));
+static_assert(EQX_TILE_UNAVAILABLE == int(RuleError::TileUnavailable));
+static_assert(EQX_VARIANT_WEIGHTED == int(RuleVariant::Weighted));
+
+namespace {
+
+// The caller's arrays as placements, on the stack
+bool gather(const int* rows, const int* cols, const char* symbols, int count, TilePlacement* tiles) {
+    if (!rows || !cols || !symbols || count < 0 || count > GameRules::MaxRackTiles) return false;
+    for (int i = 0; i < count; ++i) tiles[i] = TilePlacement{rows[i], cols[i], symbols[i]};
+    return true;
+}
+
+int report(const RuleCheck& check, int points, eqx_result* result) {
+    // RuleError values are the EQX_ rule errors
+    int error = int(check.error);
+    if (result) {
+        result->error = error;
+        result->score = error == EQX_OK ? points : 0;
+        result->vertical = check.vertical;
+        result->line = check.line;
+        result->start = check.start;
+        result->length = check.length;
+    }
+    return error;
+}
+
+int invalid(eqx_result* result) {
+    if (result) *result = eqx_result{EQX_INVALID_ARGUMENT, 0, 0, 0, 0, 0};
+    return EQX_INVALID_ARGUMENT;
+}
+
+} // namespace
+
+extern "C" {
+
+int eqx_abi_version(void) {
+    return EQX_ABI_VERSION;
+}
+
+eqx_game* eqx_game_create(uint64_t seed, int variant) {
+    if (variant < 0 || variant >= int(RuleVariant::Count)) return nullptr;
+    try {
+        return new eqx_game(seed, RuleVariant(variant));
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void eqx_game_destroy(eqx_game* game) {
+    delete game;
+}
+
+int eqx_validate(const eqx_game* game, const int* rows, const int* cols, const char* symbols, int count,
+                 eqx_result* result) {
+    TilePlacement tiles[GameRules::MaxRackTiles];
+    if (!game || !gather(rows, cols, symbols, count, tiles)) return invalid(result);
+    RuleCheck check;
+    int points = 0;
+    game->state.evaluate(tiles, count, check, points);
+    return report(check, points, result);
+}
+
+int eqx_score(const eqx_game* game, const int* rows, const int* cols, const char* symbols, int count) {
+    eqx_result result;
+    return eqx_validate(game, rows, cols, symbols, count, &result) == EQX_OK ? result.score : -1;
+}
+
+int eqx_apply(eqx_game* game, const int* rows, const int* cols, const char* symbols, int count,
+              eqx_result* result) {
+    TilePlacement tiles[GameRules::MaxRackTiles];
+    if (!game || !gather(rows, cols, symbols, count, tiles)) return invalid(result);
+    RuleCheck check;
+    int points = 0;
+    game->state.place(tiles, count, check, points);
+    return report(check, points, result);
+}
+
+int eqx_swap(eqx_game* game, const char* symbols, int count) {
+    if (!game || !symbols || count <= 0 || count > GameRules::RackOthers) return EQX_INVALID_ARGUMENT;
+    return game->state.swap(symbols, count) ? EQX_OK : EQX_CANNOT_SWAP;
+}
+
+int eqx_pass(eqx_game* game) {
+    if (!game) return EQX_INVALID_ARGUMENT;
+    game->state.pass();
+    return EQX_OK;
+}
+
+int eqx_current_player(const eqx_game* game) {
+    return game ? game->state.currentPlayer() : -1;
+}
+
+int eqx_player_score(const eqx_game* game, int player) {
+    return game && (player == 0 || player == 1) ? game->state.score(player) : -1;
+}
+
+int eqx_tiles_in_bag(const eqx_game* game) {
+    return game ? game->state.bag().otherTilesCount() : -1;
+}
+
+uint64_t eqx_position_hash(const eqx_game* game) {
+    return game ? game->state.positionHash() : 0;
+}
+
+int eqx_board(const eqx_game* game, char* cells) {
+    if (!game || !cells) return EQX_INVALID_ARGUMENT;
+    std::memcpy(cells, game->state.board(), GameRules::CellCount);
+    return EQX_OK;
+}
+
+int eqx_rack(const eqx_game* game, int player, int* counts) {
+    if (!game || !counts || (player != 0 && player != 1)) return EQX_INVALID_ARGUMENT;
+    std::memcpy(counts, game->state.rack(player), sizeof(int) * GameRules::SymbolCount);
+    return EQX_OK;
+}
+
+int eqx_game_save(const eqx_game* game, void* buffer, size_t size) {
+    if (!game || !buffer || size < sizeof(GameSnapshot)) return EQX_INVALID_ARGUMENT;
+    GameSnapshot snapshot;
+    if (!game->state.save(snapshot)) return EQX_BAD_STATE;
+    std::memcpy(buffer, &snapshot, sizeof snapshot);
+    return EQX_OK;
+}
+
+int eqx_game_restore(eqx_game* game, const void* buffer, size_t size) {
+    if (!game || !buffer || size < sizeof(GameSnapshot)) return EQX_INVALID_ARGUMENT;
+    GameSnapshot snapshot;
+    std::memcpy(&snapshot, buffer, sizeof snapshot);   // the caller's bytes need not be aligned
+    return game->state.restore(snapshot) ? EQX_OK : EQX_BAD_STATE;
+}
+
+eqx_game* eqx_game_load(const void* buffer, size_t size) {
+    eqx_game* game = eqx_game_create(0, EQX_VARIANT_STANDARD);
+    if (game && eqx_game_restore(game, buffer, size) != EQX_OK) {
+        delete game;
+        return nullptr;
+    }
+    return game;
+}
+
+} // extern "C"
@@ -0,0 +1,128 @@
+#ifndef EQUATIXAPI_H
+#define EQUATIXAPI_H
+
+/* Stable C interface to the rules engine, built as the equatix_rules shared
+ * library for services that validate and score moves in-process.
+ *
+ * A game is an opaque handle from eqx_game_create or eqx_game_load. Only
+ * those two allocate; every other call works in the handle and the caller's
+ * buffers. Calls on different games may run on different threads at once;
+ * a game itself is not locked, so one game is used by one thread at a time.
+ *
+ * Moves are given as parallel arrays: tile i is symbols[i] at (rows[i],
+ * cols[i]), rows and columns from 0 and symbols '0'-'9', '+', '-', '*', '/'
+ * and '='. The board is EQX_BOARD_SIZE squares a side, row-major.
+ *
+ * New functions may be added; existing ones, the struct layouts and the
+ * values below do not change while EQX_ABI_VERSION stays the same. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(EQUATIX_API_BUILD)
+#    define EQX_API __declspec(dllexport)
+#  else
+#    define EQX_API __declspec(dllimport)
+#  endif
+#else
+#  define EQX_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EQX_ABI_VERSION 1
+
+enum {
+    EQX_BOARD_SIZE = 15,
+    EQX_CELL_COUNT = 225,
+    EQX_SYMBOL_COUNT = 15,      /* rack counts: '0'-'9', '+', '-', '*', '/', '=' */
+    EQX_MAX_TILES = 8,          /* most tiles in one move */
+    EQX_STATE_SIZE = 384        /* bytes written by eqx_game_save */
+};
+
+/* Results. The rule errors match why a turn is rejected in the game. */
+enum {
+    EQX_OK = 0,
+    EQX_NO_TILES = 1,
+    EQX_NOT_CENTER = 2,         /* first move must cover the centre square */
+    EQX_NOT_IN_LINE = 3,        /* tiles must share a row or a column */
+    EQX_NOT_CONNECTED = 4,      /* later moves must touch an existing tile */
+    EQX_BAD_EQUATION = 5,       /* a run containing '=' is not a true equation */
+    EQX_CELL_UNAVAILABLE = 6,   /* off the board, occupied or named twice */
+    EQX_TILE_UNAVAILABLE = 7,   /* not on the mover's rack */
+    EQX_INVALID_ARGUMENT = 100, /* null pointer, bad count or buffer too small */
+    EQX_CANNOT_SWAP = 101,      /* tile not on the rack, '=' or bag too low */
+    EQX_BAD_STATE = 102         /* not a saved game, or one too long to save */
+};
+
+/* Rule variants, fixed when a game is created. */
+enum {
+    EQX_VARIANT_STANDARD = 0,
+    EQX_VARIANT_CLUB = 1,       /* '^', unary minus, chained equalities */
+    EQX_VARIANT_PLAIN = 2,      /* no parentheses */
+    EQX_VARIANT_WEIGHTED = 3    /* operator tiles scored by difficulty */
+};
+
+/* Outcome of checking a move. For EQX_BAD_EQUATION the failing run is row
+ * line from column start, or column line from row start when vertical. */
+typedef struct eqx_result {
+    int32_t error;              /* EQX_OK or a rule error */
+    int32_t score;              /* points the move scores, 0 unless EQX_OK */
+    int32_t vertical;
+    int32_t line;
+    int32_t start;
+    int32_t length;
+} eqx_result;
+
+typedef struct eqx_game eqx_game;
+
+EQX_API int eqx_abi_version(void);
+
+/* NULL if variant is unknown or memory runs out. */
+EQX_API eqx_game* eqx_game_create(uint64_t seed, int variant);
+EQX_API void eqx_game_destroy(eqx_game* game);
+
+/* Check and score a move for the player to move without playing it. Returns
+ * result->error; result may be NULL when only that is wanted. */
+EQX_API int eqx_validate(const eqx_game* game, const int* rows, const int* cols, const char* symbols,
+                         int count, eqx_result* result);
+
+/* Points the move would score, or -1 if it is not legal. */
+EQX_API int eqx_score(const eqx_game* game, const int* rows, const int* cols, const char* symbols, int count);
+
+/* Play a move: on EQX_OK the tiles are locked, the rack refilled and the
+ * turn passes. On any error the game is unchanged. */
+EQX_API int eqx_apply(eqx_game* game, const int* rows, const int* cols, const char* symbols, int count,
+                      eqx_result* result);
+
+/* Return count non-'=' tiles to the bag, draw replacements and pass the turn. */
+EQX_API int eqx_swap(eqx_game* game, const char* symbols, int count);
+EQX_API int eqx_pass(eqx_game* game);
+
+EQX_API int eqx_current_player(const eqx_game* game);    /* 0 or 1 */
+EQX_API int eqx_player_score(const eqx_game* game, int player);
+EQX_API int eqx_tiles_in_bag(const eqx_game* game);      /* non-'=' tiles left to draw */
+EQX_API uint64_t eqx_position_hash(const eqx_game* game);
+
+/* EQX_CELL_COUNT chars, '\0' for an empty square. */
+EQX_API int eqx_board(const eqx_game* game, char* cells);
+/* EQX_SYMBOL_COUNT counts in the order listed above. */
+EQX_API int eqx_rack(const eqx_game* game, int player, int* counts);
+
+/* The whole game in EQX_STATE_SIZE little-endian bytes, bag order included,
+ * so a loaded game draws exactly as the saved one would. */
+EQX_API int eqx_game_save(const eqx_game* game, void* buffer, size_t size);
+/* Replace a game with a saved one; on error it is unchanged. Restoring costs
+ * a few nanoseconds per tile for every swap the saved game has seen. */
+EQX_API int eqx_game_restore(eqx_game* game, const void* buffer, size_t size);
+/* A new game from saved bytes; NULL if they are not a saved game. */
+EQX_API eqx_game* eqx_game_load(const void* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EQUATIXAPI_H */
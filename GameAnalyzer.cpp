@@ -0,0 +1,76 @@
+#include "GameAnalyzer.h"
+#include "GameState.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+bool GameAnalyzer::positions(const uint8_t* data, size_t size, std::vector<AnalysisPosition>& out,
+                             const char** error) {
+    const char* why = nullptr;
+    GameRecordReader reader(data, size);
+    if (!reader.isValid()) {
+        why = "not a game record";
+    } else {
+        GameState game(reader.seed());
+        AnalysisPosition pos;
+        while (reader.next(pos.played)) {
+            std::memcpy(pos.board, game.board(), sizeof pos.board);
+            std::memcpy(pos.used, game.multipliersUsed(), sizeof pos.used);
+            std::memcpy(pos.rack, game.rack(game.currentPlayer()), sizeof pos.rack);
+            pos.player = game.currentPlayer();
+            ++pos.ply;
+
+            const RecordedMove& m = pos.played;
+            if (m.kind == MoveKind::Place) {
+                RuleCheck check;
+                int points = 0;
+                if (!game.place(m.tiles, m.count, check, points)) why = "illegal placement";
+                else if (points != m.score) why = "score mismatch";
+            } else if (!game.swap(m.swapped, m.count)) {
+                why = "illegal swap";
+            }
+            if (why) break;
+            out.push_back(pos);
+        }
+        if (!why && reader.truncated()) why = "truncated record";
+    }
+    if (error) *error = why;
+    return why == nullptr;
+}
+
+PlyAnalysis GameAnalyzer::analyze(const AnalysisPosition& pos) {
+    PlyAnalysis a;
+    a.ply = pos.ply;
+    a.player = pos.player;
+    a.kind = pos.played.kind;
+    a.played = a.kind == MoveKind::Place ? pos.played.score : 0;
+
+    // One pass: best() would walk the moves again just to rank the one played
+    int better = 0;
+    MoveGenerator(pos.board, pos.used, pos.rack).forEach([&](const Move& m) {
+        ++a.moves;
+        if (m.score > a.played) ++better;
+        if (a.best.count == 0 || m.score > a.best.score) a.best = m;
+        return true;
+    });
+    a.rank = better + 1;
+    return a;
+}
+
+void GameAnalyzer::analyze(const AnalysisPosition* pos, size_t n, PlyAnalysis* out, unsigned threads) {
+    threads = unsigned(std::min<size_t>(std::max(1u, threads), n));
+    if (threads <= 1) {
+        for (size_t i = 0; i < n; ++i) out[i] = analyze(pos[i]);
+        return;
+    }
+    // Positions are claimed one at a time: late-game boards cost far more
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        for (size_t i; (i = next++) < n;) out[i] = analyze(pos[i]);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (auto& th : pool) th.join();
+}
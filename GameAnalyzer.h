@@ -0,0 +1,53 @@
+#ifndef GAMEANALYZER_H
+#define GAMEANALYZER_H
+
+#include "GameRecord.h"
+#include "MoveGenerator.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Post-game analysis: for every move of a recorded game, the best move the
+// mover had and how far the move played fell short of it.
+//
+// A record is replayed once through GameState to collect the position before
+// each move; positions are independent after that, so they are analyzed in
+// parallel. Equity is points: the rules value nothing beyond the score.
+
+// The position before one recorded move.
+struct AnalysisPosition {
+    char board[GameRules::CellCount];
+    bool used[GameRules::CellCount];
+    int rack[GameRules::SymbolCount];   // the mover's, by GameRules::symbolIndex
+    int ply = 0;                        // 1-based move number
+    int player = 0;
+    RecordedMove played;
+};
+
+struct PlyAnalysis {
+    int ply = 0;
+    int player = 0;
+    MoveKind kind = MoveKind::Place;
+    int played = 0;     // points scored, 0 for a swap
+    Move best;          // count 0 if no placement was possible
+    int rank = 0;       // 1 + moves that score more than the one played
+    int moves = 0;      // placements MoveGenerator found
+
+    int lost() const { return best.score > played ? best.score - played : 0; }
+};
+
+class GameAnalyzer {
+public:
+    // Append the position before every move of a record to out. Returns false
+    // if the record does not replay; error tells why, and the positions up to
+    // the failing move are kept.
+    static bool positions(const uint8_t* data, size_t size, std::vector<AnalysisPosition>& out,
+                          const char** error = nullptr);
+
+    static PlyAnalysis analyze(const AnalysisPosition& pos);
+
+    // out[i] for pos[i], split over up to threads threads.
+    static void analyze(const AnalysisPosition* pos, size_t n, PlyAnalysis* out, unsigned threads);
+};
+
+#endif // GAMEANALYZER_H
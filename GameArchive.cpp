@@ -0,0 +1,267 @@
+#include "GameArchive.h"
+#include "GameRecord.h"
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+const char kHeaderMagic[8] = {'E','Q','X','A','R','C','H','1'};
+const char kTrailerMagic[8] = {'E','Q','X','A','I','D','X','1'};
+constexpr uint64_t kHeaderSize = 16;
+constexpr uint32_t kVersion = 1;
+
+uint64_t indexBytes(uint32_t games, uint64_t positions) {
+    return (uint64_t(games) + 1) * 8 + 8 + positions * sizeof(ArchivePosition);
+}
+
+// A trailer ending at `end` whose index fits exactly between records and trailer.
+bool readTrailer(const uint8_t* data, uint64_t size, uint64_t end, ArchiveTrailer& t) {
+    if (end < kHeaderSize + sizeof t || end > size || end % 8) return false;
+    std::memcpy(&t, data + end - sizeof t, sizeof t);
+    if (std::memcmp(t.magic, kTrailerMagic, 8) != 0) return false;
+    uint64_t trailerPos = end - sizeof t;
+    if (t.indexOffset % 8 || t.indexOffset < kHeaderSize || t.indexOffset >= trailerPos) return false;
+    if (t.prevEnd >= t.indexOffset || (t.prevEnd && t.prevEnd < kHeaderSize)) return false;
+    if (t.gameCount > UINT32_MAX - t.firstGame) return false;
+    uint64_t countPos = t.indexOffset + (uint64_t(t.gameCount) + 1) * 8;
+    if (countPos + 8 > trailerPos) return false;
+    uint64_t positions;
+    std::memcpy(&positions, data + countPos, 8);
+    return positions <= (trailerPos - countPos - 8) / sizeof(ArchivePosition)
+        && t.indexOffset + indexBytes(t.gameCount, positions) == trailerPos;
+}
+
+// Record offsets of a read trailer's segment run in order from the previous
+// trailer to the index, so every record lies inside the segment.
+bool offsetsInOrder(const uint8_t* data, const ArchiveTrailer& t) {
+    uint64_t last = t.prevEnd ? t.prevEnd : kHeaderSize;
+    for (uint64_t i = 0; i <= t.gameCount; ++i) {
+        uint64_t offset;
+        std::memcpy(&offset, data + t.indexOffset + i * 8, 8);
+        if (offset < last) return false;
+        last = offset;
+    }
+    return last <= t.indexOffset;
+}
+
+} // namespace
+
+uint64_t GameArchive::findTail(const uint8_t* data, uint64_t size) {
+    ArchiveTrailer t;
+    for (uint64_t end = size & ~uint64_t(7); end >= kHeaderSize + sizeof t; end -= 8) {
+        if (readTrailer(data, size, end, t)) return end;
+    }
+    return 0;
+}
+
+bool GameArchive::open(const char* path) {
+    close();
+    if (!m_file.open(path)) return false;
+    const uint8_t* data = m_file.data();
+    uint64_t size = m_file.size();
+    if (size < kHeaderSize || std::memcmp(data, kHeaderMagic, 8) != 0) {
+        close();
+        return false;
+    }
+
+    for (uint64_t end = findTail(data, size); end; ) {
+        ArchiveTrailer t;
+        if (!readTrailer(data, size, end, t) || !offsetsInOrder(data, t)) {
+            close();
+            return false;
+        }
+        Segment s;
+        s.firstGame = t.firstGame;
+        s.gameCount = t.gameCount;
+        s.offsets = reinterpret_cast<const uint64_t*>(data + t.indexOffset);
+        std::memcpy(&s.positionCount, data + t.indexOffset + (uint64_t(t.gameCount) + 1) * 8, 8);
+        s.positions = reinterpret_cast<const ArchivePosition*>(data + t.indexOffset + (uint64_t(t.gameCount) + 2) * 8);
+        m_segments.push_back(s);
+        end = t.prevEnd;
+    }
+    std::reverse(m_segments.begin(), m_segments.end());
+    // game() finds a segment by its first id, so ids must follow on
+    for (const Segment& s : m_segments) {
+        if (s.firstGame != m_gameCount) {
+            close();
+            return false;
+        }
+        m_gameCount += s.gameCount;
+    }
+    return true;
+}
+
+void GameArchive::close() {
+    m_file.close();
+    m_segments.clear();
+    m_gameCount = 0;
+}
+
+ArchivedGame GameArchive::game(uint32_t id) const {
+    auto it = std::upper_bound(m_segments.begin(), m_segments.end(), id,
+                               [](uint32_t g, const Segment& s) { return g < s.firstGame; });
+    if (it == m_segments.begin() || id >= m_gameCount) return ArchivedGame();
+    const Segment& s = *(it - 1);
+    uint32_t i = id - s.firstGame;
+    return {id, m_file.data() + s.offsets[i], size_t(s.offsets[i+1] - s.offsets[i])};
+}
+
+std::vector<ArchivePosition> GameArchive::findPosition(uint64_t hash) const {
+    std::vector<ArchivePosition> hits;
+    for (const Segment& s : m_segments) {
+        const ArchivePosition* end = s.positions + s.positionCount;
+        const ArchivePosition* it = std::lower_bound(s.positions, end, hash,
+            [](const ArchivePosition& p, uint64_t h) { return p.hash < h; });
+        for (; it != end && it->hash == hash; ++it) hits.push_back(*it);
+    }
+    return hits;
+}
+
+GameArchive::Iterator GameArchive::begin() const {
+    size_t seg = 0;
+    while (seg < m_segments.size() && m_segments[seg].gameCount == 0) ++seg;
+    return Iterator(this, seg, 0);
+}
+
+ArchivedGame GameArchive::Iterator::operator*() const {
+    const Segment& s = m_archive->m_segments[m_seg];
+    return {s.firstGame + m_idx, m_archive->m_file.data() + s.offsets[m_idx],
+            size_t(s.offsets[m_idx+1] - s.offsets[m_idx])};
+}
+
+GameArchive::Iterator& GameArchive::Iterator::operator++() {
+    const auto& segs = m_archive->m_segments;
+    if (++m_idx >= segs[m_seg].gameCount) {
+        m_idx = 0;
+        do ++m_seg; while (m_seg < segs.size() && segs[m_seg].gameCount == 0);
+    }
+    return *this;
+}
+
+GameArchiveWriter::~GameArchiveWriter() {
+    close();
+}
+
+bool GameArchiveWriter::open(const char* path) {
+    close();
+    uint64_t tail = 0, size = 0;
+    {
+        MappedFile existing;
+        if (existing.open(path)) {
+            size = existing.size();
+            if (size < kHeaderSize || std::memcmp(existing.data(), kHeaderMagic, 8) != 0) return false;
+            tail = GameArchive::findTail(existing.data(), size);
+            if (tail) {
+                ArchiveTrailer t;
+                std::memcpy(&t, existing.data() + tail - sizeof t, sizeof t);
+                if (!offsetsInOrder(existing.data(), t)) return false;
+                m_nextGame = t.firstGame + t.gameCount;
+            }
+        }
+    }
+
+    if (size) {
+        m_file = std::fopen(path, "r+b");
+        if (!m_file) return false;
+        m_end = tail ? tail : kHeaderSize;
+        m_prevEnd = tail;
+        // drop a torn tail from an interrupted commit
+        if (size > m_end && ftruncate(fileno(m_file), off_t(m_end)) != 0) {
+            close();
+            return false;
+        }
+    } else {
+        m_file = std::fopen(path, "w+b");
+        if (!m_file) return false;
+        uint32_t versionAndPad[2] = {kVersion, 0};
+        std::fwrite(kHeaderMagic, 1, 8, m_file);
+        std::fwrite(versionAndPad, 4, 2, m_file);
+        m_end = kHeaderSize;
+        m_prevEnd = 0;
+        m_nextGame = 0;
+    }
+    return true;
+}
+
+bool GameArchiveWriter::add(const uint8_t* record, size_t size) {
+    GameRecordReader reader(record, size);
+    if (!m_file || !reader.isValid()) return false;
+
+    uint32_t game = gameCount();
+    size_t firstPosition = m_pendingPositions.size();
+    uint64_t hash = 0;
+    uint32_t ply = 0;
+    RecordedMove move;
+    while (reader.next(move)) {
+        ++ply;
+        if (move.kind != MoveKind::Place) continue; // swaps leave the board unchanged
+        for (int i = 0; i < move.count; ++i) {
+            const TilePlacement& t = move.tiles[i];
+            hash ^= GameRules::zobrist(t.row * GameRules::BoardSize + t.col, GameRules::symbolIndex(t.ch));
+        }
+        m_pendingPositions.push_back({hash, game, ply});
+    }
+    if (reader.truncated()) {
+        m_pendingPositions.resize(firstPosition);
+        return false;
+    }
+
+    m_pendingOffsets.push_back(m_end + m_pending.size());
+    m_pending.insert(m_pending.end(), record, record + size);
+    return true;
+}
+
+bool GameArchiveWriter::commit() {
+    if (!m_file) return false;
+    if (m_pendingOffsets.empty()) return true;
+
+    // The pending state is left as it was, so a failed commit can be retried
+    uint32_t games = uint32_t(m_pendingOffsets.size());
+    uint64_t recordsEnd = m_end + m_pending.size();
+    static const uint8_t kPadding[8] = {};
+    size_t padding = size_t((8 - recordsEnd % 8) % 8);
+    uint64_t indexOffset = recordsEnd + padding;
+
+    std::sort(m_pendingPositions.begin(), m_pendingPositions.end(),
+              [](const ArchivePosition& a, const ArchivePosition& b) {
+                  if (a.hash != b.hash) return a.hash < b.hash;
+                  return a.game != b.game ? a.game < b.game : a.ply < b.ply;
+              });
+    uint64_t positions = m_pendingPositions.size();
+
+    ArchiveTrailer t;
+    std::memcpy(t.magic, kTrailerMagic, 8);
+    t.indexOffset = indexOffset;
+    t.prevEnd = m_prevEnd;
+    t.firstGame = m_nextGame;
+    t.gameCount = games;
+
+    bool ok = std::fseek(m_file, long(m_end), SEEK_SET) == 0
+        && std::fwrite(m_pending.data(), 1, m_pending.size(), m_file) == m_pending.size()
+        && std::fwrite(kPadding, 1, padding, m_file) == padding
+        && std::fwrite(m_pendingOffsets.data(), 8, m_pendingOffsets.size(), m_file) == m_pendingOffsets.size()
+        && std::fwrite(&recordsEnd, 8, 1, m_file) == 1
+        && std::fwrite(&positions, 8, 1, m_file) == 1
+        && std::fwrite(m_pendingPositions.data(), sizeof(ArchivePosition), positions, m_file) == positions
+        && std::fwrite(&t, sizeof t, 1, m_file) == 1
+        && std::fflush(m_file) == 0
+        && fsync(fileno(m_file)) == 0;
+    if (!ok) return false;
+
+    m_end = indexOffset + indexBytes(games, positions) + sizeof t;
+    m_prevEnd = m_end;
+    m_nextGame += games;
+    m_pending.clear();
+    m_pendingOffsets.clear();
+    m_pendingPositions.clear();
+    return true;
+}
+
+bool GameArchiveWriter::close() {
+    if (!m_file) return true;
+    bool ok = commit();
+    ok = std::fclose(m_file) == 0 && ok;
+    m_file = nullptr;
+    return ok;
+}
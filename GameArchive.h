@@ -0,0 +1,120 @@
+#ifndef GAMEARCHIVE_H
+#define GAMEARCHIVE_H
+
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Append-only archive of game records (see GameRecord.h) for bulk analysis.
+//
+//   header   "EQXARCH1" u32 version u32 0
+//   segment* records, then the segment index, then a trailer
+//
+// Each GameArchiveWriter::commit() appends one segment. Its index holds the
+// file offsets of its records and every (position hash, game, ply) reached in
+// them, sorted by hash. The trailer points at the index and at the previous
+// trailer, so readers walk the chain from the end of the file and never touch
+// record bytes they do not ask for. Everything is little-endian and 8-byte
+// aligned so the mapped file is used in place.
+
+struct ArchiveTrailer {
+    char magic[8];          // "EQXAIDX1"
+    uint64_t indexOffset;
+    uint64_t prevEnd;       // end of the previous trailer, 0 for the first segment
+    uint32_t firstGame;
+    uint32_t gameCount;
+};
+
+struct ArchivePosition {
+    uint64_t hash;          // GameState::positionHash() after the move
+    uint32_t game;
+    uint32_t ply;           // 1-based move number within the game
+};
+
+static_assert(sizeof(ArchiveTrailer) == 32, "archive trailer layout");
+static_assert(sizeof(ArchivePosition) == 16, "archive position layout");
+
+struct ArchivedGame {
+    uint32_t id = 0;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+class GameArchiveWriter {
+public:
+    ~GameArchiveWriter();
+
+    // Create the archive or reopen it for appending. A torn tail left by an
+    // interrupted commit is cut back to the last complete segment; a last
+    // segment whose record offsets leave it is refused.
+    bool open(const char* path);
+
+    // Queue a record for the next segment. Rejects undecodable records.
+    bool add(const uint8_t* record, size_t size);
+
+    // Write pending records, their index and a trailer, then fsync. On
+    // failure the records stay pending and commit() may be retried.
+    bool commit();
+    bool close();
+
+    uint32_t gameCount() const { return m_nextGame + uint32_t(m_pendingOffsets.size()); }
+
+private:
+    std::FILE* m_file = nullptr;
+    uint64_t m_end = 0;             // end of the last complete segment
+    uint64_t m_prevEnd = 0;
+    uint32_t m_nextGame = 0;        // id of the first pending game
+    std::vector<uint8_t> m_pending;
+    std::vector<uint64_t> m_pendingOffsets;
+    std::vector<ArchivePosition> m_pendingPositions;
+};
+
+class GameArchive {
+public:
+    // Fails unless every segment's record offsets stay inside it and game
+    // ids run on from one segment to the next.
+    bool open(const char* path);
+    void close();
+
+    uint32_t gameCount() const { return m_gameCount; }
+    ArchivedGame game(uint32_t id) const;
+    size_t bytes() const { return m_file.size(); }
+
+    // Every (game, ply) that reached the position, in game order per segment.
+    std::vector<ArchivePosition> findPosition(uint64_t hash) const;
+
+    // Streaming, zero-copy iteration over all games in id order.
+    class Iterator {
+    public:
+        ArchivedGame operator*() const;
+        Iterator& operator++();
+        bool operator!=(const Iterator& o) const { return m_seg != o.m_seg || m_idx != o.m_idx; }
+    private:
+        friend class GameArchive;
+        Iterator(const GameArchive* a, size_t seg, uint32_t idx) : m_archive(a), m_seg(seg), m_idx(idx) {}
+        const GameArchive* m_archive;
+        size_t m_seg;
+        uint32_t m_idx;
+    };
+    Iterator begin() const;
+    Iterator end() const { return Iterator(this, m_segments.size(), 0); }
+
+    // Locate the last complete trailer in [data, data+size); 0 if none.
+    static uint64_t findTail(const uint8_t* data, uint64_t size);
+
+private:
+    struct Segment {
+        uint32_t firstGame;
+        uint32_t gameCount;
+        const uint64_t* offsets;    // gameCount + 1 entries
+        const ArchivePosition* positions;
+        uint64_t positionCount;
+    };
+
+    MappedFile m_file;
+    std::vector<Segment> m_segments;
+    uint32_t m_gameCount = 0;
+};
+
+#endif // GAMEARCHIVE_H
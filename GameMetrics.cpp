@@ -0,0 +1,163 @@
+#include "GameMetrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+constexpr int kRuleErrors = int(RuleError::TileUnavailable) + 1;
+constexpr int kEquationErrors = int(EquationError::Unequal) + 1;
+
+// Upper bounds; the last bucket of each histogram is +Inf.
+constexpr int kScoreBounds[] = {0, 5, 10, 20, 30, 50, 75, 100, 150, 250};
+constexpr int kDepletionBounds[] = {60, 120, 300, 600, 900, 1200, 1800, 3600};
+constexpr int kScoreBuckets = int(std::size(kScoreBounds)) + 1;
+constexpr int kDepletionBuckets = int(std::size(kDepletionBounds)) + 1;
+
+enum Slot {
+    kValidations,
+    kRejectRule,                                        // + RuleError
+    kRejectEquation = kRejectRule + kRuleErrors,        // + EquationError, for BadEquation
+    kSwaps = kRejectEquation + kEquationErrors,
+    kScore,                                             // + bucket, non-cumulative
+    kScoreSum = kScore + kScoreBuckets,
+    kDepletion,
+    kDepletionMsSum = kDepletion + kDepletionBuckets,
+    kSlotCount
+};
+
+const char* const kRuleReasons[kRuleErrors] = {
+    nullptr, "no_tiles", "not_center", "not_in_line", "not_connected",
+    nullptr, "cell_unavailable", "tile_unavailable"
+};
+const char* const kEquationReasons[kEquationErrors] = {
+    "bad_equation", "equals_count", "missing_side", "lhs_invalid", "rhs_invalid", "unequal"
+};
+
+// Own cache line per thread so neighbouring shards never share one
+struct alignas(64) Shard {
+    std::atomic<uint64_t> slots[kSlotCount] = {};
+};
+
+std::mutex g_registryMutex;
+std::vector<std::unique_ptr<Shard>> g_shards;   // outlive their threads so counts never go back
+thread_local Shard* t_shard = nullptr;
+
+Shard& shard() {
+    if (!t_shard) {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        g_shards.push_back(std::make_unique<Shard>());
+        t_shard = g_shards.back().get();
+    }
+    return *t_shard;
+}
+
+// Only the owning thread writes a shard, so no read-modify-write is needed
+void add(int slot, uint64_t n = 1) {
+    std::atomic<uint64_t> &v = shard().slots[slot];
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+template <size_t N>
+int bucketOf(const int (&bounds)[N], long long value) {
+    int b = 0;
+    while (b < int(N) && value > bounds[b]) ++b;
+    return b;
+}
+
+void appendf(std::string& out, const char* fmt, auto... args) {
+    char line[256];
+    int n = std::snprintf(line, sizeof line, fmt, args...);
+    if (n > 0) out.append(line, size_t(std::min(n, int(sizeof line) - 1)));
+}
+
+template <size_t N>
+void appendHistogram(std::string& out, const char* name, const char* help, const uint64_t* totals,
+                     const int (&bounds)[N], double sum) {
+    appendf(out, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    uint64_t cumulative = 0;
+    for (size_t b = 0; b < N; ++b) {
+        cumulative += totals[b];
+        appendf(out, "%s_bucket{le=\"%d\"} %llu\n", name, bounds[b], (unsigned long long)cumulative);
+    }
+    cumulative += totals[N];
+    appendf(out, "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)cumulative);
+    appendf(out, "%s_sum %g\n%s_count %llu\n", name, sum, name, (unsigned long long)cumulative);
+}
+
+} // namespace
+
+void GameMetrics::recordValidation(const RuleCheck& check) {
+    add(kValidations);
+    if (check.error == RuleError::BadEquation) add(kRejectEquation + int(check.why));
+    else if (check.error != RuleError::None) add(kRejectRule + int(check.error));
+}
+
+void GameMetrics::recordScore(int points) {
+    add(kScore + bucketOf(kScoreBounds, points));
+    add(kScoreSum, uint64_t(std::max(points, 0)));
+}
+
+void GameMetrics::recordSwap() {
+    add(kSwaps);
+}
+
+void GameMetrics::recordBagDepleted(double seconds) {
+    add(kDepletion + bucketOf(kDepletionBounds, (long long)std::ceil(seconds)));
+    add(kDepletionMsSum, uint64_t(std::max(seconds, 0.0) * 1000.0));
+}
+
+std::string GameMetrics::prometheusText() {
+    uint64_t t[kSlotCount] = {};
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (const auto &s : g_shards)
+            for (int i = 0; i < kSlotCount; ++i) t[i] += s->slots[i].load(std::memory_order_relaxed);
+    }
+
+    std::string out;
+    out.reserve(2048);
+    appendf(out, "# HELP equatix_validations_total Turns checked against the rules.\n"
+                 "# TYPE equatix_validations_total counter\n"
+                 "equatix_validations_total %llu\n", (unsigned long long)t[kValidations]);
+
+    appendf(out, "# HELP equatix_rejections_total Rejected turns by reason.\n"
+                 "# TYPE equatix_rejections_total counter\n");
+    for (int e = 0; e < kRuleErrors; ++e)
+        if (kRuleReasons[e])
+            appendf(out, "equatix_rejections_total{reason=\"%s\"} %llu\n",
+                    kRuleReasons[e], (unsigned long long)t[kRejectRule + e]);
+    for (int e = 0; e < kEquationErrors; ++e)
+        appendf(out, "equatix_rejections_total{reason=\"%s\"} %llu\n",
+                kEquationReasons[e], (unsigned long long)t[kRejectEquation + e]);
+
+    appendHistogram(out, "equatix_turn_score", "Points scored per accepted turn.",
+                    t + kScore, kScoreBounds, double(t[kScoreSum]));
+
+    appendf(out, "# HELP equatix_swaps_total Turns spent swapping tiles.\n"
+                 "# TYPE equatix_swaps_total counter\n"
+                 "equatix_swaps_total %llu\n", (unsigned long long)t[kSwaps]);
+
+    appendHistogram(out, "equatix_bag_depletion_seconds", "Time from the start of a game until the bag ran out.",
+                    t + kDepletion, kDepletionBounds, double(t[kDepletionMsSum]) / 1000.0);
+    return out;
+}
+
+bool GameMetrics::writeTextfile(const char* path) {
+    std::string text = prometheusText();
+    std::string tmp = std::string(path) + ".tmp";
+    std::FILE *f = std::fopen(tmp.c_str(), "w");
+    if (!f) return false;
+    bool ok = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
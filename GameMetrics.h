@@ -0,0 +1,33 @@
+#ifndef GAMEMETRICS_H
+#define GAMEMETRICS_H
+
+#include "GameRules.h"
+#include <string>
+
+// Gameplay counters and histograms for the server and kiosk builds, exported
+// in the Prometheus text format. Each thread increments its own shard with
+// plain relaxed stores; a scrape sums the shards, so recording never
+// contends with other threads or with the exporter.
+//
+// Exported series:
+//   equatix_validations_total                 turns checked against the rules
+//   equatix_rejections_total{reason=...}      failed checks by RuleError/EquationError
+//   equatix_turn_score                        histogram of points per accepted turn
+//   equatix_swaps_total
+//   equatix_bag_depletion_seconds             histogram, game start to empty bag
+class GameMetrics {
+public:
+    // One call per checked turn; a failed check also counts its reason.
+    static void recordValidation(const RuleCheck& check);
+    static void recordScore(int points);
+    static void recordSwap();
+    static void recordBagDepleted(double seconds);
+
+    static std::string prometheusText();
+
+    // For node_exporter's textfile collector: written to path.tmp, then
+    // renamed so a scrape never sees a partial file.
+    static bool writeTextfile(const char* path);
+};
+
+#endif // GAMEMETRICS_H
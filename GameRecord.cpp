@@ -0,0 +1,139 @@
+#include "GameRecord.h"
+#include "GameState.h"
+#include <cstring>
+
+static const char kMagic[4] = {'E', 'Q', 'X', 'R'};
+
+GameRecordWriter::GameRecordWriter(uint64_t seed) {
+    m_bytes.reserve(256);
+    for (char ch : kMagic) m_bytes.push_back(uint8_t(ch));
+    putVarint(Version);
+    putVarint(seed);
+}
+
+void GameRecordWriter::putVarint(uint64_t v) {
+    while (v >= 0x80) {
+        m_bytes.push_back(uint8_t(v) | 0x80);
+        v >>= 7;
+    }
+    m_bytes.push_back(uint8_t(v));
+}
+
+uint32_t GameRecordWriter::cursorOf(const TileBag& bag) {
+    return uint32_t(bag.otherCursor()) << 4 | uint32_t(bag.equalsCursor());
+}
+
+void GameRecordWriter::addPlacement(const TilePlacement* tiles, int n, int score, const TileBag& bag) {
+    m_bytes.push_back(uint8_t(MoveKind::Place));
+    putVarint(uint64_t(n));
+    for (int i = 0; i < n; ++i) {
+        int cell = tiles[i].row * GameRules::BoardSize + tiles[i].col;
+        putVarint(uint64_t(cell) << 4 | uint64_t(GameRules::symbolIndex(tiles[i].ch)));
+    }
+    putVarint(uint64_t(score));
+    putVarint(cursorOf(bag));
+    ++m_moves;
+}
+
+void GameRecordWriter::addSwap(const char* tiles, int n, const TileBag& bag) {
+    m_bytes.push_back(uint8_t(MoveKind::Swap));
+    putVarint(uint64_t(n));
+    for (int i = 0; i < n; ++i) m_bytes.push_back(uint8_t(GameRules::symbolIndex(tiles[i])));
+    putVarint(cursorOf(bag));
+    ++m_moves;
+}
+
+GameRecordReader::GameRecordReader(const uint8_t* data, size_t size)
+    : m_p(data), m_end(data + size)
+{
+    uint64_t version = 0;
+    if (size < 4 || std::memcmp(data, kMagic, 4) != 0) return;
+    m_p += 4;
+    m_valid = getVarint(version) && version == GameRecordWriter::Version && getVarint(m_seed);
+}
+
+bool GameRecordReader::getVarint(uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (m_p == m_end) return false;
+        uint8_t b = *m_p++;
+        v |= uint64_t(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+bool GameRecordReader::next(RecordedMove& move) {
+    if (!m_valid || m_p == m_end) return false;
+    // Anything that fails below is a malformed or cut-off record
+    m_truncated = true;
+    uint8_t kind = *m_p++;
+    uint64_t count = 0, v = 0;
+    if (kind > uint8_t(MoveKind::Swap) || !getVarint(count) || count > GameRules::MaxRackTiles) return false;
+    move.kind = MoveKind(kind);
+    move.count = int(count);
+    move.score = 0;
+
+    if (move.kind == MoveKind::Place) {
+        for (int i = 0; i < move.count; ++i) {
+            if (!getVarint(v) || (v >> 4) >= uint64_t(GameRules::CellCount)) return false;
+            int cell = int(v >> 4);
+            char ch = GameRules::symbolChar(int(v & 0xf));
+            if (!ch) return false;
+            move.tiles[i] = {cell / GameRules::BoardSize, cell % GameRules::BoardSize, ch};
+        }
+        if (!getVarint(v)) return false;
+        move.score = int(v);
+    } else {
+        for (int i = 0; i < move.count; ++i) {
+            if (m_p == m_end) return false;
+            char ch = GameRules::symbolChar(*m_p++);
+            if (!ch) return false;
+            move.swapped[i] = ch;
+        }
+    }
+    if (!getVarint(v)) return false;
+    move.cursor = uint32_t(v);
+    m_truncated = false;
+    return true;
+}
+
+ReplayResult GameReplayer::replay(const uint8_t* data, size_t size) {
+    ReplayResult result;
+    GameRecordReader reader(data, size);
+    if (!reader.isValid()) {
+        result.error = "not a game record";
+        return result;
+    }
+
+    GameState game(reader.seed());
+    RecordedMove move;
+    while (reader.next(move)) {
+        if (move.kind == MoveKind::Place) {
+            RuleCheck check;
+            int points = 0;
+            if (!game.place(move.tiles, move.count, check, points)) {
+                result.error = "illegal placement";
+                break;
+            }
+            if (points != move.score) {
+                result.error = "score mismatch";
+                break;
+            }
+        } else if (!game.swap(move.swapped, move.count)) {
+            result.error = "illegal swap";
+            break;
+        }
+        if (GameRecordWriter::cursorOf(game.bag()) != move.cursor) {
+            result.error = "bag cursor mismatch";
+            break;
+        }
+        ++result.plies;
+    }
+    if (!result.error && reader.truncated()) result.error = "truncated record";
+
+    result.ok = result.error == nullptr;
+    result.scores[0] = game.score(0);
+    result.scores[1] = game.score(1);
+    return result;
+}
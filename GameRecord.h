@@ -0,0 +1,91 @@
+#ifndef GAMERECORD_H
+#define GAMERECORD_H
+
+#include "GameRules.h"
+#include "TileBag.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compact binary game record.
+//
+//   "EQXR"  varint version  varint seed
+//   per move:
+//     byte kind (0 = place, 1 = swap)  varint count
+//     place: count x varint(cell << 4 | symbol)  varint score
+//     swap:  count x byte symbol
+//     varint bag cursor (otherCursor << 4 | equalsCursor) after the move
+//
+// Cells are row * BoardSize + col and symbols are GameRules::symbolIndex.
+// The initial racks and every draw follow from the seed, so they are not stored.
+
+enum class MoveKind : uint8_t { Place = 0, Swap = 1 };
+
+struct RecordedMove {
+    MoveKind kind = MoveKind::Place;
+    int count = 0;
+    TilePlacement tiles[GameRules::MaxRackTiles];  // Place
+    char swapped[GameRules::MaxRackTiles];         // Swap
+    int score = 0;
+    uint32_t cursor = 0;
+};
+
+class GameRecordWriter {
+public:
+    static constexpr uint32_t Version = 1;
+
+    explicit GameRecordWriter(uint64_t seed);
+
+    void addPlacement(const TilePlacement* tiles, int n, int score, const TileBag& bag);
+    void addSwap(const char* tiles, int n, const TileBag& bag);
+
+    const std::vector<uint8_t>& bytes() const { return m_bytes; }
+    int moves() const { return m_moves; }
+
+    static uint32_t cursorOf(const TileBag& bag);
+
+private:
+    void putVarint(uint64_t v);
+
+    std::vector<uint8_t> m_bytes;
+    int m_moves = 0;
+};
+
+// Zero-copy reader over a record held in memory.
+class GameRecordReader {
+public:
+    GameRecordReader(const uint8_t* data, size_t size);
+
+    bool isValid() const { return m_valid; }
+    uint64_t seed() const { return m_seed; }
+
+    // Decode the next move. Returns false at the end of the record or on
+    // malformed input; truncated() tells the two apart.
+    bool next(RecordedMove& move);
+    bool truncated() const { return m_truncated; }
+
+private:
+    bool getVarint(uint64_t& v);
+
+    const uint8_t* m_p;
+    const uint8_t* m_end;
+    uint64_t m_seed = 0;
+    bool m_valid = false;
+    bool m_truncated = false;
+};
+
+struct ReplayResult {
+    bool ok = false;
+    int plies = 0;          // moves re-applied successfully
+    const char* error = nullptr;
+    int scores[2] = {0, 0};
+};
+
+// Re-applies every move of a record through GameState and checks that each
+// one is legal and that its score and bag cursor match the record.
+class GameReplayer {
+public:
+    static ReplayResult replay(const uint8_t* data, size_t size);
+};
+
+#endif // GAMERECORD_H
@@ -0,0 +1,540 @@
+#include "GameRules.h"
+#include "RuleVariants.h"
+#include <climits>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
+namespace {
+
+struct Cell { int r, c; };
+
+// Triple Equation (like triple word score)
+constexpr Cell kTripleEq[] = {{0,0},{0,7},{0,14},{7,0},{7,14},{14,0},{14,7},{14,14}};
+
+// Double Equation
+constexpr Cell kDoubleEq[] = {
+    {1,1},{2,2},{3,3},{4,4},{7,7},{10,10},{11,11},{12,12},{13,13},
+    {1,13},{2,12},{3,11},{4,10},{10,4},{11,3},{12,2},{13,1}
+};
+
+// Triple Piece
+constexpr Cell kTriplePc[] = {
+    {1,5},{1,9},{5,1},{5,5},{5,9},{5,13},{9,1},{9,5},{9,9},{9,13},{13,5},{13,9}
+};
+
+// Double Piece
+constexpr Cell kDoublePc[] = {
+    {0,3},{0,11},{2,6},{2,8},{3,0},{3,7},{3,14},
+    {6,2},{6,6},{6,8},{6,12},{7,3},{7,11},
+    {8,2},{8,6},{8,8},{8,12},{11,0},{11,7},{11,14},
+    {12,6},{12,8},{14,3},{14,11}
+};
+
+struct MultiplierLayout {
+    MultiplierType cells[GameRules::BoardSize][GameRules::BoardSize] {};
+    constexpr MultiplierLayout() {
+        for (auto p : kTripleEq) cells[p.r][p.c] = TripleEquation;
+        for (auto p : kDoubleEq) cells[p.r][p.c] = DoubleEquation;
+        for (auto p : kTriplePc) cells[p.r][p.c] = TriplePiece;
+        for (auto p : kDoublePc) cells[p.r][p.c] = DoublePiece;
+    }
+};
+
+constexpr MultiplierLayout kLayout;
+
+// Fixed splitmix64 stream so hashes stored in archives stay valid across builds.
+struct ZobristTable {
+    uint64_t keys[GameRules::CellCount][GameRules::SymbolCount] {};
+    constexpr ZobristTable() {
+        uint64_t x = 0x45515541544958ull; // "EQUATIX"
+        for (auto &cell : keys) {
+            for (auto &key : cell) {
+                uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+                key = z ^ (z >> 31);
+            }
+        }
+    }
+};
+
+constexpr ZobristTable kZobrist;
+
+constexpr char kSymbols[GameRules::SymbolCount + 1] = "0123456789+-*/=";
+
+// 'u' is unary minus: below '^' so that -2^2 is -4, above * and /.
+template <class Syntax>
+int precedence(char op) {
+    if (op == '+' || op == '-') return 1;
+    if (op == '*' || op == '/') return 2;
+    if constexpr (Syntax::UnaryMinus) if (op == 'u') return 3;
+    if constexpr (Syntax::Exponent) if (op == '^') return 4;
+    return 0;
+}
+
+template <class Syntax>
+bool rightAssociative(char op) {
+    return (Syntax::Exponent && op == '^') || (Syntax::UnaryMinus && op == 'u');
+}
+
+// Checked arithmetic: false where the result does not fit in a long long.
+bool checkedAdd(long long a, long long b, long long& out) {
+    if (b > 0 ? a > LLONG_MAX - b : a < LLONG_MIN - b) return false;
+    out = a + b;
+    return true;
+}
+
+bool checkedSub(long long a, long long b, long long& out) {
+    if (b < 0 ? a > LLONG_MAX + b : a < LLONG_MIN + b) return false;
+    out = a - b;
+    return true;
+}
+
+bool checkedMul(long long a, long long b, long long& out) {
+    if (a != 0 && b != 0) {
+        bool overflow = a > 0 ? (b > 0 ? a > LLONG_MAX / b : b < LLONG_MIN / a)
+                              : (b > 0 ? a < LLONG_MIN / b : a < LLONG_MAX / b);
+        if (overflow) return false;
+    }
+    out = a * b;
+    return true;
+}
+
+// Integer power; fails on a negative exponent or overflow.
+bool power(long long a, long long b, long long& out) {
+    if (b < 0) return false;
+    if (a == 0 || a == 1 || b == 0) {
+        out = b == 0 ? 1 : a;
+        return true;
+    }
+    if (a == -1) {
+        out = b % 2 ? -1 : 1;
+        return true;
+    }
+    long long r = 1;
+    for (long long i = 0; i < b; ++i)   // |a| >= 2, so at most 63 rounds
+        if (!checkedMul(r, a, r)) return false;
+    out = r;
+    return true;
+}
+
+} // namespace
+
+int GameRules::symbolIndex(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    switch (ch) {
+    case '+': return 10;
+    case '-': return 11;
+    case '*': return 12;
+    case '/': return 13;
+    case '=': return EqualsSymbol;
+    default: return -1;
+    }
+}
+
+char GameRules::symbolChar(int index) {
+    if (index < 0 || index >= SymbolCount) return '\0';
+    return kSymbols[index];
+}
+
+int GameRules::tileCount(char ch) {
+    // Distribution: digits heavy, ops fewer, equals some
+    if (ch >= '0' && ch <= '9') return 6; // 60 digits
+    switch (ch) {
+    case '+': return 10;
+    case '-': return 10;
+    case '*': return 8;
+    case '/': return 8;
+    case '=': return 12;
+    default: return 0;
+    }
+}
+
+uint64_t GameRules::zobrist(int cell, int symbol) {
+    return kZobrist.keys[cell][symbol];
+}
+
+MultiplierType GameRules::multiplierAt(int r, int c) {
+    if (r < 0 || c < 0 || r >= BoardSize || c >= BoardSize) return None;
+    return kLayout.cells[r][c];
+}
+
+int GameRules::baseTileScore(char ch) {
+    return StandardScoring::tileScore(ch);
+}
+
+std::optional<long long> GameRules::evalExpr(const char* s, int n) {
+    return StandardRules::evalExpr(s, n);
+}
+
+EquationError GameRules::checkEquation(const char* s, int n, long long* lhs, long long* rhs) {
+    return StandardRules::checkEquation(s, n, lhs, rhs);
+}
+
+bool GameRules::validate(const char* board, const TilePlacement* tiles, int n, RuleCheck& check) {
+    return StandardRules::validate(board, tiles, n, check);
+}
+
+int GameRules::scoreTurn(const char* board, const bool* multiplierUsed, const TilePlacement* tiles, int n) {
+    return StandardRules::scoreTurn(board, multiplierUsed, tiles, n);
+}
+
+template <class Syntax, class Equality, class Scoring>
+std::optional<long long> RuleSet<Syntax, Equality, Scoring>::evalExpr(const char* s, int n) {
+    // Shunting-yard over the raw chars. Stacks never hold more than n entries,
+    // so board-sized runs stay on the stack frame.
+    constexpr int kInline = 64;
+    long long valsInline[kInline];
+    char opsInline[kInline];
+    std::unique_ptr<long long[]> valsHeap;
+    std::unique_ptr<char[]> opsHeap;
+    long long* vals = valsInline;
+    char* ops = opsInline;
+    if (n > kInline) {
+        valsHeap.reset(new long long[n]);
+        opsHeap.reset(new char[n]);
+        vals = valsHeap.get();
+        ops = opsHeap.get();
+    }
+    int nv = 0, no = 0;
+
+    auto apply = [&](char op)->bool {
+        if constexpr (Syntax::UnaryMinus) {
+            if (op == 'u') {
+                if (nv < 1) return false;
+                return checkedSub(0, vals[nv-1], vals[nv-1]);
+            }
+        }
+        if (nv < 2) return false;
+        long long b = vals[--nv];
+        long long a = vals[--nv];
+        long long res = 0;
+        // Overflow makes the expression invalid rather than wrapping
+        if (op == '+') {
+            if (!checkedAdd(a, b, res)) return false;
+        } else if (op == '-') {
+            if (!checkedSub(a, b, res)) return false;
+        } else if (op == '*') {
+            if (!checkedMul(a, b, res)) return false;
+        } else if (op == '/') {
+            if (b == 0 || (b == -1 && a == LLONG_MIN)) return false;
+            if (a % b != 0) return false; // require exact division
+            res = a / b;
+        } else if (Syntax::Exponent && op == '^') {
+            if (!power(a, b, res)) return false;
+        } else return false;
+        vals[nv++] = res;
+        return true;
+    };
+
+    int i = 0;
+    bool expectOperand = true;  // only read for unary minus
+    while (i < n) {
+        char ch = s[i];
+        if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') { ++i; continue; }
+        if (ch >= '0' && ch <= '9') {
+            long long v = 0;
+            while (i < n && s[i] >= '0' && s[i] <= '9') {
+                if (v > (LLONG_MAX - 9) / 10) return std::nullopt; // literal overflow
+                v = v * 10 + (s[i] - '0');
+                ++i;
+            }
+            vals[nv++] = v;
+            expectOperand = false;
+        } else if (Syntax::Parentheses && ch == '(') {
+            ops[no++] = '(';
+            ++i;
+            expectOperand = true;
+        } else if (Syntax::Parentheses && ch == ')') {
+            while (no > 0 && ops[no-1] != '(') {
+                if (!apply(ops[--no])) return std::nullopt;
+            }
+            if (no == 0) return std::nullopt;
+            --no; // pop '('
+            ++i;
+            expectOperand = false;
+        } else if (Syntax::UnaryMinus && ch == '-' && expectOperand) {
+            ops[no++] = 'u';    // prefix: nothing to its left to reduce
+            ++i;
+        } else if (ch != 'u' && precedence<Syntax>(ch) > 0) {
+            int p = precedence<Syntax>(ch);
+            bool right = rightAssociative<Syntax>(ch);
+            while (no > 0 && ops[no-1] != '(') {
+                int top = precedence<Syntax>(ops[no-1]);
+                if (top < p || (right && top == p)) break;
+                if (!apply(ops[--no])) return std::nullopt;
+            }
+            ops[no++] = ch;
+            ++i;
+            expectOperand = true;
+        } else {
+            return std::nullopt;
+        }
+    }
+    while (no > 0) {
+        if (ops[no-1] == '(') return std::nullopt;
+        if (!apply(ops[--no])) return std::nullopt;
+    }
+    if (nv != 1) return std::nullopt;
+    return vals[0];
+}
+
+template <class Syntax, class Equality, class Scoring>
+EquationError RuleSet<Syntax, Equality, Scoring>::checkEquation(const char* s, int n, long long* lhs, long long* rhs) {
+    if constexpr (Equality::Chained) {
+        // Every part between '=' signs must evaluate to the first one
+        if (!std::memchr(s, '=', size_t(n))) return EquationError::EqualsCount;
+        int start = 0;
+        std::optional<long long> first;
+        for (int i = 0; i <= n; ++i) {
+            if (i < n && s[i] != '=') continue;
+            if (i == start) return EquationError::MissingSide;
+            auto v = evalExpr(s + start, i - start);
+            if (!v) return first ? EquationError::RhsInvalid : EquationError::LhsInvalid;
+            if (!first) {
+                first = v;
+                if (lhs) *lhs = *v;
+            } else if (*v != *first) {
+                if (rhs) *rhs = *v;
+                return EquationError::Unequal;
+            }
+            if (rhs) *rhs = *v;
+            start = i + 1;
+        }
+        return EquationError::None;
+    }
+    int eqCount = 0, idx = -1;
+    for (int i = 0; i < n; ++i) {
+        if (s[i] == '=') {
+            if (idx < 0) idx = i;
+            ++eqCount;
+        }
+    }
+    if (eqCount != 1) return EquationError::EqualsCount;
+    if (idx <= 0 || idx >= n-1) return EquationError::MissingSide;
+    auto lv = evalExpr(s, idx);
+    if (!lv) return EquationError::LhsInvalid;
+    auto rv = evalExpr(s + idx + 1, n - idx - 1);
+    if (!rv) return EquationError::RhsInvalid;
+    if (lhs) *lhs = *lv;
+    if (rhs) *rhs = *rv;
+    return *lv == *rv ? EquationError::None : EquationError::Unequal;
+}
+
+namespace {
+
+constexpr int N = GameRules::BoardSize;
+
+// Contiguous run through (r,c) across or down: first index along the line and length.
+struct Run { int start; int length; };
+
+Run runAcross(const char* b, int r, int c) {
+    int start = c;
+    while (start-1 >= 0 && b[r*N + start-1]) --start;
+    int end = c;
+    while (end+1 < N && b[r*N + end+1]) ++end;
+    return {start, end - start + 1};
+}
+
+Run runDown(const char* b, int r, int c) {
+    int start = r;
+    while (start-1 >= 0 && b[(start-1)*N + c]) --start;
+    int end = r;
+    while (end+1 < N && b[(end+1)*N + c]) ++end;
+    return {start, end - start + 1};
+}
+
+// Copy a run into buf and report whether it holds an '='.
+bool readRun(const char* b, bool vertical, int line, Run run, char* buf) {
+    bool hasEquals = false;
+    for (int i = 0; i < run.length; ++i) {
+        char ch = vertical ? b[(run.start + i)*N + line] : b[line*N + run.start + i];
+        buf[i] = ch;
+        hasEquals |= ch == '=';
+    }
+    return hasEquals;
+}
+
+// Runs already handled this turn, keyed by orientation, line and start.
+struct RunSet {
+    int keys[2 * GameRules::CellCount];
+    int size = 0;
+    bool insert(bool vertical, int line, int start) {
+        int key = (vertical ? GameRules::CellCount : 0) + line*N + start;
+        for (int i = 0; i < size; ++i) if (keys[i] == key) return false;
+        keys[size++] = key;
+        return true;
+    }
+};
+
+} // namespace
+
+template <class Syntax, class Equality, class Scoring>
+bool RuleSet<Syntax, Equality, Scoring>::validate(const char* board, const TilePlacement* tiles, int n, RuleCheck& check) {
+    constexpr int CellCount = GameRules::CellCount;
+    constexpr int Center = GameRules::Center;
+    check = RuleCheck();
+    if (n <= 0) {
+        check.error = RuleError::NoTiles;
+        return false;
+    }
+
+    bool isNew[CellCount] = {};
+    for (int i = 0; i < n; ++i) {
+        if (tiles[i].row < 0 || tiles[i].row >= N || tiles[i].col < 0 || tiles[i].col >= N) {
+            check.error = RuleError::CellUnavailable;
+            return false;
+        }
+        isNew[tiles[i].row*N + tiles[i].col] = true;
+    }
+
+    // --- 1. Check if there are old tiles
+    bool anyOldTile = false;
+    for (int i = 0; i < CellCount && !anyOldTile; ++i)
+        anyOldTile = board[i] && !isNew[i];
+
+    // --- 2. First move must touch center
+    if (!anyOldTile && !isNew[Center*N + Center]) {
+        check.error = RuleError::NotCenter;
+        return false;
+    }
+
+    // --- 3. New tiles must be in one line
+    bool sameRow = true, sameCol = true;
+    for (int i = 1; i < n; ++i) {
+        sameRow &= tiles[i].row == tiles[0].row;
+        sameCol &= tiles[i].col == tiles[0].col;
+    }
+    if (!(sameRow || sameCol)) {
+        check.error = RuleError::NotInLine;
+        return false;
+    }
+
+    // --- 4. If not first move, must touch at least one existing tile
+    if (anyOldTile) {
+        auto old = [&](int r, int c) {
+            return r >= 0 && r < N && c >= 0 && c < N && board[r*N + c] && !isNew[r*N + c];
+        };
+        bool connected = false;
+        for (int i = 0; i < n && !connected; ++i) {
+            int r = tiles[i].row, c = tiles[i].col;
+            connected = old(r-1, c) || old(r+1, c) || old(r, c-1) || old(r, c+1);
+        }
+        if (!connected) {
+            check.error = RuleError::NotConnected;
+            return false;
+        }
+    }
+
+    // --- 5. Validate all equations formed
+    RunSet checked;
+    char buf[N];
+    for (int i = 0; i < n; ++i) {
+        int r = tiles[i].row, c = tiles[i].col;
+        for (bool vertical : {false, true}) {
+            int line = vertical ? c : r;
+            Run run = vertical ? runDown(board, r, c) : runAcross(board, r, c);
+            if (run.length < 2 || !readRun(board, vertical, line, run, buf)) continue;
+            if (!checked.insert(vertical, line, run.start)) continue;
+            EquationError why = checkEquation(buf, run.length, &check.lhs, &check.rhs);
+            if (why != EquationError::None) {
+                check.error = RuleError::BadEquation;
+                check.vertical = vertical;
+                check.line = line;
+                check.start = run.start;
+                check.length = run.length;
+                check.why = why;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template <class Syntax, class Equality, class Scoring>
+int RuleSet<Syntax, Equality, Scoring>::scoreTurn(const char* board, const bool* multiplierUsed, const TilePlacement* tiles, int n) {
+    // Calculate score for all distinct equations (horizontal and vertical) that are formed/affected by new tiles.
+    RunSet counted;
+    char buf[N];
+    int total = 0;
+    for (int i = 0; i < n; ++i) {
+        int r = tiles[i].row, c = tiles[i].col;
+        for (bool vertical : {false, true}) {
+            int line = vertical ? c : r;
+            Run run = vertical ? runDown(board, r, c) : runAcross(board, r, c);
+            if (run.length < 2 || !readRun(board, vertical, line, run, buf)) continue;
+            if (!counted.insert(vertical, line, run.start)) continue;
+
+            long long runScore = 0;
+            long long equationMultiplier = 1;
+            for (int k = 0; k < run.length; ++k) {
+                int rr = vertical ? run.start + k : r;
+                int cc = vertical ? c : run.start + k;
+                int tileScore = Scoring::tileScore(buf[k]);
+                // piece multiplier applies only if multiplier there and not used yet
+                if (!multiplierUsed[rr*N + cc]) {
+                    MultiplierType mt = kLayout.cells[rr][cc];
+                    if (mt == DoublePiece) tileScore *= 2;
+                    else if (mt == TriplePiece) tileScore *= 3;
+                    else if (mt == DoubleEquation) equationMultiplier *= 2;
+                    else if (mt == TripleEquation) equationMultiplier *= 3;
+                }
+                runScore += tileScore;
+            }
+            total += int(runScore * equationMultiplier);
+        }
+    }
+    return total;
+}
+
+int GameRules::scoringRuns(const char* board, const TilePlacement* tiles, int n, ScoringRun* out) {
+    RunSet counted;
+    char buf[N];
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        int r = tiles[i].row, c = tiles[i].col;
+        for (bool vertical : {false, true}) {
+            int line = vertical ? c : r;
+            Run run = vertical ? runDown(board, r, c) : runAcross(board, r, c);
+            if (run.length < 2 || !readRun(board, vertical, line, run, buf)) continue;
+            if (!counted.insert(vertical, line, run.start)) continue;
+            out[count++] = {vertical, line, run.start, run.length};
+        }
+    }
+    return count;
+}
+
+template struct RuleSet<StandardSyntax, SingleEquals, StandardScoring>;
+template struct RuleSet<ClubSyntax, ChainedEquals, StandardScoring>;
+template struct RuleSet<PlainSyntax, SingleEquals, StandardScoring>;
+template struct RuleSet<StandardSyntax, SingleEquals, WeightedScoring>;
+
+namespace {
+
+template <class Rules>
+constexpr RuleEngine engine(RuleVariant variant, const char* name) {
+    return {variant, name, &Rules::evalExpr, &Rules::checkEquation, &Rules::validate, &Rules::scoreTurn, &Rules::tileScore};
+}
+
+const RuleEngine kEngines[] = {
+    engine<StandardRules>(RuleVariant::Standard, "standard"),
+    engine<ClubRules>(RuleVariant::Club, "club"),
+    engine<PlainRules>(RuleVariant::Plain, "plain"),
+    engine<WeightedRules>(RuleVariant::Weighted, "weighted"),
+};
+static_assert(std::size(kEngines) == size_t(RuleVariant::Count));
+
+} // namespace
+
+const RuleEngine& RuleEngine::get(RuleVariant variant) {
+    size_t i = size_t(variant);
+    return kEngines[i < std::size(kEngines) ? i : 0];
+}
+
+const RuleEngine* RuleEngine::find(const char* name) {
+    for (const RuleEngine &e : kEngines)
+        if (std::strcmp(e.name, name) == 0) return &e;
+    return nullptr;
+}
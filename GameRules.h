@@ -0,0 +1,107 @@
+#ifndef GAMERULES_H
+#define GAMERULES_H
+
+#include <cstdint>
+#include <optional>
+
+// Qt-free game rules shared by the GUI and the offline tools.
+// Tiles are plain ASCII chars: '0'-'9', '+', '-', '*', '/' and '='.
+
+struct TilePlacement { int row; int col; char ch; };
+
+// A run of tiles on one line: board[line][start..start+length) across, or
+// [start..)[line] down.
+struct ScoringRun { bool vertical; int line; int start; int length; };
+
+enum MultiplierType {
+    None,
+    DoublePiece,
+    TriplePiece,
+    DoubleEquation,
+    TripleEquation
+};
+
+// Why a turn was rejected.
+enum class RuleError {
+    None,
+    NoTiles,            // "Place at least one tile."
+    NotCenter,          // first move must cover the center square
+    NotInLine,          // tiles must share a row or a column
+    NotConnected,       // later moves must touch an existing tile
+    BadEquation,        // a run containing '=' is not a true equation
+    CellUnavailable,    // off the board, already occupied or used twice in the move
+    TileUnavailable     // tile is not in the mover's rack
+};
+
+// Why a single run is not a true equation.
+enum class EquationError {
+    None,
+    EqualsCount,        // must contain exactly one '='
+    MissingSide,        // both sides required
+    LhsInvalid,
+    RhsInvalid,
+    Unequal
+};
+
+// Details of a rejected turn. For BadEquation the failing run is
+// board[line][start..start+length) across, or [start..)[line] down.
+struct RuleCheck {
+    RuleError error = RuleError::None;
+    bool vertical = false;
+    int line = 0;
+    int start = 0;
+    int length = 0;
+    EquationError why = EquationError::None;
+    long long lhs = 0;
+    long long rhs = 0;
+};
+
+class GameRules {
+public:
+    static constexpr int BoardSize = 15;
+    static constexpr int Center = BoardSize / 2;
+    static constexpr int CellCount = BoardSize * BoardSize;
+    static constexpr int RackOthers = 7;        // non-equals tiles in a full rack
+    static constexpr int MaxRackTiles = RackOthers + 1;
+
+    // Symbol alphabet: digits, then + - * /, then '=' last.
+    static constexpr int SymbolCount = 15;
+    static constexpr int OtherSymbolCount = 14; // everything except '='
+    static constexpr int EqualsSymbol = 14;
+    static int symbolIndex(char ch);             // -1 if not a tile
+    static char symbolChar(int index);
+
+    // Number of tiles of each symbol in a fresh bag.
+    static int tileCount(char ch);
+
+    // Premium square layout (symmetric under transpose).
+    static MultiplierType multiplierAt(int r, int c);
+
+    // Zobrist key for a symbol on a cell; a position hash is the XOR over all
+    // tiles on the board, so transpositions of the same tiles hash alike.
+    static uint64_t zobrist(int cell, int symbol);
+
+    // digits '1'-'9' => numeric value, '0' => 1, operators => 2, '=' => 0
+    static int baseTileScore(char ch);
+
+    // Small expression evaluator: + - * / with precedence and parentheses.
+    // Division must be exact integer. Returns nullopt on any syntax error.
+    static std::optional<long long> evalExpr(const char* s, int n);
+
+    // Check a run of tiles as "LHS=RHS". lhs/rhs are filled when both evaluate.
+    static EquationError checkEquation(const char* s, int n, long long* lhs = nullptr, long long* rhs = nullptr);
+
+    // Validate a turn. board holds BoardSize*BoardSize chars row-major ('\0' is
+    // empty) and already includes the new tiles.
+    static bool validate(const char* board, const TilePlacement* tiles, int n, RuleCheck& check);
+
+    // Score all distinct runs with '=' formed by the new tiles. Multipliers
+    // count only where multiplierUsed is false.
+    static int scoreTurn(const char* board, const bool* multiplierUsed, const TilePlacement* tiles, int n);
+
+    // The runs scoreTurn counts, each once; out needs room for 2*n. Returns
+    // how many.
+    static int scoringRuns(const char* board, const TilePlacement* tiles, int n, ScoringRun* out);
+};
+
+#endif // GAMERULES_H
@@ -0,0 +1,498 @@
+#include "GameServer.h"
+#include "GameMetrics.h"
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace {
+
+constexpr uint64_t kListenerTag = uint64_t(1) << 63;
+constexpr int kMaxIov = 64;
+
+// Output a peer may leave unread, spectator frames included, before it is
+// disconnected rather than buffered for without limit
+constexpr size_t kMaxQueuedBytes = size_t(1) << 20;
+
+} // namespace
+
+GameServer::GameServer() {
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+}
+
+GameServer::~GameServer() {
+    for (auto &entry : m_connections) ::close(entry.second.fd);
+    for (int fd : m_listeners) ::close(fd);
+    if (m_epoll >= 0) ::close(m_epoll);
+}
+
+bool GameServer::addListener(int fd) {
+    if (listen(fd, SOMAXCONN) != 0) {
+        ::close(fd);
+        return false;
+    }
+    epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = kListenerTag | uint64_t(m_listeners.size());
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        ::close(fd);
+        return false;
+    }
+    m_listeners.push_back(fd);
+    return true;
+}
+
+bool GameServer::listenTcp(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+        ::close(fd);
+        return false;
+    }
+    return addListener(fd);
+}
+
+bool GameServer::listenUnix(const char* path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    std::snprintf(addr.sun_path, sizeof addr.sun_path, "%s", path);
+    unlink(path);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+        ::close(fd);
+        return false;
+    }
+    return addListener(fd);
+}
+
+void GameServer::setMetricsFile(const char* path, int intervalSeconds) {
+    m_metricsPath = path ? path : "";
+    m_metricsInterval = std::chrono::seconds(std::max(intervalSeconds, 1));
+}
+
+int GameServer::run() {
+    if (m_epoll < 0 || m_listeners.empty()) return 1;
+    epoll_event events[256];
+    std::vector<uint64_t> closing;
+    auto nextMetrics = std::chrono::steady_clock::now();
+    while (!m_stop) {
+        auto now = std::chrono::steady_clock::now();
+        if (!m_metricsPath.empty() && now >= nextMetrics) {
+            if (!GameMetrics::writeTextfile(m_metricsPath.c_str()))
+                std::fprintf(stderr, "cannot write metrics to %s\n", m_metricsPath.c_str());
+            nextMetrics = now + m_metricsInterval;
+        }
+        int n = epoll_wait(m_epoll, events, 256, 200);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return 1;
+        }
+        for (int i = 0; i < n; ++i) {
+            uint64_t tag = events[i].data.u64;
+            if (tag & kListenerTag) {
+                accept(m_listeners[tag & ~kListenerTag]);
+                continue;
+            }
+            auto it = m_connections.find(tag);
+            if (it == m_connections.end()) continue;
+            Connection &c = it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closing.push_back(tag);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) onReadable(tag, c);
+            if (events[i].events & EPOLLOUT) m_dirty.push_back(tag);
+            if (c.fd < 0) closing.push_back(tag);
+        }
+
+        // One write per connection per round, however many frames it produced
+        for (uint64_t id : m_dirty) {
+            auto it = m_connections.find(id);
+            if (it != m_connections.end() && it->second.fd >= 0) flush(id, it->second);
+            if (it != m_connections.end() && it->second.fd < 0) closing.push_back(id);
+        }
+        m_dirty.clear();
+        for (uint64_t id : closing) drop(id);
+        closing.clear();
+    }
+    if (!m_metricsPath.empty()) GameMetrics::writeTextfile(m_metricsPath.c_str());
+    return 0;
+}
+
+void GameServer::accept(int listenFd) {
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one); // fails harmlessly on Unix sockets
+        uint64_t id = m_nextConnection++;
+        epoll_event ev {};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = id;
+        if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ::close(fd);
+            continue;
+        }
+        m_connections[id].fd = fd;
+    }
+}
+
+void GameServer::onReadable(uint64_t id, Connection& c) {
+    uint8_t buf[16384];
+    bool closed = false;
+    for (;;) {
+        ssize_t n = read(c.fd, buf, sizeof buf);
+        if (n > 0) {
+            c.in.insert(c.in.end(), buf, buf + n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0 && errno == EINTR) continue;
+        // peer closed or error: answer what we already have, then close
+        closed = true;
+        break;
+    }
+
+    size_t pos = 0;
+    while (c.in.size() - pos >= 5) {
+        uint32_t len;
+        std::memcpy(&len, c.in.data() + pos, 4);
+        if (len == 0 || len > kMaxFrame) {
+            if (c.fd >= 0) ::close(c.fd);
+            c.fd = -1;
+            return;
+        }
+        if (c.in.size() - pos - 4 < len) break;
+        MsgType type = MsgType(c.in[pos + 4]);
+        WireReader r(c.in.data() + pos + 5, len - 1);
+        handleFrame(id, c, type, r);
+        pos += 4 + len;
+    }
+    c.in.erase(c.in.begin(), c.in.begin() + long(pos));
+
+    if (closed) {
+        // A peer that only shut down its side still reads; whatever the
+        // socket does not take now is dropped with the connection
+        flush(id, c);
+        if (c.fd >= 0) ::close(c.fd);
+        c.fd = -1;
+    }
+}
+
+void GameServer::flush(uint64_t id, Connection& c) {
+    while (!c.shared.empty() || c.outPos < c.out.size()) {
+        iovec iov[kMaxIov];
+        int n = 0;
+        size_t skip = c.sharedPos;
+        for (auto it = c.shared.begin(); it != c.shared.end() && n < kMaxIov; ++it, ++n) {
+            iov[n].iov_base = const_cast<uint8_t*>((*it)->data()) + skip;
+            iov[n].iov_len = (*it)->size() - skip;
+            skip = 0;
+        }
+        if (n == int(c.shared.size()) && n < kMaxIov && c.outPos < c.out.size()) {
+            iov[n].iov_base = c.out.data() + c.outPos;
+            iov[n].iov_len = c.out.size() - c.outPos;
+            ++n;
+        }
+
+        ssize_t written = writev(c.fd, iov, n);
+        if (written > 0) {
+            size_t left = size_t(written);
+            while (left > 0 && !c.shared.empty()) {
+                size_t rest = c.shared.front()->size() - c.sharedPos;
+                if (left < rest) {
+                    c.sharedPos += left;
+                    left = 0;
+                } else {
+                    left -= rest;
+                    c.shared.pop_front();
+                    c.sharedPos = 0;
+                }
+            }
+            c.outPos += left;
+            continue;
+        }
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            size_t queued = c.out.size() - c.outPos;
+            for (const SpectatorFeed::Buffer &frame : c.shared) queued += frame->size();
+            if (queued - c.sharedPos > kMaxQueuedBytes) {
+                // not reading: disconnect rather than buffer for it
+                ::close(c.fd);
+                c.fd = -1;
+                return;
+            }
+            if (!c.wantsWrite) {
+                epoll_event ev {};
+                ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+                ev.data.u64 = id;
+                epoll_ctl(m_epoll, EPOLL_CTL_MOD, c.fd, &ev);
+                c.wantsWrite = true;
+            }
+            return;
+        }
+        ::close(c.fd);
+        c.fd = -1;
+        return;
+    }
+    c.out.clear();
+    c.outPos = 0;
+    if (c.wantsWrite) {
+        epoll_event ev {};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = id;
+        epoll_ctl(m_epoll, EPOLL_CTL_MOD, c.fd, &ev);
+        c.wantsWrite = false;
+    }
+}
+
+void GameServer::queueShared(uint64_t id, Connection& c, const SpectatorFeed::Buffer& frame) {
+    // Replies already queued go first; they move into a segment of their own
+    if (c.outPos < c.out.size()) {
+        c.shared.push_back(std::make_shared<const std::vector<uint8_t>>(c.out.begin() + long(c.outPos), c.out.end()));
+        c.out.clear();
+        c.outPos = 0;
+    }
+    c.shared.push_back(frame);
+    m_dirty.push_back(id);
+}
+
+void GameServer::broadcast(const Session& s, const SpectatorFeed::Buffer& frame) {
+    for (uint64_t id : s.spectators) {
+        auto it = m_connections.find(id);
+        if (it != m_connections.end() && it->second.fd >= 0) queueShared(id, it->second, frame);
+    }
+}
+
+void GameServer::drop(uint64_t id) {
+    auto it = m_connections.find(id);
+    if (it == m_connections.end()) return;
+    if (it->second.fd >= 0) ::close(it->second.fd);
+
+    // Free the seats; a game nobody sits at any more is gone
+    for (uint32_t gameId : it->second.games) {
+        auto g = m_games.find(gameId);
+        if (g == m_games.end()) continue;
+        Session &s = *g->second;
+        for (uint64_t &seat : s.seats) if (seat == id) seat = 0;
+        if (s.seats[0] == 0 && s.seats[1] == 0) m_games.erase(g);
+    }
+    for (uint32_t gameId : it->second.watching) {
+        auto g = m_games.find(gameId);
+        if (g == m_games.end()) continue;
+        auto &watchers = g->second->spectators;
+        watchers.erase(std::remove(watchers.begin(), watchers.end(), id), watchers.end());
+    }
+    m_connections.erase(it);
+}
+
+void GameServer::replyError(Connection& c, ServerError e) {
+    WireWriter w(c.out);
+    w.begin(MsgType::Error);
+    w.u8(uint8_t(e));
+    w.end();
+}
+
+void GameServer::replyMove(Connection& c, uint32_t gameId, const Session& s, bool ok, RuleError err, int points) {
+    WireWriter w(c.out);
+    w.begin(MsgType::MoveResult);
+    w.u32(gameId);
+    w.u8(ok);
+    w.u8(uint8_t(err));
+    w.u32(uint32_t(points));
+    w.u32(uint32_t(s.game.score(0)));
+    w.u32(uint32_t(s.game.score(1)));
+    w.u8(uint8_t(s.game.currentPlayer()));
+    w.end();
+}
+
+void GameServer::notifyOpponent(uint32_t gameId, const Session& s, int points) {
+    // After a move the opponent is the player to move
+    uint64_t other = s.seats[s.game.currentPlayer()];
+    auto it = m_connections.find(other);
+    if (it == m_connections.end()) return;
+    WireWriter w(it->second.out);
+    w.begin(MsgType::OpponentMoved);
+    w.u32(gameId);
+    w.u32(uint32_t(points));
+    w.u8(uint8_t(s.game.currentPlayer()));
+    w.end();
+    m_dirty.push_back(other);
+}
+
+GameServer::Session* GameServer::seatedSession(uint64_t id, Connection& c, uint32_t gameId) {
+    auto it = m_games.find(gameId);
+    if (it == m_games.end()) {
+        replyError(c, ServerError::UnknownGame);
+        return nullptr;
+    }
+    Session *s = it->second.get();
+    if (s->seats[0] != id && s->seats[1] != id) {
+        replyError(c, ServerError::NotSeated);
+        return nullptr;
+    }
+    return s;
+}
+
+void GameServer::handleFrame(uint64_t id, Connection& c, MsgType type, WireReader& r) {
+    m_dirty.push_back(id);
+    switch (type) {
+    case MsgType::CreateGame: {
+        uint64_t seed = r.u64();
+        if (!r.ok()) break;
+        // Older clients send only the seed
+        uint8_t variant = r.atEnd() ? uint8_t(RuleVariant::Standard) : r.u8();
+        if (!r.ok() || variant >= uint8_t(RuleVariant::Count)) break;
+        if (seed == 0) seed = TileBag::randomSeed() ^ (uint64_t(m_nextGame) << 32);
+        uint32_t gameId = m_nextGame++;
+        auto session = std::make_unique<Session>(seed, RuleVariant(variant), gameId);
+        session->seats[0] = id;
+        m_games.emplace(gameId, std::move(session));
+        c.games.push_back(gameId);
+        WireWriter w(c.out);
+        w.begin(MsgType::Joined);
+        w.u32(gameId);
+        w.u8(0);
+        w.end();
+        return;
+    }
+    case MsgType::JoinGame: {
+        uint32_t gameId = r.u32();
+        if (!r.ok()) break;
+        auto it = m_games.find(gameId);
+        if (it == m_games.end()) {
+            replyError(c, ServerError::UnknownGame);
+            return;
+        }
+        Session &s = *it->second;
+        // The feed carries both racks, so a spectator may not take a seat
+        if (std::find(s.spectators.begin(), s.spectators.end(), id) != s.spectators.end()) {
+            replyError(c, ServerError::SeatedSpectator);
+            return;
+        }
+        int seat = s.seats[1] == 0 ? 1 : s.seats[0] == 0 ? 0 : -1;
+        if (seat < 0) {
+            replyError(c, ServerError::GameFull);
+            return;
+        }
+        s.seats[seat] = id;
+        c.games.push_back(gameId);
+        WireWriter w(c.out);
+        w.begin(MsgType::Joined);
+        w.u32(gameId);
+        w.u8(uint8_t(seat));
+        w.end();
+        return;
+    }
+    case MsgType::Place:
+    case MsgType::Swap: {
+        uint32_t gameId = r.u32();
+        int n = r.u8();
+        if (!r.ok() || n > GameRules::MaxRackTiles) break;
+        TilePlacement tiles[GameRules::MaxRackTiles];
+        char swapped[GameRules::MaxRackTiles];
+        bool taken[GameRules::CellCount] = {};
+        bool repeated = false;
+        for (int i = 0; i < n; ++i) {
+            if (type == MsgType::Place) {
+                tiles[i].row = r.u8();
+                tiles[i].col = r.u8();
+                tiles[i].ch = char(r.u8());
+                // a square named twice is malformed, not a rule error
+                if (tiles[i].row < GameRules::BoardSize && tiles[i].col < GameRules::BoardSize) {
+                    bool &t = taken[tiles[i].row*GameRules::BoardSize + tiles[i].col];
+                    repeated |= t;
+                    t = true;
+                }
+            } else {
+                swapped[i] = char(r.u8());
+            }
+        }
+        if (!r.ok() || !r.atEnd() || repeated) break;
+        Session *s = seatedSession(id, c, gameId);
+        if (!s) return;
+        if (s->seats[s->game.currentPlayer()] != id) {
+            replyError(c, ServerError::NotYourTurn);
+            return;
+        }
+        RuleCheck check;
+        int points = 0;
+        bool ok = type == MsgType::Place ? s->game.place(tiles, n, check, points)
+                                         : s->game.swap(swapped, n);
+        if (!ok && type == MsgType::Swap) check.error = RuleError::TileUnavailable;
+        if (type == MsgType::Place) {
+            GameMetrics::recordValidation(check);
+            if (ok) GameMetrics::recordScore(points);
+        } else if (ok) {
+            GameMetrics::recordSwap();
+        }
+        if (ok && !s->bagEmpty && s->game.bag().otherTilesCount() == 0) {
+            s->bagEmpty = true;
+            GameMetrics::recordBagDepleted(std::chrono::duration<double>(std::chrono::steady_clock::now() - s->started).count());
+        }
+        replyMove(c, gameId, *s, ok, check.error, points);
+        if (ok) {
+            notifyOpponent(gameId, *s, points);
+            broadcast(*s, s->feed.record(s->game));
+        }
+        return;
+    }
+    case MsgType::GetState: {
+        uint32_t gameId = r.u32();
+        if (!r.ok()) break;
+        Session *s = seatedSession(id, c, gameId);
+        if (!s) return;
+        const GameState &g = s->game;
+        int seat = s->seats[g.currentPlayer()] == id ? g.currentPlayer() : 1 - g.currentPlayer();
+        WireWriter w(c.out);
+        w.begin(MsgType::State);
+        w.u32(gameId);
+        w.u8(uint8_t(g.currentPlayer()));
+        w.u32(uint32_t(g.score(0)));
+        w.u32(uint32_t(g.score(1)));
+        w.u16(uint16_t(g.bag().otherTilesCount()));
+        for (int i = 0; i < GameRules::SymbolCount; ++i) w.u8(uint8_t(g.rack(seat)[i]));
+        w.bytes(g.board(), GameRules::CellCount);
+        w.end();
+        return;
+    }
+    case MsgType::Spectate: {
+        uint32_t gameId = r.u32();
+        if (!r.ok() || !r.atEnd()) break;
+        auto it = m_games.find(gameId);
+        if (it == m_games.end()) {
+            replyError(c, ServerError::UnknownGame);
+            return;
+        }
+        Session &s = *it->second;
+        // The feed carries both racks, so a player would see the opponent's
+        if (s.seats[0] == id || s.seats[1] == id) {
+            replyError(c, ServerError::SeatedSpectator);
+            return;
+        }
+        if (std::find(s.spectators.begin(), s.spectators.end(), id) == s.spectators.end()) {
+            s.spectators.push_back(id);
+            c.watching.push_back(gameId);
+        }
+        for (const SpectatorFeed::Buffer &frame : s.feed.catchUp()) queueShared(id, c, frame);
+        return;
+    }
+    default:
+        break;
+    }
+    replyError(c, ServerError::BadRequest);
+}
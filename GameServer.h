@@ -0,0 +1,95 @@
+#ifndef GAMESERVER_H
+#define GAMESERVER_H
+
+#include "GameState.h"
+#include "ServerProtocol.h"
+#include "SpectatorFeed.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Single-threaded epoll server hosting many independent games (Linux only).
+// Each game owns its GameState, and with it its own TileBag; requests are
+// validated and scored inline on the event loop, which is far cheaper than
+// the socket round trip. See ServerProtocol.h for the wire format.
+//
+// Spectators receive each turn as one SpectatorFeed frame shared by every
+// watcher of the game: it is queued by reference and written with writev,
+// never copied per connection. The feed shows both racks, so no connection
+// watches a game it sits at. A connection that leaves more than 1 MiB of
+// output unread is disconnected.
+class GameServer {
+public:
+    GameServer();
+    ~GameServer();
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    bool listenTcp(uint16_t port);          // 127.0.0.1 only
+    bool listenUnix(const char* path);
+
+    // Serve until stop() is called (safe from a signal handler).
+    int run();
+    void stop() { m_stop = true; }
+
+    // Rewrite a Prometheus textfile (GameMetrics) every interval while running.
+    void setMetricsFile(const char* path, int intervalSeconds = 15);
+
+    size_t gameCount() const { return m_games.size(); }
+    size_t connectionCount() const { return m_connections.size(); }
+
+private:
+    struct Connection {
+        int fd = -1;
+        std::vector<uint8_t> in;
+        std::deque<SpectatorFeed::Buffer> shared;   // sent before out
+        size_t sharedPos = 0;
+        std::vector<uint8_t> out;
+        size_t outPos = 0;
+        bool wantsWrite = false;
+        std::vector<uint32_t> games;    // games this connection sits at
+        std::vector<uint32_t> watching; // games this connection spectates
+    };
+
+    struct Session {
+        Session(uint64_t seed, RuleVariant variant, uint32_t id) : game(seed, variant), feed(id, game) {}
+        GameState game;
+        SpectatorFeed feed;
+        std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+        bool bagEmpty = false;
+        uint64_t seats[2] = {0, 0};  // connection ids, 0 = free
+        std::vector<uint64_t> spectators;
+    };
+
+    bool addListener(int fd);
+    void accept(int listenFd);
+    void onReadable(uint64_t id, Connection& c);
+    void flush(uint64_t id, Connection& c);
+    void queueShared(uint64_t id, Connection& c, const SpectatorFeed::Buffer& frame);
+    void broadcast(const Session& s, const SpectatorFeed::Buffer& frame);
+    void drop(uint64_t id);
+    void handleFrame(uint64_t id, Connection& c, MsgType type, WireReader& r);
+
+    void replyError(Connection& c, ServerError e);
+    void replyMove(Connection& c, uint32_t gameId, const Session& s, bool ok, RuleError err, int points);
+    void notifyOpponent(uint32_t gameId, const Session& s, int points);
+    Session* seatedSession(uint64_t id, Connection& c, uint32_t gameId);
+
+    int m_epoll = -1;
+    std::vector<int> m_listeners;
+    std::atomic<bool> m_stop{false};
+    uint64_t m_nextConnection = 1;
+    uint32_t m_nextGame = 1;
+    std::unordered_map<uint64_t, Connection> m_connections;
+    std::unordered_map<uint32_t, std::unique_ptr<Session>> m_games;
+    std::vector<uint64_t> m_dirty;           // connections with output queued this round
+    std::string m_metricsPath;
+    std::chrono::seconds m_metricsInterval{15};
+};
+
+#endif // GAMESERVER_H
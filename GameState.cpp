@@ -0,0 +1,202 @@
+#include "GameState.h"
+#include "TurnTrace.h"
+#include <cstring>
+
+GameState::GameState(uint64_t seed, RuleVariant variant) : m_rules(&RuleEngine::get(variant)), m_bag(seed) {
+    // initial fill for both racks
+    refillRack(0);
+    refillRack(1);
+}
+
+int GameState::rackNonEquals(int player) const {
+    int count = 0;
+    for (int s = 0; s < GameRules::OtherSymbolCount; ++s) count += m_racks[player][s];
+    return count;
+}
+
+void GameState::refillRack(int player) {
+    int *rack = m_racks[player];
+
+    // Each rack holds exactly one '=' tile while the pile lasts
+    if (rack[GameRules::EqualsSymbol] == 0) {
+        char eq = m_bag.drawEquals();
+        if (eq) ++rack[GameRules::EqualsSymbol];
+    }
+
+    // Fill other tiles up to 7 non-equals tiles
+    for (int have = rackNonEquals(player); have < GameRules::RackOthers; ++have) {
+        char ch = m_bag.drawOther();
+        if (!ch) break;
+        ++rack[GameRules::symbolIndex(ch)];
+    }
+}
+
+bool GameState::takeTiles(const TilePlacement* tiles, int n, int* need, RuleCheck& check) const {
+    // Tiles must come off the rack onto empty squares, one tile a square
+    const int *rack = m_racks[m_currentPlayer];
+    bool taken[GameRules::CellCount] = {};
+    for (int i = 0; i < n; ++i) {
+        const TilePlacement &t = tiles[i];
+        int sym = GameRules::symbolIndex(t.ch);
+        if (sym < 0 || ++need[sym] > rack[sym]) {
+            check.error = RuleError::TileUnavailable;
+            return false;
+        }
+        if (t.row < 0 || t.row >= GameRules::BoardSize || t.col < 0 || t.col >= GameRules::BoardSize
+            || m_cells[t.row*GameRules::BoardSize + t.col] || taken[t.row*GameRules::BoardSize + t.col]) {
+            check.error = RuleError::CellUnavailable;
+            return false;
+        }
+        taken[t.row*GameRules::BoardSize + t.col] = true;
+    }
+    return true;
+}
+
+bool GameState::place(const TilePlacement* tiles, int n, RuleCheck& check, int& points) {
+    check = RuleCheck();
+    points = 0;
+    int *rack = m_racks[m_currentPlayer];
+    int need[GameRules::SymbolCount] = {};
+    {
+        TracePhase trace("placements");
+        if (!takeTiles(tiles, n, need, check)) return false;
+    }
+
+    for (int i = 0; i < n; ++i) m_cells[tiles[i].row*GameRules::BoardSize + tiles[i].col] = tiles[i].ch;
+    bool valid;
+    {
+        TracePhase trace("GameRules::validate");
+        valid = m_rules->validate(m_cells, tiles, n, check);
+    }
+    if (!valid) {
+        for (int i = 0; i < n; ++i) m_cells[tiles[i].row*GameRules::BoardSize + tiles[i].col] = '\0';
+        return false;
+    }
+
+    // compute score for this turn (before consuming multipliers)
+    {
+        TracePhase trace("computeScoreForTurn");
+        points = m_rules->scoreTurn(m_cells, m_used, tiles, n);
+    }
+    m_scores[m_currentPlayer] += points;
+
+    // lock tiles and consume multipliers for newly covered squares
+    for (int i = 0; i < n; ++i) {
+        int cell = tiles[i].row*GameRules::BoardSize + tiles[i].col;
+        m_used[cell] = true;
+        m_hash ^= GameRules::zobrist(cell, GameRules::symbolIndex(tiles[i].ch));
+    }
+    for (int s = 0; s < GameRules::SymbolCount; ++s) rack[s] -= need[s];
+
+    refillRack(m_currentPlayer);
+    m_currentPlayer = 1 - m_currentPlayer;
+    return true;
+}
+
+bool GameState::evaluate(const TilePlacement* tiles, int n, RuleCheck& check, int& points) const {
+    check = RuleCheck();
+    points = 0;
+    int need[GameRules::SymbolCount] = {};
+    if (!takeTiles(tiles, n, need, check)) return false;
+
+    char cells[GameRules::CellCount];
+    std::memcpy(cells, m_cells, sizeof cells);
+    for (int i = 0; i < n; ++i) cells[tiles[i].row*GameRules::BoardSize + tiles[i].col] = tiles[i].ch;
+    if (!m_rules->validate(cells, tiles, n, check)) return false;
+    points = m_rules->scoreTurn(cells, m_used, tiles, n);
+    return true;
+}
+
+bool GameState::swap(const char* tiles, int n) {
+    int *rack = m_racks[m_currentPlayer];
+    int need[GameRules::SymbolCount] = {};
+    for (int i = 0; i < n; ++i) {
+        int sym = GameRules::symbolIndex(tiles[i]);
+        if (sym < 0 || sym == GameRules::EqualsSymbol || ++need[sym] > rack[sym]) return false;
+    }
+    if (n == 0 || m_bag.otherTilesCount() < n) return false;
+
+    for (int s = 0; s < GameRules::SymbolCount; ++s) rack[s] -= need[s];
+    m_bag.returnTiles(tiles, n);
+    for (int i = 0; i < n; ++i) {
+        char ch = m_bag.drawOther();
+        if (ch) ++rack[GameRules::symbolIndex(ch)];
+    }
+    m_currentPlayer = 1 - m_currentPlayer;
+    return true;
+}
+
+bool GameState::save(GameSnapshot& out) const {
+    if (m_bag.shuffles() > TileBag::MaxShuffles) return false;
+    out = GameSnapshot();
+    std::memcpy(out.magic, "EQXS", 4);
+    out.version = SnapshotVersion;
+    out.variant = uint8_t(m_rules->variant);
+    out.currentPlayer = uint8_t(m_currentPlayer);
+    out.equalsCursor = uint8_t(m_bag.equalsCursor());
+    out.seed = m_bag.seed();
+    out.shuffles = m_bag.shuffles();
+    out.otherCursor = uint8_t(m_bag.otherCursor());
+    for (int p = 0; p < 2; ++p) {
+        out.scores[p] = m_scores[p];
+        for (int s = 0; s < GameRules::SymbolCount; ++s) out.racks[p][s] = uint8_t(m_racks[p][s]);
+    }
+    std::memcpy(out.cells, m_cells, sizeof out.cells);
+    std::memcpy(out.otherTiles, m_bag.otherTiles(), sizeof out.otherTiles);
+    return true;
+}
+
+bool GameState::restore(const GameSnapshot& in) {
+    if (std::memcmp(in.magic, "EQXS", 4) != 0 || in.version != SnapshotVersion
+        || in.variant >= uint8_t(RuleVariant::Count) || in.currentPlayer > 1)
+        return false;
+    // Tiles in play, by symbol
+    int inPlay[GameRules::SymbolCount] = {};
+    for (int p = 0; p < 2; ++p) {
+        if (in.scores[p] < 0 || in.racks[p][GameRules::EqualsSymbol] > 1) return false;
+        int others = 0;
+        for (int s = 0; s < GameRules::SymbolCount; ++s) {
+            inPlay[s] += in.racks[p][s];
+            if (s != GameRules::EqualsSymbol) others += in.racks[p][s];
+        }
+        if (others > GameRules::RackOthers) return false;
+    }
+    for (char ch : in.cells) {
+        if (!ch) continue;
+        int sym = GameRules::symbolIndex(ch);
+        if (sym < 0) return false;
+        ++inPlay[sym];
+    }
+
+    // '=' tiles are only ever drawn, never returned
+    if (inPlay[GameRules::EqualsSymbol] != in.equalsCursor) return false;
+
+    // Before the first swap, the tiles in play and those left in the pile make
+    // up a fresh bag. A swap puts the whole pile back in play, copies of the
+    // tiles already drawn included (see TileBag::returnTiles), so after one
+    // only the pile's symbols can be checked.
+    if (in.shuffles == 1 && in.otherCursor <= TileBag::OtherTileTotal) {
+        for (int i = in.otherCursor; i < TileBag::OtherTileTotal; ++i) {
+            int sym = GameRules::symbolIndex(in.otherTiles[i]);
+            if (sym < 0) return false;
+            ++inPlay[sym];
+        }
+        for (int s = 0; s < GameRules::OtherSymbolCount; ++s)
+            if (inPlay[s] != GameRules::tileCount(GameRules::symbolChar(s))) return false;
+    }
+    if (!m_bag.restore(in.seed, in.otherTiles, in.otherCursor, in.equalsCursor, in.shuffles)) return false;
+
+    m_rules = &RuleEngine::get(RuleVariant(in.variant));
+    m_currentPlayer = in.currentPlayer;
+    m_hash = 0;
+    for (int cell = 0; cell < GameRules::CellCount; ++cell) {
+        m_cells[cell] = in.cells[cell];
+        m_used[cell] = in.cells[cell] != '\0';
+        if (m_used[cell]) m_hash ^= GameRules::zobrist(cell, GameRules::symbolIndex(in.cells[cell]));
+    }
+    for (int p = 0; p < 2; ++p) {
+        m_scores[p] = in.scores[p];
+        for (int s = 0; s < GameRules::SymbolCount; ++s) m_racks[p][s] = in.racks[p][s];
+    }
+    return true;
+}
@@ -0,0 +1,91 @@
+#ifndef GAMESTATE_H
+#define GAMESTATE_H
+
+#include "GameRules.h"
+#include "RuleVariants.h"
+#include "TileBag.h"
+#include <cstdint>
+
+// Fixed-size image of a game, from GameState::save. Little-endian like the
+// other formats. Premiums are not stored: GameState consumes one exactly
+// where a tile lies, so the board fixes them.
+struct GameSnapshot {
+    char magic[4];          // "EQXS"
+    uint8_t version;
+    uint8_t variant;        // RuleVariant
+    uint8_t currentPlayer;
+    uint8_t equalsCursor;   // TileBag::equalsCursor
+    uint64_t seed;
+    uint32_t shuffles;      // TileBag::shuffles
+    uint8_t otherCursor;    // TileBag::otherCursor
+    uint8_t reserved[3];
+    int32_t scores[2];
+    uint8_t racks[2][GameRules::SymbolCount];   // counts by symbol index
+    char cells[GameRules::CellCount];           // row-major, '\0' empty
+    char otherTiles[TileBag::OtherTileTotal];   // TileBag::otherTiles
+    uint8_t padding;
+};
+
+static_assert(sizeof(GameSnapshot) == 384, "game snapshot layout");
+
+// Qt-free two-player game: board, racks, scores and bag, with the turn flow
+// (validate, score, lock, refill, switch player). Each GUI table is a view of
+// one, and recorded games are re-checked with it without the GUI.
+class GameState {
+public:
+    // The variant's validator and scorer are fixed for the whole game.
+    explicit GameState(uint64_t seed, RuleVariant variant = RuleVariant::Standard);
+
+    RuleVariant variant() const { return m_rules->variant; }
+
+    const char* board() const { return m_cells; }
+    const bool* multipliersUsed() const { return m_used; }
+    int currentPlayer() const { return m_currentPlayer; }
+    int score(int player) const { return m_scores[player]; }
+    const TileBag& bag() const { return m_bag; }
+    uint64_t positionHash() const { return m_hash; }
+
+    // Rack contents as counts indexed by GameRules::symbolIndex.
+    const int* rack(int player) const { return m_racks[player]; }
+    int rackNonEquals(int player) const;
+
+    // Play tiles from the current player's rack. On success the tiles are
+    // locked, the rack refilled and the turn passes; points gets the score.
+    bool place(const TilePlacement* tiles, int n, RuleCheck& check, int& points);
+
+    // The same checks and score as place, without playing the tiles.
+    bool evaluate(const TilePlacement* tiles, int n, RuleCheck& check, int& points) const;
+
+    // Return non-equals tiles to the bag and draw replacements; ends the turn.
+    // Fails if a tile is not on the rack or the bag holds too few tiles.
+    bool swap(const char* tiles, int n);
+
+    // End the turn without playing, for a player who can neither place nor swap.
+    void pass() { m_currentPlayer = 1 - m_currentPlayer; }
+
+    // The whole game, bag order included, so a restored game draws exactly as
+    // this one would. Neither allocates. save fails once the bag has been
+    // shuffled more than TileBag::MaxShuffles times. restore fails, leaving
+    // this game unchanged, on a bad header, symbol or cursor, a rack over
+    // size, '=' tiles in play other than those drawn, or, before any swap,
+    // tiles in play and in the bag that are not a fresh bag's. The position
+    // hash is rebuilt from the board.
+    static constexpr uint8_t SnapshotVersion = 1;
+    bool save(GameSnapshot& out) const;
+    bool restore(const GameSnapshot& in);
+
+private:
+    void refillRack(int player);
+    bool takeTiles(const TilePlacement* tiles, int n, int* need, RuleCheck& check) const;
+
+    const RuleEngine* m_rules;
+    char m_cells[GameRules::CellCount] = {};
+    bool m_used[GameRules::CellCount] = {};
+    int m_racks[2][GameRules::SymbolCount] = {};
+    int m_scores[2] = {0, 0};
+    int m_currentPlayer = 0;
+    uint64_t m_hash = 0;
+    TileBag m_bag;
+};
+
+#endif // GAMESTATE_H
@@ -0,0 +1,439 @@
+#include "GameTab.h"
+#include "BoardView.h"
+#include "RackView.h"
+#include "SwapDialog.h"
+#include "TurnTrace.h"
+#include "GameMetrics.h"
+#include "OpeningBook.h"
+#include "TaskPool.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QLabel>
+#include <QFile>
+#include <QFileDialog>
+#include <QTimer>
+#include <algorithm>
+#include <cstring>
+
+GameTab::GameTab(TaskPool *pool, const OpeningBook *book, const QByteArray &journalPath, QWidget *parent)
+    : QWidget(parent),
+    m_board(new BoardView(GameRules::BoardSize, this)),
+    m_game(TileBag::randomSeed()),
+    m_record(m_game.bag().seed()),
+    m_pool(pool),
+    m_journal(pool),
+    m_journalPath(journalPath),
+    m_book(book)
+{
+    // create two racks (players)
+    m_racks[0] = new RackView(this);
+    m_racks[1] = new RackView(this);
+
+    auto *v = new QVBoxLayout(this);
+    v->addWidget(m_board, 1);
+
+    // Racks row: Player 1 | Player 2 + scores
+    auto *racksRow = new QHBoxLayout;
+    {
+        auto *p1Layout = new QVBoxLayout;
+        QLabel *p1label = new QLabel("Player 1 Rack:");
+        p1label->setAlignment(Qt::AlignCenter);
+        p1Layout->addWidget(p1label);
+        p1Layout->addWidget(m_racks[0]);
+        racksRow->addLayout(p1Layout);
+
+        auto *spacer = new QWidget;
+        spacer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+        racksRow->addWidget(spacer);
+
+        auto *p2Layout = new QVBoxLayout;
+        QLabel *p2label = new QLabel("Player 2 Rack:");
+        p2label->setAlignment(Qt::AlignCenter);
+        p2Layout->addWidget(p2label);
+        p2Layout->addWidget(m_racks[1]);
+        racksRow->addLayout(p2Layout);
+    }
+    v->addLayout(racksRow);
+
+    // Score bar (below racks)
+    auto *scoreRow = new QHBoxLayout;
+    m_scoreLabels[0] = new QLabel("Player 1: 0");
+    m_scoreLabels[1] = new QLabel("Player 2: 0");
+    scoreRow->addWidget(m_scoreLabels[0]);
+    scoreRow->addStretch();
+    scoreRow->addWidget(m_scoreLabels[1]);
+    v->addLayout(scoreRow);
+
+    // Resume an interrupted game, or start journaling the one just dealt
+    if (!resumeFromJournal()) {
+        showRacks();
+        if (m_journal.open(m_journalPath.constData())) m_journal.begin(m_game.bag().seed());
+    }
+    connect(m_board, &BoardView::tilePlaced, this, [this](int r, int c, QChar ch) {
+        m_journal.place(r, c, ch.toLatin1());
+    });
+
+    // ensure only the active player's rack is enabled
+    enableRacksForCurrentPlayer();
+
+    m_gameClock.start();
+    m_bagDepleted = m_game.bag().otherTilesCount() == 0;
+}
+
+GameTab::~GameTab() {
+    // A running hint search still posts its result back to this tab
+    std::unique_lock<std::mutex> lock(m_hintMutex);
+    m_hintDone.wait(lock, [this] { return m_hintsRunning == 0; });
+}
+
+void GameTab::discard() {
+    m_journal.close();
+    QFile::remove(QFile::decodeName(m_journalPath));
+}
+
+bool GameTab::resumeFromJournal() {
+    JournalRecovery rec;
+    if (!TurnJournal::recover(m_journalPath.constData(), rec)) return false;
+
+    m_game = *rec.game;
+    m_record = *rec.record;
+
+    GameRecordReader reader(m_record.bytes().data(), m_record.bytes().size());
+    RecordedMove move;
+    while (reader.next(move)) {
+        m_moves.push_back(move);
+        m_positions.push(move.tiles, move.kind == MoveKind::Place ? move.count : 0);
+    }
+
+    const int N = GameRules::BoardSize;
+    for (int r = 0; r < N; ++r)
+        for (int c = 0; c < N; ++c)
+            if (char ch = m_game.board()[r*N + c]) m_board->restoreLockedTile(r, c, QChar::fromLatin1(ch));
+
+    showScores();
+    for (int p = 0; p < 2; ++p) {
+        int counts[GameRules::SymbolCount];
+        std::copy(m_game.rack(p), m_game.rack(p) + GameRules::SymbolCount, counts);
+        if (p == m_game.currentPlayer())
+            for (const TilePlacement &t : rec.pending) --counts[GameRules::symbolIndex(t.ch)];
+        m_racks[p]->setCounts(counts);
+    }
+    for (const TilePlacement &t : rec.pending) m_board->placeTile(t.row, t.col, QChar::fromLatin1(t.ch));
+
+    // keep appending after the intact prefix; the pending placements are already in it
+    m_journal.open(m_journalPath.constData(), rec.validBytes);
+    QString message = QString("Resumed saved game after %1 turns. Player %2's turn.")
+                          .arg(rec.turns).arg(m_game.currentPlayer() + 1);
+    QTimer::singleShot(0, this, [this, message] { emit statusMessage(message, 0); });
+    return true;
+}
+
+void GameTab::enableRacksForCurrentPlayer() {
+    m_racks[0]->setEnabled(m_game.currentPlayer() == 0);
+    m_racks[1]->setEnabled(m_game.currentPlayer() == 1);
+}
+
+void GameTab::showRacks() {
+    TracePhase trace("refillRack");
+    // The mover's tiles on the board this turn are off the rack widget
+    for (int p = 0; p < 2; ++p) {
+        if (p == m_game.currentPlayer() && !m_board->newTiles().isEmpty()) continue;
+        m_racks[p]->setCounts(m_game.rack(p));
+    }
+}
+
+void GameTab::showScores() {
+    for (int p = 0; p < 2; ++p)
+        m_scoreLabels[p]->setText(QString("Player %1: %2").arg(p + 1).arg(m_game.score(p)));
+}
+
+void GameTab::checkBagDepleted() {
+    if (m_bagDepleted || m_game.bag().otherTilesCount() > 0) return;
+    m_bagDepleted = true;
+    GameMetrics::recordBagDepleted(m_gameClock.elapsed() / 1000.0);
+}
+
+void GameTab::recordMove(const RecordedMove &move) {
+    // A new move after taking some back drops the ones Redo could replay
+    int ply = m_record.moves();
+    m_moves.resize(size_t(ply));
+    m_positions.truncate(ply + 1);
+
+    if (move.kind == MoveKind::Place) m_record.addPlacement(move.tiles, move.count, move.score, m_game.bag());
+    else m_record.addSwap(move.swapped, move.count, m_game.bag());
+    m_moves.push_back(move);
+    m_moves.back().cursor = GameRecordWriter::cursorOf(m_game.bag());
+    m_positions.push(move.tiles, move.kind == MoveKind::Place ? move.count : 0);
+    ++m_hintSerial;
+}
+
+void GameTab::goToPly(int ply) {
+    TracePhase trace("goToPly");
+    // Only boards are kept per ply. Racks, bag and scores follow from the seed
+    // and the moves, so they are replayed; every move was legal when made.
+    GameState game(m_game.bag().seed());
+    GameRecordWriter record(m_game.bag().seed());
+    for (int i = 0; i < ply; ++i) {
+        const RecordedMove &m = m_moves[size_t(i)];
+        if (m.kind == MoveKind::Place) {
+            RuleCheck check;
+            int points = 0;
+            game.place(m.tiles, m.count, check, points);
+            record.addPlacement(m.tiles, m.count, points, game.bag());
+        } else {
+            game.swap(m.swapped, m.count);
+            record.addSwap(m.swapped, m.count, game.bag());
+        }
+    }
+
+    // Repaint only the squares that differ between the two boards
+    const int N = GameRules::BoardSize;
+    int changed[GameRules::CellCount];
+    int n = m_positions.diff(m_record.moves(), ply, changed);
+    for (int i = 0; i < n; ++i) {
+        int r = changed[i] / N, c = changed[i] % N;
+        if (char ch = m_positions.at(ply, changed[i])) m_board->restoreLockedTile(r, c, QChar::fromLatin1(ch));
+        else m_board->clearLockedTile(r, c);
+    }
+
+    m_game = game;
+    m_record = record;
+    ++m_hintSerial;
+    showScores();
+    showRacks();
+    enableRacksForCurrentPlayer();
+    rewriteJournal();
+}
+
+void GameTab::rewriteJournal() {
+    // The journal only appends, so a game set back is journaled afresh after
+    // what is already there; recovery takes it only once every move is in
+    m_journal.restart(m_game.bag().seed(), m_moves.data(), m_record.moves());
+}
+
+void GameTab::validateTurn() {
+    // ensure the active player actually placed tiles
+    if (m_board->newTiles().isEmpty()) {
+        QMessageBox::information(this, "Empty Turn", "You haven't placed any tiles.");
+        return;
+    }
+
+    TracePhase turn("turn");
+    EquationValidator::capture(*m_board, m_turn);
+
+    // GameState validates and scores, then refills the rack and passes the
+    // turn; it traces placements, GameRules::validate and computeScoreForTurn
+    RuleCheck check;
+    int points = 0;
+    bool ok;
+    {
+        TracePhase rules("GameState::place");
+        ok = m_game.place(m_turn.tiles, m_turn.count, check, points);
+    }
+    GameMetrics::recordValidation(check);
+    if (!ok) {
+        QMessageBox::warning(this, "Invalid Turn", EquationValidator::describe(check, m_turn.cells));
+        return;
+    }
+    GameMetrics::recordScore(points);
+    showScores();
+
+    // lock tiles and consume multipliers for newly covered squares
+    {
+        TracePhase trace("lockNewTiles");
+        m_board->lockNewTiles();
+    }
+
+    // the mover's rack shows what GameState drew
+    showRacks();
+    checkBagDepleted();
+    {
+        TracePhase trace("record");
+        Q_ASSERT(m_turn.count <= GameRules::MaxRackTiles);
+        RecordedMove move;
+        move.kind = MoveKind::Place;
+        move.count = m_turn.count;
+        std::copy(m_turn.tiles, m_turn.tiles + m_turn.count, move.tiles);
+        move.score = points;
+        recordMove(move);
+        m_journal.validate(points);
+    }
+
+    enableRacksForCurrentPlayer();
+    emit statusMessage(QString("Player %1 scored %2 points.").arg(2 - m_game.currentPlayer()).arg(points), 3000);
+}
+
+void GameTab::undo() {
+    if (m_board->newTiles().isEmpty()) {
+        // Nothing placed this turn: take back the last move
+        if (m_record.moves() == 0) {
+            emit statusMessage("Nothing to undo", 1500);
+            return;
+        }
+        goToPly(m_record.moves() - 1);
+        emit statusMessage(QString("Took back move %1. Player %2's turn.")
+                           .arg(m_record.moves() + 1).arg(m_game.currentPlayer() + 1), 2000);
+        return;
+    }
+
+    // only the current player may undo their new placements during their turn
+    QList<QChar> returned;
+    m_board->rollbackNewTiles(returned);
+    if (!returned.isEmpty()) m_journal.undo();
+    // give tiles back to current player's rack
+    m_racks[m_game.currentPlayer()]->addTiles(QVector<QChar>(returned.begin(), returned.end()));
+    emit statusMessage("Undid placements", 1500);
+}
+
+void GameTab::redo() {
+    if (!m_board->newTiles().isEmpty()) {
+        QMessageBox::information(this, "Cannot Redo", "Undo your placements before replaying a move.");
+        return;
+    }
+    if (m_record.moves() >= int(m_moves.size())) {
+        emit statusMessage("Nothing to redo", 1500);
+        return;
+    }
+    goToPly(m_record.moves() + 1);
+    emit statusMessage(QString("Replayed move %1. Player %2's turn.")
+                       .arg(m_record.moves()).arg(m_game.currentPlayer() + 1), 2000);
+}
+
+void GameTab::swapTiles() {
+    // Swap operates on current player's rack
+    RackView *rack = m_racks[m_game.currentPlayer()];
+
+    // Tiles left on the board would carry over into the next player's turn
+    if (!m_board->newTiles().isEmpty()) {
+        QMessageBox::information(this, "Cannot Swap", "Undo your placements before swapping tiles.");
+        return;
+    }
+
+    SwapDialog dlg(rack->nonEqualsTiles(), this);
+    if (dlg.exec() != QDialog::Accepted) return;
+    QList<QChar> tilesToSwap = dlg.getSelectedTiles();
+    if (tilesToSwap.isEmpty()) {
+        return; // nothing selected
+    }
+    int swapCount = tilesToSwap.count();
+
+    // Ensure bag has enough tiles
+    if (m_game.bag().otherTilesCount() < swapCount) {
+        QMessageBox::warning(this, "Cannot Swap", "There are not enough tiles left in the bag to perform this swap.");
+        return;
+    }
+
+    // Return them to the bag and draw replacements
+    QByteArray swapped;
+    for (QChar ch : tilesToSwap) swapped.append(ch.toLatin1());
+    if (!m_game.swap(swapped.constData(), swapCount)) return;
+    showRacks();
+
+    RecordedMove move;
+    move.kind = MoveKind::Swap;
+    move.count = swapCount;
+    std::copy(swapped.constData(), swapped.constData() + swapCount, move.swapped);
+    recordMove(move);
+    GameMetrics::recordSwap();
+    checkBagDepleted();
+    m_journal.swap(swapped.constData(), swapCount);
+
+    // the swap ends the player's turn
+    enableRacksForCurrentPlayer();
+    emit statusMessage(QString("Player %1 swapped %2 tile(s).").arg(2 - m_game.currentPlayer()).arg(swapCount), 2000);
+}
+
+void GameTab::hint() {
+    // Hints are for the committed board and the whole rack, tiles placed this turn included
+    const int player = m_game.currentPlayer();
+    const char *cells = m_game.board();
+    bool opening = std::none_of(cells, cells + GameRules::CellCount, [](char ch) { return ch != '\0'; });
+
+    // The opening depends on the rack alone, so it is precomputed
+    if (opening && m_book && m_book->isValid()) {
+        if (const OpeningBookEntry *e = m_book->lookup(m_game.rack(player))) {
+            if (e->length == 0) {
+                emit statusMessage("No equation can be made from this rack; consider swapping.", 3000);
+            } else {
+                QString eq = QString::fromLatin1(e->equation, e->length);
+                emit statusMessage(QString("Best opening: %1 across row %2 from column %3 (%4 points).")
+                                   .arg(eq).arg(GameRules::Center + 1).arg(e->startCol + 1).arg(e->score), 6000);
+            }
+            return;
+        }
+    }
+
+    // Anything else is searched on the shared pool
+    struct Search {
+        char board[GameRules::CellCount];
+        bool used[GameRules::CellCount];
+        int rack[GameRules::SymbolCount];
+    } search;
+    std::memcpy(search.board, cells, sizeof search.board);
+    std::memcpy(search.used, m_game.multipliersUsed(), sizeof search.used);
+    std::memcpy(search.rack, m_game.rack(player), sizeof search.rack);
+    int serial = ++m_hintSerial;
+    {
+        std::lock_guard<std::mutex> lock(m_hintMutex);
+        ++m_hintsRunning;
+    }
+    emit statusMessage("Searching for the best move...", 0);
+    m_pool->post([this, serial, search] {
+        Move best;
+        bool found;
+        {
+            TracePhase trace("hintSearch");
+            found = MoveGenerator(search.board, search.used, search.rack).best(best);
+        }
+        QMetaObject::invokeMethod(this, [this, serial, found, best] { showHint(serial, found, best); },
+                                  Qt::QueuedConnection);
+        std::lock_guard<std::mutex> lock(m_hintMutex);
+        if (--m_hintsRunning == 0) m_hintDone.notify_all();
+    });
+}
+
+void GameTab::showHint(int serial, bool found, const Move &move) {
+    if (serial != m_hintSerial) return;     // the position has moved on
+    if (!found) emit statusMessage("No move can be made from this rack; consider swapping.", 3000);
+    else emit statusMessage(QString("Best move: %1 (%2 points).").arg(describeMove(move)).arg(move.score), 6000);
+}
+
+QString GameTab::describeMove(const Move &move) const {
+    // The new tiles and the board tiles between them, as they will read
+    const int N = GameRules::BoardSize;
+    char cells[GameRules::CellCount];
+    std::memcpy(cells, m_game.board(), sizeof cells);
+    int r0 = N, r1 = -1, c0 = N, c1 = -1;
+    for (int i = 0; i < move.count; ++i) {
+        const TilePlacement &t = move.tiles[i];
+        cells[t.row*N + t.col] = t.ch;
+        r0 = std::min(r0, t.row);
+        r1 = std::max(r1, t.row);
+        c0 = std::min(c0, t.col);
+        c1 = std::max(c1, t.col);
+    }
+    if (move.count == 1)
+        return QString("%1 at row %2, column %3").arg(QChar::fromLatin1(move.tiles[0].ch)).arg(r0 + 1).arg(c0 + 1);
+
+    bool vertical = c0 == c1;
+    QString run;
+    for (int i = vertical ? r0 : c0; i <= (vertical ? r1 : c1); ++i)
+        run.append(QChar::fromLatin1(vertical ? cells[i*N + c0] : cells[r0*N + i]));
+    if (vertical) return QString("%1 down column %2 from row %3").arg(run).arg(c0 + 1).arg(r0 + 1);
+    return QString("%1 across row %2 from column %3").arg(run).arg(r0 + 1).arg(c0 + 1);
+}
+
+void GameTab::saveRecord() {
+    QString path = QFileDialog::getSaveFileName(this, "Save Game Record", QString(), "Equatix records (*.eqxr)");
+    if (path.isEmpty()) return;
+    QFile f(path);
+    const std::vector<uint8_t> &bytes = m_record.bytes();
+    if (!f.open(QIODevice::WriteOnly)
+        || f.write(reinterpret_cast<const char*>(bytes.data()), qint64(bytes.size())) != qint64(bytes.size())) {
+        QMessageBox::warning(this, "Save Failed", f.errorString());
+        return;
+    }
+    emit statusMessage(QString("Saved %1 moves to %2").arg(m_record.moves()).arg(path), 3000);
+}
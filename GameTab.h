@@ -0,0 +1,102 @@
+#ifndef GAMETAB_H
+#define GAMETAB_H
+
+#include <QWidget>
+#include <QVector>
+#include <QChar>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "GameState.h"
+#include "GameRecord.h"
+#include "PositionHistory.h"
+#include "TurnJournal.h"
+#include "EquationValidator.h"
+#include "MoveGenerator.h"
+
+class BoardView;
+class RackView;
+class QLabel;
+class OpeningBook;
+class TaskPool;
+
+// One table: a board, both racks and the scores over a core GameState, which
+// holds the bag, racks, scores and turn. A MainWindow shows several, and they
+// share its TaskPool (autosave writes, hint searches) and opening book.
+class GameTab : public QWidget {
+    Q_OBJECT
+public:
+    // Resumes the game autosaved at journalPath, or deals a new one there.
+    GameTab(TaskPool *pool, const OpeningBook *book, const QByteArray &journalPath, QWidget *parent = nullptr);
+    ~GameTab() override;
+
+    const GameState& game() const { return m_game; }
+    BoardView* board() const { return m_board; }
+    const QByteArray& journalPath() const { return m_journalPath; }
+
+    // Stop autosaving and delete the autosave, for a game being abandoned.
+    void discard();
+
+public slots:
+    void validateTurn();
+    void undo();
+    void redo();
+    void swapTiles();
+    void hint();
+    void saveRecord();
+
+signals:
+    void statusMessage(const QString &text, int timeoutMs);
+
+private:
+    BoardView *m_board;
+    RackView *m_racks[2]; // index 0 = Player 1, index 1 = Player 2
+    QLabel *m_scoreLabels[2] = {nullptr, nullptr};
+
+    // bag, racks, scores and whose turn it is; the widgets show it
+    GameState m_game;
+
+    // every committed move, for saving and replay
+    GameRecordWriter m_record;
+
+    // every move made, including ones taken back that Redo can replay, and
+    // the board after each; m_record.moves() of them are in play
+    std::vector<RecordedMove> m_moves;
+    PositionHistory m_positions;
+
+    // crash-safe autosave of every turn event, written on the shared pool
+    TaskPool *m_pool;
+    TurnJournal m_journal;
+    QByteArray m_journalPath;
+
+    const OpeningBook *m_book;
+
+    // the turn being validated, reused from turn to turn
+    TurnInput m_turn;
+
+    // hint searches run on the pool; a result is shown only if nothing was
+    // played or taken back since it was asked for
+    int m_hintSerial = 0;
+    int m_hintsRunning = 0;             // guarded by m_hintMutex
+    std::mutex m_hintMutex;
+    std::condition_variable m_hintDone;
+
+    // gameplay metrics
+    QElapsedTimer m_gameClock;
+    bool m_bagDepleted = false;
+
+    void showRacks();                            // rack widgets from m_game, keeping tiles already shown
+    void showScores();
+    void enableRacksForCurrentPlayer();          // enable/disable racks according to current player
+    bool resumeFromJournal();                    // rebuild the game an earlier run left behind
+    void checkBagDepleted();
+    void recordMove(const RecordedMove &move);   // append to the game, dropping any redo
+    void goToPly(int ply);                       // set the game back or forward to after ply moves
+    void rewriteJournal();                       // append the game as it now stands
+    void showHint(int serial, bool found, const Move &move);
+    QString describeMove(const Move &move) const;
+};
+
+#endif // GAMETAB_H
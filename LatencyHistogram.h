@@ -0,0 +1,98 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Log-linear histogram in the style of HdrHistogram: every power of two is
+// split into 64 sub-buckets, so any recorded value is kept to within 1.6%.
+// Values are unsigned integers (nanoseconds for latencies); recording is a
+// couple of shifts and an increment. Histograms of the same shape merge.
+class LatencyHistogram {
+public:
+    static constexpr int SubBucketBits = 6;
+    static constexpr int SubBuckets = 1 << SubBucketBits;
+    static constexpr int BucketCount = (64 - SubBucketBits) * SubBuckets + SubBuckets;
+
+    LatencyHistogram() : m_counts(BucketCount, 0) {}
+
+    void record(uint64_t v) {
+        ++m_counts[indexOf(v)];
+        ++m_total;
+        m_sum += v;
+        if (v > m_max) m_max = v;
+    }
+
+    void merge(const LatencyHistogram& o) {
+        for (int i = 0; i < BucketCount; ++i) m_counts[i] += o.m_counts[i];
+        m_total += o.m_total;
+        m_sum += o.m_sum;
+        if (o.m_max > m_max) m_max = o.m_max;
+    }
+
+    void reset() {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_total = m_sum = m_max = 0;
+    }
+
+    uint64_t count() const { return m_total; }
+    uint64_t max() const { return m_max; }
+    double mean() const { return m_total ? double(m_sum) / double(m_total) : 0.0; }
+
+    // Highest value equivalent to the sample at percentile p (0-100).
+    uint64_t percentile(double p) const {
+        if (m_total == 0) return 0;
+        uint64_t rank = uint64_t(p / 100.0 * double(m_total) + 0.5);
+        if (rank < 1) rank = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BucketCount; ++i) {
+            seen += m_counts[i];
+            if (seen >= rank) return highestOf(i) < m_max ? highestOf(i) : m_max;
+        }
+        return m_max;
+    }
+
+    // Percentile distribution in the .hgrm text layout read by the
+    // HdrHistogram plotters; values are divided by unit (1e6 for ns -> ms).
+    void writeHgrm(std::FILE* f, double unit) const {
+        std::fprintf(f, "%12s %14s %10s %14s\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+        uint64_t seen = 0;
+        for (int i = 0; i < BucketCount; ++i) {
+            if (!m_counts[i]) continue;
+            seen += m_counts[i];
+            double q = double(seen) / double(m_total);
+            if (q < 1.0) {
+                std::fprintf(f, "%12.3f %14.12f %10llu %14.2f\n", double(highestOf(i)) / unit, q,
+                             (unsigned long long)seen, 1.0 / (1.0 - q));
+            } else {
+                std::fprintf(f, "%12.3f %14.12f %10llu\n", double(m_max) / unit, q, (unsigned long long)seen);
+            }
+        }
+        std::fprintf(f, "#[Mean    = %12.3f, Max         = %12.3f]\n", mean() / unit, double(m_max) / unit);
+        std::fprintf(f, "#[Total count = %10llu, SubBuckets = %6d]\n", (unsigned long long)m_total, SubBuckets);
+    }
+
+private:
+    static int indexOf(uint64_t v) {
+        if (v < uint64_t(SubBuckets) * 2) return int(v);
+        int shift = 63 - std::countl_zero(v) - SubBucketBits;
+        return shift * SubBuckets + int(v >> shift);
+    }
+
+    static uint64_t highestOf(int index) {
+        if (index < SubBuckets * 2) return uint64_t(index);
+        int shift = index / SubBuckets - 1;
+        uint64_t mantissa = uint64_t(index % SubBuckets + SubBuckets);
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> m_counts;
+    uint64_t m_total = 0;
+    uint64_t m_sum = 0;
+    uint64_t m_max = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
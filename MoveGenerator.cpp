@@ -0,0 +1,267 @@
+#include "MoveGenerator.h"
+#include "BatchScorer.h"
+#include "GameState.h"
+#include <cstring>
+
+namespace {
+
+constexpr int N = GameRules::BoardSize;
+constexpr uint16_t kAllSymbols = (1u << GameRules::SymbolCount) - 1;
+
+// Shape of the main run read so far, as bits: the next tile must be a digit
+// (0) or may be anything (kInNumber), whether it holds an '=', and whether it
+// can no longer become an equation.
+constexpr int kInNumber = 1;
+constexpr int kSeenEquals = 2;
+constexpr int kBroken = 4;
+
+int step(int state, char ch) {
+    if (ch == '=') {
+        if ((state & (kInNumber | kSeenEquals)) != kInNumber) state |= kBroken;
+        return (state | kSeenEquals) & ~kInNumber;
+    }
+    if (ch >= '0' && ch <= '9') return state | kInNumber;
+    if (!(state & kInNumber)) state |= kBroken;
+    return state & ~kInNumber;
+}
+
+bool dead(int state) {
+    return (state & (kBroken | kSeenEquals)) == (kBroken | kSeenEquals);
+}
+
+} // namespace
+
+MoveGenerator::MoveGenerator(const char* board, const bool* multiplierUsed, const int* rack)
+    : m_used(multiplierUsed) {
+    std::memcpy(m_cells, board, sizeof m_cells);
+    std::memcpy(m_rack, rack, sizeof m_rack);
+    for (int i = 0; i < GameRules::CellCount && m_empty; ++i) m_empty = !m_cells[i];
+    computeCrossChecks();
+}
+
+MoveGenerator::MoveGenerator(const GameState& game)
+    : MoveGenerator(game.board(), game.multipliersUsed(), game.rack(game.currentPlayer())) {}
+
+int MoveGenerator::cellAt(int pos) const {
+    return m_vertical ? pos*N + m_line : m_line*N + pos;
+}
+
+void MoveGenerator::computeCrossChecks() {
+    char buf[N];
+    for (int r = 0; r < N; ++r) {
+        for (int c = 0; c < N; ++c) {
+            int cell = r*N + c;
+            m_anchor[cell] = false;
+            if (m_cells[cell]) continue;
+            m_anchor[cell] = m_empty ? (r == GameRules::Center && c == GameRules::Center)
+                : (r > 0 && m_cells[cell-N]) || (r+1 < N && m_cells[cell+N])
+                  || (c > 0 && m_cells[cell-1]) || (c+1 < N && m_cells[cell+1]);
+
+            for (int dir = 0; dir < 2; ++dir) {
+                // The crossing run of an across move is vertical and vice versa
+                int dr = dir == 0 ? 1 : 0, dc = dir == 0 ? 0 : 1;
+                int lo = 0, hi = 0;
+                while (r - (lo+1)*dr >= 0 && c - (lo+1)*dc >= 0 && m_cells[cell - (lo+1)*(dr*N + dc)]) ++lo;
+                while (r + (hi+1)*dr < N && c + (hi+1)*dc < N && m_cells[cell + (hi+1)*(dr*N + dc)]) ++hi;
+                if (lo + hi == 0) {
+                    m_crossOk[dir][cell] = kAllSymbols;
+                    m_crossEq[dir][cell] = 0;
+                    continue;
+                }
+                bool hasEquals = false;
+                for (int i = -lo; i <= hi; ++i) {
+                    buf[i + lo] = i ? m_cells[cell + i*(dr*N + dc)] : '\0';
+                    hasEquals |= buf[i + lo] == '=';
+                }
+                uint16_t ok = 0, eq = 0;
+                for (int s = 0; s < GameRules::SymbolCount; ++s) {
+                    buf[lo] = GameRules::symbolChar(s);
+                    if (!hasEquals && s != GameRules::EqualsSymbol) {
+                        ok |= 1u << s;
+                    } else if (GameRules::checkEquation(buf, lo + hi + 1) == EquationError::None) {
+                        ok |= 1u << s;
+                        eq |= 1u << s;
+                    }
+                }
+                m_crossOk[dir][cell] = ok;
+                m_crossEq[dir][cell] = eq;
+            }
+        }
+    }
+}
+
+void MoveGenerator::forEach(const std::function<bool(const Move&)>& visit) {
+    m_visit = &visit;
+    m_stopped = false;
+    for (bool vertical : {false, true}) {
+        for (int line = 0; line < N && !m_stopped; ++line) scanLine(vertical, line);
+    }
+    m_visit = nullptr;
+}
+
+std::vector<Move> MoveGenerator::all() {
+    std::vector<Move> moves;
+    forEach([&](const Move& m) { moves.push_back(m); return true; });
+    return moves;
+}
+
+std::vector<Move> MoveGenerator::all(ScoreBatch& batch) {
+    batch.clear(m_cells);
+    m_batch = &batch;
+    std::vector<Move> moves = all();
+    m_batch = nullptr;
+    return moves;
+}
+
+bool MoveGenerator::best(Move& out) {
+    bool found = false;
+    forEach([&](const Move& m) {
+        if (!found || m.score > out.score) out = m;
+        found = true;
+        return true;
+    });
+    return found;
+}
+
+void MoveGenerator::scanLine(bool vertical, int line) {
+    m_vertical = vertical;
+    m_line = line;
+    int tiles = 0;
+    for (int s = 0; s < GameRules::SymbolCount; ++s) tiles += m_rack[s];
+    if (tiles > GameRules::MaxRackTiles) tiles = GameRules::MaxRackTiles;
+
+    for (int p = 0; p < N && !m_stopped; ++p) {
+        if (m_cells[cellAt(p)]) continue;
+
+        // Skip starts that run out of tiles before reaching an anchor
+        bool reaches = false;
+        for (int pos = p, empties = 0; pos < N && empties < tiles && !reaches; ++pos) {
+            if (m_cells[cellAt(pos)]) continue;
+            reaches = m_anchor[cellAt(pos)];
+            ++empties;
+        }
+        if (!reaches) continue;
+
+        // Board tiles just before p belong to the run
+        m_runStart = p;
+        while (m_runStart > 0 && m_cells[cellAt(m_runStart - 1)]) --m_runStart;
+        int state = 0;
+        bool lhsOk = true;
+        for (int pos = m_runStart; pos < p && lhsOk; ++pos) {
+            int next = step(state, m_cells[cellAt(pos)]);
+            lhsOk = !(next & ~state & kSeenEquals) || enterRhs(pos, next);
+            state = next;
+        }
+        if (!lhsOk || dead(state)) continue;
+
+        m_looseTiles = 0;
+        m_touches = 0;
+        extend(p, 0, state);
+    }
+}
+
+void MoveGenerator::extend(int pos, int placed, int state) {
+    if (m_stopped) return;
+    int cell = pos < N ? cellAt(pos) : -1;
+
+    if (cell >= 0 && m_cells[cell]) {
+        int next = step(state, m_cells[cell]);
+        if (dead(next) || ((next & kBroken) && m_looseTiles)) return;
+        if ((next & ~state & kSeenEquals) && !enterRhs(pos, next)) return;
+        extend(pos + 1, placed, next);
+        return;
+    }
+
+    // An empty square or the edge ends the run here
+    if (placed > 0 && !report(pos, placed, state)) {
+        m_stopped = true;
+        return;
+    }
+    if (cell < 0 || placed == GameRules::MaxRackTiles) return;
+
+    uint16_t ok = m_crossOk[m_vertical][cell];
+    uint16_t eq = m_crossEq[m_vertical][cell];
+    for (int s = 0; s < GameRules::SymbolCount && !m_stopped; ++s) {
+        if (!m_rack[s] || !(ok & (1u << s))) continue;
+        char ch = GameRules::symbolChar(s);
+        int next = step(state, ch);
+        bool loose = !(eq & (1u << s));
+        if (dead(next) || ((next & kBroken) && (loose || m_looseTiles))) continue;
+        if ((next & ~state & kSeenEquals) && !enterRhs(pos, next)) continue;
+
+        m_cells[cell] = ch;
+        --m_rack[s];
+        m_move.tiles[placed] = {cell / N, cell % N, ch};
+        m_looseTiles += loose;
+        m_touches += m_anchor[cell];
+        extend(pos + 1, placed + 1, next);
+        m_touches -= m_anchor[cell];
+        m_looseTiles -= loose;
+        ++m_rack[s];
+        m_cells[cell] = '\0';
+    }
+}
+
+// The left side is complete once the '=' is read: evaluate it a single time
+// for every right side tried after it. pos is the '=' square.
+bool MoveGenerator::enterRhs(int pos, int state) {
+    if (state & kBroken) return false;
+    char buf[N];
+    for (int i = m_runStart; i < pos; ++i) buf[i - m_runStart] = m_cells[cellAt(i)];
+    auto lhs = GameRules::evalExpr(buf, pos - m_runStart);
+    if (!lhs) return false;
+    m_lhs = *lhs;
+    m_equalsPos = pos;
+    return true;
+}
+
+bool MoveGenerator::report(int end, int placed, int state) {
+    if (!m_touches) return true;
+    if (m_vertical && placed == 1) return true; // already reported across
+
+    if (state & kSeenEquals) {
+        if (!(state & kInNumber)) return true;
+        char buf[N];
+        for (int pos = m_equalsPos + 1; pos < end; ++pos) buf[pos - m_equalsPos - 1] = m_cells[cellAt(pos)];
+        auto rhs = GameRules::evalExpr(buf, end - m_equalsPos - 1);
+        if (!rhs || *rhs != m_lhs) return true;
+    } else if (m_looseTiles) {
+        return true;
+    }
+
+    m_move.count = placed;
+    if (m_batch) {
+        addRuns(end, placed);
+        m_move.score = 0;
+    } else {
+        m_move.score = GameRules::scoreTurn(m_cells, m_used, m_move.tiles, placed);
+    }
+    return (*m_visit)(m_move);
+}
+
+// The runs scoreTurn would count: the main run if it is an equation, and
+// each new tile's crossing run that holds an '=', which the cross checks
+// have already made an equation. No two of them can be the same run.
+void MoveGenerator::addRuns(int end, int placed) {
+    bool equation = false;
+    for (int pos = m_runStart; pos < end; ++pos) equation |= m_cells[cellAt(pos)] == '=';
+    if (end - m_runStart >= 2 && equation) {
+        for (int pos = m_runStart; pos < end; ++pos) m_batch->addTile(cellAt(pos), m_cells[cellAt(pos)]);
+        m_batch->endRun();
+    }
+    int stride = m_vertical ? 1 : N;
+    for (int t = 0; t < placed; ++t) {
+        int cell = m_move.tiles[t].row*N + m_move.tiles[t].col;
+        int along = m_vertical ? m_move.tiles[t].col : m_move.tiles[t].row;
+        int lo = 0, hi = 0;
+        while (along - lo > 0 && m_cells[cell - (lo+1)*stride]) ++lo;
+        while (along + hi + 1 < N && m_cells[cell + (hi+1)*stride]) ++hi;
+        if (lo + hi == 0) continue;
+        equation = false;
+        for (int i = -lo; i <= hi; ++i) equation |= m_cells[cell + i*stride] == '=';
+        if (!equation) continue;
+        for (int i = -lo; i <= hi; ++i) m_batch->addTile(cell + i*stride, m_cells[cell + i*stride]);
+        m_batch->endRun();
+    }
+    m_batch->endMove();
+}
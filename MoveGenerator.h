@@ -0,0 +1,72 @@
+#ifndef MOVEGENERATOR_H
+#define MOVEGENERATOR_H
+
+#include "GameRules.h"
+#include <functional>
+#include <vector>
+
+class GameState;
+class ScoreBatch;
+
+struct Move {
+    TilePlacement tiles[GameRules::MaxRackTiles];
+    int count = 0;
+    int score = 0;
+};
+
+// Enumerates legal placements for one rack. The rules accept any tiles in a
+// line that touch the board, so the generator keeps to the moves worth
+// playing: the new tiles and the board tiles between them form one run, and
+// every new tile is part of at least one equation. Each such move is
+// reported once, already validated and scored.
+class MoveGenerator {
+public:
+    // rack holds counts indexed by GameRules::symbolIndex.
+    MoveGenerator(const char* board, const bool* multiplierUsed, const int* rack);
+    explicit MoveGenerator(const GameState& game); // current player's rack
+
+    // Calls visit for every move until it returns false.
+    void forEach(const std::function<bool(const Move&)>& visit);
+
+    std::vector<Move> all();
+    // Every move unscored, with its scoring runs appended to batch in the
+    // same order for BatchScorer, which finds them already walked.
+    std::vector<Move> all(ScoreBatch& batch);
+    bool best(Move& out);   // highest score, first found on ties
+
+private:
+    void computeCrossChecks();
+    void scanLine(bool vertical, int line);
+    void extend(int pos, int placed, int state);
+    bool enterRhs(int pos, int state);
+    bool report(int end, int placed, int state);
+    void addRuns(int end, int placed);
+
+    int cellAt(int pos) const;
+
+    char m_cells[GameRules::CellCount];
+    const bool* m_used;
+    int m_rack[GameRules::SymbolCount];
+    bool m_empty = true;
+
+    // Per cell and main direction: symbols allowed by the crossing run, and
+    // symbols for which that run is an equation.
+    uint16_t m_crossOk[2][GameRules::CellCount];
+    uint16_t m_crossEq[2][GameRules::CellCount];
+    bool m_anchor[GameRules::CellCount];
+
+    // Current line walk
+    const std::function<bool(const Move&)>* m_visit = nullptr;
+    ScoreBatch* m_batch = nullptr;  // runs go here instead of scoreTurn
+    bool m_stopped = false;
+    bool m_vertical = false;
+    int m_line = 0;
+    int m_runStart = 0;
+    Move m_move;
+    int m_looseTiles = 0;    // new tiles that rely on the main run for an equation
+    int m_touches = 0;       // new tiles on anchor squares
+    int m_equalsPos = 0;     // '=' of the main run and the value left of it
+    long long m_lhs = 0;
+};
+
+#endif // MOVEGENERATOR_H
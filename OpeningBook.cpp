@@ -0,0 +1,73 @@
+#include "OpeningBook.h"
+#include "GameRules.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Binomial coefficients up to C(31, k), enough for multisets of 14 symbols.
+struct Binomials {
+    uint32_t c[32][32] {};
+    constexpr Binomials() {
+        for (int n = 0; n < 32; ++n) {
+            c[n][0] = 1;
+            for (int k = 1; k <= n; ++k) c[n][k] = c[n-1][k-1] + (k <= n-1 ? c[n-1][k] : 0);
+        }
+    }
+};
+
+constexpr Binomials kBinom;
+
+} // namespace
+
+uint32_t OpeningBook::multisetIndex(const int counts[], int size) {
+    // Combinatorial number system: sorted symbols a_1 <= ... <= a_k become
+    // the strictly increasing b_i = a_i + i - 1, ranked as sum C(b_i, i).
+    uint32_t rank = 0;
+    int i = 0;
+    for (int sym = 0; sym < GameRules::OtherSymbolCount; ++sym) {
+        for (int k = 0; k < counts[sym]; ++k) {
+            ++i;
+            rank += kBinom.c[sym + i - 1][i];
+        }
+    }
+    return i == size ? rank : UINT32_MAX;
+}
+
+uint32_t OpeningBook::multisetCount(int size) {
+    return kBinom.c[GameRules::OtherSymbolCount + size - 1][size];
+}
+
+bool OpeningBook::attach(const void* data, size_t size) {
+    m_entries = nullptr;
+    m_count = 0;
+    if (!data || size < sizeof(OpeningBookHeader)) return false;
+    OpeningBookHeader h;
+    std::memcpy(&h, data, sizeof h);
+    if (std::memcmp(h.magic, "EQXOPEN1", 8) != 0 || h.version != Version) return false;
+    if ((size - sizeof h) / sizeof(OpeningBookEntry) < h.count) return false;
+    m_entries = reinterpret_cast<const OpeningBookEntry*>(static_cast<const char*>(data) + sizeof h);
+    m_count = h.count;
+    return true;
+}
+
+const OpeningBookEntry* OpeningBook::lookup(const int counts[]) const {
+    if (!m_entries) return nullptr;
+    uint32_t key = rackIndex(counts);
+    if (key == UINT32_MAX) return nullptr;
+    const OpeningBookEntry* end = m_entries + m_count;
+    const OpeningBookEntry* it = std::lower_bound(m_entries, end, key,
+        [](const OpeningBookEntry& e, uint32_t k) { return e.rack < k; });
+    return (it != end && it->rack == key) ? it : nullptr;
+}
+
+const OpeningBookEntry* OpeningBook::lookupChars(const char* tiles, int n) const {
+    int counts[GameRules::OtherSymbolCount] = {};
+    for (int i = 0; i < n; ++i) {
+        int sym = GameRules::symbolIndex(tiles[i]);
+        if (sym < 0) return nullptr;
+        if (sym == GameRules::EqualsSymbol) continue; // the '=' is implied
+        ++counts[sym];
+    }
+    return lookup(counts);
+}
@@ -0,0 +1,61 @@
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Precomputed best first move for every opening rack.
+//
+// An opening rack is one '=' plus seven other tiles, and the first move is
+// scored on an empty board, so the best opening depends on the rack alone.
+// tools/build_opening_book.cpp solves every rack offline and writes a file of
+// fixed-size entries sorted by rack index. The file is little-endian and meant
+// to be memory-mapped; OpeningBook only reads from the mapped bytes.
+//
+// Moves are stored for the centre row. The premium layout is symmetric under
+// transpose, so the same equation played down the centre column scores the same.
+
+struct OpeningBookHeader {
+    char magic[8];      // "EQXOPEN1"
+    uint32_t version;
+    uint32_t count;     // number of entries following the header
+};
+
+struct OpeningBookEntry {
+    uint32_t rack;      // OpeningBook::rackIndex of the seven non-equals tiles
+    uint16_t score;     // 0 if no opening exists for this rack
+    uint8_t startCol;   // first column of the equation on the centre row
+    uint8_t length;     // chars used in equation, 0 if no opening exists
+    char equation[8];   // not NUL-terminated when length == 8
+};
+
+static_assert(sizeof(OpeningBookHeader) == 16, "opening book header layout");
+static_assert(sizeof(OpeningBookEntry) == 16, "opening book entry layout");
+
+class OpeningBook {
+public:
+    static constexpr uint32_t Version = 1;
+    static constexpr int RackSize = 7;  // non-equals tiles in a full rack
+
+    // Rank of a multiset of non-equals symbols (counts indexed by
+    // GameRules::symbolIndex) among all multisets of the same size.
+    static uint32_t multisetIndex(const int counts[], int size);
+    static uint32_t rackIndex(const int counts[]) { return multisetIndex(counts, RackSize); }
+    static uint32_t multisetCount(int size);  // number of distinct ranks for size
+
+    // Attach to a mapped file. Returns false if the header does not match.
+    bool attach(const void* data, size_t size);
+    bool isValid() const { return m_entries != nullptr; }
+    uint32_t size() const { return m_count; }
+
+    // Look up a rack of seven non-equals tiles. Returns nullptr if the rack is
+    // not in the book (wrong size or book not attached).
+    const OpeningBookEntry* lookup(const int counts[]) const;
+    const OpeningBookEntry* lookupChars(const char* tiles, int n) const;
+
+private:
+    const OpeningBookEntry* m_entries = nullptr;
+    uint32_t m_count = 0;
+};
+
+#endif // OPENINGBOOK_H
@@ -0,0 +1,64 @@
+#include "PositionHistory.h"
+#include <cstring>
+
+PositionHistory::PositionHistory() {
+    m_rows.push_back(Row{});    // row 0: the empty row every board starts from
+    m_positions.push_back(Position{{}, 1});
+}
+
+void PositionHistory::push(const TilePlacement* tiles, int n) {
+    const int N = GameRules::BoardSize;
+    Position next = m_positions.back();
+    bool copied[GameRules::BoardSize] = {};
+    for (int i = 0; i < n; ++i) {
+        const TilePlacement& t = tiles[i];
+        if (t.row < 0 || t.row >= N || t.col < 0 || t.col >= N) continue;
+        if (!copied[t.row]) {
+            // Copy on first write; earlier positions keep the old row
+            Row row = m_rows[next.rows[t.row]];
+            next.rows[t.row] = uint16_t(m_rows.size());
+            m_rows.push_back(row);
+            copied[t.row] = true;
+        }
+        m_rows[next.rows[t.row]].cells[t.col] = t.ch;
+    }
+    next.poolEnd = uint16_t(m_rows.size());
+    m_positions.push_back(next);
+}
+
+void PositionHistory::truncate(int count) {
+    if (count < 1 || count >= size()) return;
+    m_positions.resize(size_t(count));
+    // Rows are only ever appended, so the dropped positions own the tail
+    m_rows.resize(m_positions.back().poolEnd);
+}
+
+char PositionHistory::at(int ply, int cell) const {
+    const int N = GameRules::BoardSize;
+    return m_rows[m_positions[size_t(ply)].rows[cell / N]].cells[cell % N];
+}
+
+void PositionHistory::board(int ply, char* out) const {
+    const int N = GameRules::BoardSize;
+    const Position& p = m_positions[size_t(ply)];
+    for (int r = 0; r < N; ++r) std::memcpy(out + r*N, m_rows[p.rows[r]].cells, size_t(N));
+}
+
+int PositionHistory::diff(int a, int b, int* out) const {
+    const int N = GameRules::BoardSize;
+    const Position& pa = m_positions[size_t(a)];
+    const Position& pb = m_positions[size_t(b)];
+    int n = 0;
+    for (int r = 0; r < N; ++r) {
+        if (pa.rows[r] == pb.rows[r]) continue;
+        const Row& ra = m_rows[pa.rows[r]];
+        const Row& rb = m_rows[pb.rows[r]];
+        for (int c = 0; c < N; ++c)
+            if (ra.cells[c] != rb.cells[c]) out[n++] = r*N + c;
+    }
+    return n;
+}
+
+size_t PositionHistory::bytes() const {
+    return m_rows.capacity() * sizeof(Row) + m_positions.capacity() * sizeof(Position);
+}
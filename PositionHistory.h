@@ -0,0 +1,52 @@
+#ifndef POSITIONHISTORY_H
+#define POSITIONHISTORY_H
+
+#include "GameRules.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Every committed board of one game, for stepping through it.
+//
+// Rows are immutable once written and live in one pool; a position is
+// BoardSize indices into it. A move copies only the rows it touches, so
+// consecutive positions share the rest: a position costs 32 bytes plus 15
+// per row changed, and a 100-move game fits in a few KB. Any position is
+// read in O(1), and two positions are compared only on the rows they do not
+// share.
+class PositionHistory {
+public:
+    PositionHistory();  // one position, the empty board
+
+    // Positions held; position p is the board after p moves.
+    int size() const { return int(m_positions.size()); }
+
+    // Append the board after tiles are played on the last one. A swap plays
+    // no tiles and repeats the last board.
+    void push(const TilePlacement* tiles, int n);
+    // Keep the first count positions (at least one).
+    void truncate(int count);
+    void clear() { truncate(1); }
+
+    char at(int ply, int cell) const;
+    // CellCount chars, row-major, '\0' for an empty square.
+    void board(int ply, char* out) const;
+
+    // Cells whose tiles differ between two positions; out needs room for
+    // CellCount. Returns how many.
+    int diff(int a, int b, int* out) const;
+
+    size_t bytes() const;
+
+private:
+    struct Row { char cells[GameRules::BoardSize]; };
+    struct Position {
+        uint16_t rows[GameRules::BoardSize];
+        uint16_t poolEnd;   // rows in the pool once this position was added
+    };
+
+    std::vector<Row> m_rows;
+    std::vector<Position> m_positions;
+};
+
+#endif // POSITIONHISTORY_H
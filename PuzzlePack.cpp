@@ -0,0 +1,35 @@
+#include "PuzzlePack.h"
+#include <cstring>
+
+void PuzzlePack::packBoard(const char* board, PuzzleEntry& e) {
+    std::memset(e.cells, 0, sizeof e.cells);
+    for (int i = 0; i < GameRules::CellCount; ++i) {
+        int nibble = board[i] ? GameRules::symbolIndex(board[i]) + 1 : 0;
+        e.cells[i / 2] |= uint8_t(nibble << (i % 2 * 4));
+    }
+}
+
+char PuzzlePack::cell(const PuzzleEntry& e, int index) {
+    int nibble = (e.cells[index / 2] >> (index % 2 * 4)) & 0xf;
+    return nibble ? GameRules::symbolChar(nibble - 1) : '\0';
+}
+
+void PuzzlePack::unpackBoard(const PuzzleEntry& e, char* board, bool* multiplierUsed) {
+    for (int i = 0; i < GameRules::CellCount; ++i) {
+        board[i] = cell(e, i);
+        if (multiplierUsed) multiplierUsed[i] = board[i] != '\0';
+    }
+}
+
+bool PuzzlePack::attach(const void* data, size_t size) {
+    m_entries = nullptr;
+    m_count = 0;
+    if (!data || size < sizeof(PuzzlePackHeader)) return false;
+    PuzzlePackHeader h;
+    std::memcpy(&h, data, sizeof h);
+    if (std::memcmp(h.magic, "EQXPUZZ1", 8) != 0 || h.version != Version) return false;
+    if ((size - sizeof h) / sizeof(PuzzleEntry) < h.count) return false;
+    m_entries = reinterpret_cast<const PuzzleEntry*>(static_cast<const char*>(data) + sizeof h);
+    m_count = h.count;
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef PUZZLEPACK_H
+#define PUZZLEPACK_H
+
+#include "GameRules.h"
+#include <cstddef>
+#include <cstdint>
+
+// "Find the top-scoring move" puzzles, written by tools/build_puzzles.cpp.
+//
+// Each puzzle is a mid-game board and the rack of the player to move. Squares
+// under a tile have had their premium consumed and every other square still
+// has it, so the board alone fixes the multipliers. The solution is the only
+// move with the best score. Like the opening book the file is little-endian
+// fixed-size entries after a header, meant to be memory-mapped.
+
+struct PuzzlePackHeader {
+    char magic[8];      // "EQXPUZZ1"
+    uint32_t version;
+    uint32_t count;     // number of entries following the header
+};
+
+struct PuzzleEntry {
+    uint64_t position;      // GameState::positionHash of the board
+    uint16_t score;         // of the solution
+    uint16_t runnerUp;      // best score among the other moves
+    uint16_t moveCount;     // legal moves from MoveGenerator
+    uint8_t ply;            // turns played before the position
+    uint8_t solutionCount;  // tiles in the solution
+    char rack[GameRules::MaxRackTiles];                 // NUL-padded
+    uint8_t solution[GameRules::MaxRackTiles][2];       // cell index, char
+    uint8_t cells[(GameRules::CellCount + 1) / 2];      // see PuzzlePack::cell
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(PuzzlePackHeader) == 16, "puzzle pack header layout");
+static_assert(sizeof(PuzzleEntry) == 160, "puzzle entry layout");
+
+class PuzzlePack {
+public:
+    static constexpr uint32_t Version = 1;
+
+    // Cells are packed two per byte, low nibble first: 0 is empty, otherwise
+    // GameRules::symbolIndex + 1.
+    static void packBoard(const char* board, PuzzleEntry& e);
+    static char cell(const PuzzleEntry& e, int index);
+    static void unpackBoard(const PuzzleEntry& e, char* board, bool* multiplierUsed);
+
+    // Attach to a mapped file. Returns false if the header does not match.
+    bool attach(const void* data, size_t size);
+    bool isValid() const { return m_entries != nullptr; }
+    uint32_t size() const { return m_count; }
+    const PuzzleEntry& operator[](uint32_t i) const { return m_entries[i]; }
+
+private:
+    const PuzzleEntry* m_entries = nullptr;
+    uint32_t m_count = 0;
+};
+
+#endif // PUZZLEPACK_H
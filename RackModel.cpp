@@ -0,0 +1,29 @@
+#include "RackModel.h"
+
+int RackModel::count(char ch) const {
+    int sym = GameRules::symbolIndex(ch);
+    return sym < 0 ? 0 : m_counts[sym];
+}
+
+bool RackModel::add(char ch) {
+    int sym = GameRules::symbolIndex(ch);
+    if (sym < 0) return false;
+    ++m_counts[sym];
+    if (sym != GameRules::EqualsSymbol) ++m_nonEquals;
+    m_order.push_back(ch);
+    return true;
+}
+
+int RackModel::lastIndexOf(char ch) const {
+    if (!contains(ch)) return -1;
+    for (int i = count() - 1; i >= 0; --i)
+        if (m_order[size_t(i)] == ch) return i;
+    return -1;
+}
+
+void RackModel::removeAt(int index) {
+    int sym = GameRules::symbolIndex(m_order[size_t(index)]);
+    --m_counts[sym];
+    if (sym != GameRules::EqualsSymbol) --m_nonEquals;
+    m_order.erase(m_order.begin() + index);
+}
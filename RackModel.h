@@ -0,0 +1,32 @@
+#ifndef RACKMODEL_H
+#define RACKMODEL_H
+
+#include "GameRules.h"
+#include <vector>
+
+// Tiles on one rack as counts per symbol plus the order they are shown in.
+// Counts answer size and membership queries in O(1); the order is only
+// walked to find which tile to take out, and a rack holds at most a handful.
+class RackModel {
+public:
+    int count() const { return int(m_order.size()); }
+    int count(char ch) const;
+    int nonEqualsCount() const { return m_nonEquals; }
+    bool contains(char ch) const { return count(ch) > 0; }
+
+    const int* counts() const { return m_counts; }           // by GameRules::symbolIndex
+    const std::vector<char>& order() const { return m_order; }
+
+    // False for anything that is not a tile.
+    bool add(char ch);
+    // Position of the last ch in order(), or -1.
+    int lastIndexOf(char ch) const;
+    void removeAt(int index);
+
+private:
+    int m_counts[GameRules::SymbolCount] = {};
+    int m_nonEquals = 0;
+    std::vector<char> m_order;
+};
+
+#endif // RACKMODEL_H
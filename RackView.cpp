@@ -1,5 +1,6 @@
 #include "RackView.h"
 #include "TileLabel.h"
+#include "TurnTrace.h"
 #include <QHBoxLayout>
 #include <QDebug>
 
@@ -10,58 +11,84 @@ RackView::RackView(QWidget *parent) : QWidget(parent) {
     setLayout(h);
 }
 
-int RackView::countTiles() const {
-    return findChildren<TileLabel*>().size();
-}
-
-int RackView::countNonEqualsTiles() const {
-    int count = 0;
-    for (auto* tile : findChildren<TileLabel*>()) {
-        if (tile->tileChar() != '=') {
-            count++;
-        }
-    }
-    return count;
+void RackView::addTile(QChar ch) {
+    addTiles({ch});
 }
 
-bool RackView::hasEqualsTile() const {
-    for (auto* tile : findChildren<TileLabel*>()) {
-        if (tile->tileChar() == '=') {
-            return true;
+void RackView::addTiles(const QVector<QChar>& chars) {
+    if (chars.isEmpty()) return;
+    {
+        TracePhase trace("addTiles");
+        setUpdatesEnabled(false);
+        for (QChar c : chars) {
+            if (!m_model.add(c.toLatin1())) continue;
+            TileLabel *t = takeLabel(c);
+            m_labels.append(t);
+            layout()->addWidget(t);
+            t->show();
         }
+        setUpdatesEnabled(true);
     }
-    return false;
-}
-
-void RackView::addTile(QChar ch) {
-    auto *t = new TileLabel(ch, this);
-    layout()->addWidget(t);
-    connect(t, &QObject::destroyed, this, &RackView::rackChanged);
     emit rackChanged();
 }
 
-void RackView::addTiles(const QVector<QChar>& chars) {
-    for (QChar c : chars) addTile(c);
+void RackView::setCounts(const int* counts) {
+    QList<QChar> extra;
+    QVector<QChar> missing;
+    for (int s = 0; s < GameRules::SymbolCount; ++s) {
+        QChar ch = QChar::fromLatin1(GameRules::symbolChar(s));
+        int have = m_model.count(ch.toLatin1());
+        for (int k = counts[s]; k < have; ++k) extra.append(ch);
+        for (int k = have; k < counts[s]; ++k) missing.append(ch);
+    }
+    removeTiles(extra);
+    addTiles(missing);
 }
 
 QList<QChar> RackView::nonEqualsTiles() const {
     QList<QChar> tiles;
-    for (auto* label : findChildren<TileLabel*>()) {
-        if (label->tileChar() != '=') {
-            tiles.append(label->tileChar());
-        }
+    for (char ch : m_model.order()) {
+        if (ch != '=') tiles.append(QChar::fromLatin1(ch));
     }
     return tiles;
 }
 
 void RackView::removeTiles(const QList<QChar>& charsToRemove) {
-    QList<TileLabel*> tiles = findChildren<TileLabel*>();
-    QList<QChar> toRemove = charsToRemove;
+    bool changed = false;
+    setUpdatesEnabled(false);
+    for (QChar c : charsToRemove) {
+        int i = m_model.lastIndexOf(c.toLatin1());
+        if (i < 0) continue;
+        m_model.removeAt(i);
+        recycle(m_labels.takeAt(i));
+        changed = true;
+    }
+    setUpdatesEnabled(true);
+    if (changed) emit rackChanged();
+}
 
-    for (auto* tile : tiles) {
-        if (toRemove.contains(tile->tileChar())) {
-            tile->close(); // This will trigger its deletion
-            toRemove.removeOne(tile->tileChar());
-        }
+TileLabel* RackView::takeLabel(QChar ch) {
+    if (m_pool.isEmpty()) {
+        auto *t = new TileLabel(ch, this);
+        connect(t, &TileLabel::draggedAway, this, &RackView::onTileDragged);
+        return t;
     }
+    TileLabel *t = m_pool.takeLast();
+    t->setTileChar(ch);
+    return t;
+}
+
+void RackView::recycle(TileLabel *tile) {
+    layout()->removeWidget(tile);
+    tile->hide();
+    m_pool.append(tile);
+}
+
+void RackView::onTileDragged(TileLabel *tile) {
+    int i = m_labels.indexOf(tile);
+    if (i < 0) return;
+    m_model.removeAt(i);
+    m_labels.removeAt(i);
+    recycle(tile);
+    emit rackChanged();
 }
@@ -5,25 +5,43 @@
 #include <QVector>
 #include <QChar>
 #include <QList>
+#include "RackModel.h"
 
 class TileLabel;
 
+// Shows a RackModel. m_labels runs parallel to the model's order; batched
+// changes rebuild the layout once and emit a single rackChanged. Labels that
+// leave the rack are hidden and pooled rather than deleted, so refills after
+// the first deal create no widgets.
 class RackView : public QWidget {
     Q_OBJECT
 public:
     explicit RackView(QWidget *parent=nullptr);
-    int countTiles() const;
-    int countNonEqualsTiles() const;
-    bool hasEqualsTile() const;
+    const RackModel& model() const { return m_model; }
+    int countTiles() const { return m_model.count(); }
+    int countNonEqualsTiles() const { return m_model.nonEqualsCount(); }
+    bool hasEqualsTile() const { return m_model.contains('='); }
 
     QList<QChar> nonEqualsTiles() const;
     void removeTiles(const QList<QChar>& charsToRemove);
 
     void addTile(QChar ch);
     void addTiles(const QVector<QChar>& chars);
+    // Add and remove tiles until the rack holds counts (indexed by
+    // GameRules::symbolIndex); tiles already shown keep their places.
+    void setCounts(const int* counts);
 
 signals:
     void rackChanged();
+
+private:
+    void onTileDragged(TileLabel *tile);   // dropped onto the board
+    TileLabel* takeLabel(QChar ch);
+    void recycle(TileLabel *tile);
+
+    RackModel m_model;
+    QVector<TileLabel*> m_labels;
+    QVector<TileLabel*> m_pool;
 };
 
 #endif // RACKVIEW_H
@@ -0,0 +1,101 @@
+#ifndef RULEVARIANTS_H
+#define RULEVARIANTS_H
+
+#include "GameRules.h"
+
+// House rules as compile-time policies. Each RuleSet instantiation is a
+// separate validator and scorer with its choices folded in, so the hot loops
+// never test which variant is being played; a game picks its RuleEngine once
+// when it is created. GameRules' own functions are the Standard variant.
+//
+// The tile set is unchanged: there are no '^' or parenthesis tiles, so those
+// syntax options only matter for equations entered as text.
+
+// What an expression on either side of '=' may contain.
+struct StandardSyntax {
+    static constexpr bool Parentheses = true;
+    static constexpr bool Exponent = false;     // '^', right-associative, binds tightest
+    static constexpr bool UnaryMinus = false;   // '-' before an operand negates it
+};
+struct ClubSyntax {
+    static constexpr bool Parentheses = true;
+    static constexpr bool Exponent = true;
+    static constexpr bool UnaryMinus = true;
+};
+struct PlainSyntax {
+    static constexpr bool Parentheses = false;
+    static constexpr bool Exponent = false;
+    static constexpr bool UnaryMinus = false;
+};
+
+// How many '=' a run may hold: one, or a chain like 2+2=4=1+3 whose parts
+// must all be equal.
+struct SingleEquals { static constexpr bool Chained = false; };
+struct ChainedEquals { static constexpr bool Chained = true; };
+
+// Points per tile before multipliers.
+struct StandardScoring {
+    static constexpr int tileScore(char ch) {
+        if (ch >= '1' && ch <= '9') return ch - '0';
+        if (ch == '0') return 1;
+        if (ch == '+' || ch == '-' || ch == '*' || ch == '/') return 2;
+        return 0;
+    }
+};
+// Operators by how hard they are to use: + - 1, * 3, / 4.
+struct WeightedScoring {
+    static constexpr int tileScore(char ch) {
+        if (ch >= '1' && ch <= '9') return ch - '0';
+        if (ch == '0') return 1;
+        if (ch == '+' || ch == '-') return 1;
+        if (ch == '*') return 3;
+        if (ch == '/') return 4;
+        return 0;
+    }
+};
+
+template <class Syntax, class Equality, class Scoring>
+struct RuleSet {
+    // Same contracts as the GameRules functions of the same name. For a
+    // chain, lhs is the first part and rhs the first part that differs.
+    static std::optional<long long> evalExpr(const char* s, int n);
+    static EquationError checkEquation(const char* s, int n, long long* lhs = nullptr, long long* rhs = nullptr);
+    static bool validate(const char* board, const TilePlacement* tiles, int n, RuleCheck& check);
+    static int scoreTurn(const char* board, const bool* multiplierUsed, const TilePlacement* tiles, int n);
+    static int tileScore(char ch) { return Scoring::tileScore(ch); }
+};
+
+using StandardRules = RuleSet<StandardSyntax, SingleEquals, StandardScoring>;
+using ClubRules = RuleSet<ClubSyntax, ChainedEquals, StandardScoring>;
+using PlainRules = RuleSet<PlainSyntax, SingleEquals, StandardScoring>;
+using WeightedRules = RuleSet<StandardSyntax, SingleEquals, WeightedScoring>;
+
+// Instantiated in GameRules.cpp for these only.
+extern template struct RuleSet<StandardSyntax, SingleEquals, StandardScoring>;
+extern template struct RuleSet<ClubSyntax, ChainedEquals, StandardScoring>;
+extern template struct RuleSet<PlainSyntax, SingleEquals, StandardScoring>;
+extern template struct RuleSet<StandardSyntax, SingleEquals, WeightedScoring>;
+
+enum class RuleVariant : uint8_t {
+    Standard,
+    Club,           // '^', unary minus, chained equalities
+    Plain,          // no parentheses
+    Weighted,       // operator tiles scored by difficulty
+    Count
+};
+
+// One variant's entry points, chosen once per game.
+struct RuleEngine {
+    RuleVariant variant;
+    const char* name;
+    std::optional<long long> (*evalExpr)(const char* s, int n);
+    EquationError (*checkEquation)(const char* s, int n, long long* lhs, long long* rhs);
+    bool (*validate)(const char* board, const TilePlacement* tiles, int n, RuleCheck& check);
+    int (*scoreTurn)(const char* board, const bool* multiplierUsed, const TilePlacement* tiles, int n);
+    int (*tileScore)(char ch);
+
+    static const RuleEngine& get(RuleVariant variant);  // Standard if out of range
+    static const RuleEngine* find(const char* name);    // nullptr if unknown
+};
+
+#endif // RULEVARIANTS_H
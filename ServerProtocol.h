@@ -0,0 +1,117 @@
+#ifndef SERVERPROTOCOL_H
+#define SERVERPROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Wire protocol of equatix-server.
+//
+// Every message is a frame:  u32 length  u8 type  payload[length - 1]
+// All integers are little-endian. A connection may take either seat of any
+// number of games; the server answers every request with exactly one reply
+// and additionally pushes OpponentMoved to the other seat after a move.
+
+enum class MsgType : uint8_t {
+    // requests
+    CreateGame = 1,     // u64 seed (0 = random), [u8 RuleVariant] -> Joined (seat 0)
+    JoinGame = 2,       // u32 game                         -> Joined (seat 1)
+    Place = 3,          // u32 game, u8 n, n x (u8 row, u8 col, u8 ch)  -> MoveResult
+    Swap = 4,           // u32 game, u8 n, n x u8 ch        -> MoveResult
+    GetState = 5,       // u32 game                         -> State
+    Spectate = 6,       // u32 game  -> Keyframe, Delta... then a Delta after every turn;
+                        // not for a connection seated at the game
+
+    // replies and notifications
+    Joined = 64,        // u32 game, u8 seat
+    MoveResult = 65,    // u32 game, u8 ok, u8 RuleError, i32 points, i32 score0, i32 score1, u8 currentPlayer
+    State = 66,         // u32 game, u8 currentPlayer, i32 score0, i32 score1, u16 bagCount,
+                        // u8 rack[SymbolCount] of the asking seat, u8 board[CellCount]
+    Error = 67,         // u8 ServerError
+    OpponentMoved = 68, // u32 game, i32 points, u8 currentPlayer
+    Keyframe = 69,      // spectator feed, see SpectatorFeed.h
+    Delta = 70
+};
+
+enum class ServerError : uint8_t {
+    BadRequest = 1,
+    UnknownGame = 2,
+    GameFull = 3,
+    NotSeated = 4,
+    NotYourTurn = 5,
+    SeatedSpectator = 6 // watching a game you sit at, or sitting at one you watch
+};
+
+constexpr uint32_t kMaxFrame = 1024;
+
+// Appends frames to a byte buffer.
+class WireWriter {
+public:
+    explicit WireWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+    void begin(MsgType type) {
+        m_start = m_out.size();
+        u32(0);
+        u8(uint8_t(type));
+    }
+    void end() {
+        uint32_t len = uint32_t(m_out.size() - m_start - 4);
+        std::memcpy(m_out.data() + m_start, &len, 4);
+    }
+    void u8(uint8_t v) { m_out.push_back(v); }
+    void u16(uint16_t v) { bytes(&v, 2); }
+    void u32(uint32_t v) { bytes(&v, 4); }
+    void u64(uint64_t v) { bytes(&v, 8); }
+    void varint(uint64_t v) {
+        for (; v >= 0x80; v >>= 7) m_out.push_back(uint8_t(v) | 0x80);
+        m_out.push_back(uint8_t(v));
+    }
+    void bytes(const void* p, size_t n) {
+        const uint8_t* b = static_cast<const uint8_t*>(p);
+        m_out.insert(m_out.end(), b, b + n);
+    }
+
+private:
+    std::vector<uint8_t>& m_out;
+    size_t m_start = 0;
+};
+
+// Reads a frame payload; any overrun clears ok().
+class WireReader {
+public:
+    WireReader(const uint8_t* p, size_t n) : m_p(p), m_end(p + n) {}
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_p == m_end; }
+    uint8_t u8() { uint8_t v = 0; bytes(&v, 1); return v; }
+    uint16_t u16() { uint16_t v = 0; bytes(&v, 2); return v; }
+    uint32_t u32() { uint32_t v = 0; bytes(&v, 4); return v; }
+    uint64_t u64() { uint64_t v = 0; bytes(&v, 8); return v; }
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = u8();
+            if (!m_ok) return 0;
+            v |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        m_ok = false;
+        return 0;
+    }
+    void bytes(void* out, size_t n) {
+        if (size_t(m_end - m_p) < n) {
+            m_ok = false;
+            return;
+        }
+        std::memcpy(out, m_p, n);
+        m_p += n;
+    }
+
+private:
+    const uint8_t* m_p;
+    const uint8_t* m_end;
+    bool m_ok = true;
+};
+
+#endif // SERVERPROTOCOL_H
@@ -0,0 +1,164 @@
+#include "SpectatorFeed.h"
+#include "GameState.h"
+#include <cstring>
+
+namespace {
+
+// Placed tiles (cell, symbol) and consumed squares left empty
+void writeCells(WireWriter& w, const char* cells, const bool* used, const char* before, const bool* usedBefore) {
+    uint8_t placed[2 * GameRules::CellCount];
+    uint8_t consumed[GameRules::CellCount];
+    int n = 0, m = 0;
+    for (int i = 0; i < GameRules::CellCount; ++i) {
+        if (cells[i] && cells[i] != before[i]) {
+            placed[2*n] = uint8_t(i);
+            placed[2*n + 1] = uint8_t(GameRules::symbolIndex(cells[i]));
+            ++n;
+        }
+        if (used[i] && !usedBefore[i] && !cells[i]) consumed[m++] = uint8_t(i);
+    }
+    w.u8(uint8_t(n));
+    w.bytes(placed, size_t(2 * n));
+    w.u8(uint8_t(m));
+    w.bytes(consumed, size_t(m));
+}
+
+bool readCells(WireReader& r, char* cells, bool* used) {
+    int n = r.u8();
+    for (int i = 0; i < n; ++i) {
+        int cell = r.u8();
+        char ch = GameRules::symbolChar(r.u8());
+        if (!r.ok() || cell >= GameRules::CellCount || !ch) return false;
+        cells[cell] = ch;
+        used[cell] = true;
+    }
+    int m = r.u8();
+    for (int i = 0; i < m; ++i) {
+        int cell = r.u8();
+        if (!r.ok() || cell >= GameRules::CellCount) return false;
+        used[cell] = true;
+    }
+    return r.ok();
+}
+
+} // namespace
+
+SpectatorView::SpectatorView(const GameState& game) : m_synced(true) {
+    std::memcpy(m_cells, game.board(), sizeof m_cells);
+    std::memcpy(m_used, game.multipliersUsed(), sizeof m_used);
+    for (int p = 0; p < 2; ++p) {
+        std::memcpy(m_racks[p], game.rack(p), sizeof m_racks[p]);
+        m_scores[p] = game.score(p);
+    }
+    m_currentPlayer = game.currentPlayer();
+    m_bag = game.bag().otherTilesCount();
+}
+
+bool SpectatorView::apply(MsgType type, const uint8_t* payload, size_t size) {
+    WireReader r(payload, size);
+    uint32_t game = r.u32();
+    uint32_t seq = uint32_t(r.varint());
+    int current = r.u8();
+    int bag = r.u8();
+    if (!r.ok()) return false;
+
+    if (type == MsgType::Keyframe) {
+        SpectatorView v;
+        v.m_game = game;
+        v.m_seq = seq;
+        v.m_synced = true;
+        v.m_currentPlayer = current;
+        v.m_bag = bag;
+        v.m_scores[0] = int(r.varint());
+        v.m_scores[1] = int(r.varint());
+        for (auto &rack : v.m_racks)
+            for (int &count : rack) count = r.u8();
+        if (!readCells(r, v.m_cells, v.m_used) || !r.atEnd()) return false;
+        *this = v;
+        return true;
+    }
+
+    if (type != MsgType::Delta || !m_synced || game != m_game || seq != m_seq + 1) return false;
+    SpectatorView v = *this;
+    v.m_seq = seq;
+    v.m_currentPlayer = current;
+    v.m_bag = bag;
+    if (!readCells(r, v.m_cells, v.m_used)) return false;
+    v.m_scores[0] += int(r.varint());
+    v.m_scores[1] += int(r.varint());
+    int k = r.u8();
+    for (int i = 0; i < k; ++i) {
+        int key = r.u8();
+        int change = int8_t(r.u8());
+        if (!r.ok() || (key >> 4) > 1 || (key & 15) >= GameRules::SymbolCount) return false;
+        v.m_racks[key >> 4][key & 15] += change;
+    }
+    if (!r.ok() || !r.atEnd()) return false;
+    *this = v;
+    return true;
+}
+
+SpectatorFeed::SpectatorFeed(uint32_t gameId, const GameState& game) : m_view(game) {
+    m_view.m_game = gameId;
+    m_history.push_back(keyframe());
+}
+
+SpectatorFeed::Buffer SpectatorFeed::keyframe() const {
+    const SpectatorView &v = m_view;
+    static const char kNoCells[GameRules::CellCount] = {};
+    static const bool kNoneUsed[GameRules::CellCount] = {};
+    auto frame = std::make_shared<std::vector<uint8_t>>();
+    frame->reserve(96);
+    WireWriter w(*frame);
+    w.begin(MsgType::Keyframe);
+    w.u32(v.m_game);
+    w.varint(v.m_seq);
+    w.u8(uint8_t(v.m_currentPlayer));
+    w.u8(uint8_t(v.m_bag));
+    w.varint(uint64_t(v.m_scores[0]));
+    w.varint(uint64_t(v.m_scores[1]));
+    for (const auto &rack : v.m_racks)
+        for (int count : rack) w.u8(uint8_t(count));
+    writeCells(w, v.m_cells, v.m_used, kNoCells, kNoneUsed);
+    w.end();
+    return frame;
+}
+
+SpectatorFeed::Buffer SpectatorFeed::record(const GameState& game) {
+    SpectatorView &v = m_view;
+    auto frame = std::make_shared<std::vector<uint8_t>>();
+    frame->reserve(64);
+    WireWriter w(*frame);
+    w.begin(MsgType::Delta);
+    w.u32(v.m_game);
+    w.varint(v.m_seq + 1);
+    w.u8(uint8_t(game.currentPlayer()));
+    w.u8(uint8_t(game.bag().otherTilesCount()));
+    writeCells(w, game.board(), game.multipliersUsed(), v.m_cells, v.m_used);
+    w.varint(uint64_t(game.score(0) - v.m_scores[0]));
+    w.varint(uint64_t(game.score(1) - v.m_scores[1]));
+
+    uint8_t changes[2 * 2 * GameRules::SymbolCount];
+    int k = 0;
+    for (int p = 0; p < 2; ++p) {
+        for (int s = 0; s < GameRules::SymbolCount; ++s) {
+            int change = game.rack(p)[s] - v.m_racks[p][s];
+            if (!change) continue;
+            changes[2*k] = uint8_t(p << 4 | s);
+            changes[2*k + 1] = uint8_t(int8_t(change));
+            ++k;
+        }
+    }
+    w.u8(uint8_t(k));
+    w.bytes(changes, size_t(2 * k));
+    w.end();
+
+    uint32_t id = v.m_game, seq = v.m_seq + 1;
+    v = SpectatorView(game);
+    v.m_game = id;
+    v.m_seq = seq;
+
+    if (seq % KeyframeInterval == 0) m_history.assign(1, keyframe());
+    else m_history.push_back(frame);
+    return frame;
+}
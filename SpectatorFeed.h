@@ -0,0 +1,83 @@
+#ifndef SPECTATORFEED_H
+#define SPECTATORFEED_H
+
+#include "GameRules.h"
+#include "ServerProtocol.h"
+#include <memory>
+#include <vector>
+
+class GameState;
+
+// What a spectator knows about a game: everything but the bag order.
+// Keyframe and Delta frames (ServerProtocol.h) are applied in sequence.
+//
+// Keyframe: u32 game, varint seq, u8 currentPlayer, u8 bagCount,
+//           varint score0, varint score1, u8 racks[2][SymbolCount],
+//           u8 n, n x (u8 cell, u8 symbol), u8 m, m x u8 cell
+// Delta:    u32 game, varint seq, u8 currentPlayer, u8 bagCount,
+//           u8 n, n x (u8 cell, u8 symbol), u8 m, m x u8 cell,
+//           varint points0, varint points1, u8 k, k x (u8 player<<4 | symbol, i8 change)
+//
+// The n cells are tiles placed since the previous state. A premium square is
+// consumed by the tile placed on it, so the m cells list only consumed
+// squares that stay empty, which the current rules never produce. Scores
+// only grow, so a delta carries the points added to each.
+class SpectatorView {
+public:
+    SpectatorView() = default;
+    explicit SpectatorView(const GameState& game);
+
+    // Apply one frame payload (after the type byte). Fails on a malformed
+    // frame or a delta that does not follow the current sequence number.
+    bool apply(MsgType type, const uint8_t* payload, size_t size);
+
+    uint32_t gameId() const { return m_game; }
+    uint32_t sequence() const { return m_seq; }
+    bool synced() const { return m_synced; }
+    const char* board() const { return m_cells; }
+    const bool* multipliersUsed() const { return m_used; }
+    const int* rack(int player) const { return m_racks[player]; }
+    int score(int player) const { return m_scores[player]; }
+    int currentPlayer() const { return m_currentPlayer; }
+    int bagCount() const { return m_bag; }
+
+private:
+    friend class SpectatorFeed;
+
+    uint32_t m_game = 0;
+    uint32_t m_seq = 0;
+    bool m_synced = false;
+    char m_cells[GameRules::CellCount] = {};
+    bool m_used[GameRules::CellCount] = {};
+    int m_racks[2][GameRules::SymbolCount] = {};
+    int m_scores[2] = {0, 0};
+    int m_currentPlayer = 0;
+    int m_bag = 0;
+};
+
+// Server side of the feed for one game. Each turn is encoded once into a
+// complete wire frame; the same buffer is queued on every subscriber, so a
+// broadcast costs one encode however many spectators are watching. Every
+// KeyframeInterval turns a fresh keyframe replaces the catch-up history.
+class SpectatorFeed {
+public:
+    using Buffer = std::shared_ptr<const std::vector<uint8_t>>;
+    static constexpr int KeyframeInterval = 16;
+
+    SpectatorFeed(uint32_t gameId, const GameState& game);
+
+    // Encode the turn that led to game; returns the Delta frame to broadcast.
+    Buffer record(const GameState& game);
+
+    // Frames a new spectator needs, in order: the latest keyframe and the
+    // deltas since.
+    const std::vector<Buffer>& catchUp() const { return m_history; }
+
+private:
+    Buffer keyframe() const;
+
+    SpectatorView m_view;     // the state spectators have been sent
+    std::vector<Buffer> m_history;
+};
+
+#endif // SPECTATORFEED_H
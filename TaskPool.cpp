@@ -0,0 +1,41 @@
+#include "TaskPool.h"
+#include <algorithm>
+
+TaskPool::TaskPool(unsigned threads) {
+    for (unsigned t = 0; t < std::max(1u, threads); ++t) m_workers.emplace_back(&TaskPool::workerLoop, this);
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& w : m_workers) w.join();
+}
+
+unsigned TaskPool::defaultThreads() {
+    return std::max(2u, std::thread::hardware_concurrency() / 2);
+}
+
+void TaskPool::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_wake.notify_one();
+}
+
+void TaskPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+            if (m_tasks.empty()) return;    // stopping, and nothing left to run
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads running posted tasks in FIFO order. The GUI
+// keeps one for every open game: autosave writes and hint searches go here
+// instead of each game starting threads of its own.
+class TaskPool {
+public:
+    explicit TaskPool(unsigned threads = defaultThreads());
+    ~TaskPool();    // runs the tasks still queued, then joins
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // Half the cores, at least two: the GUI thread keeps a core to itself.
+    static unsigned defaultThreads();
+
+    unsigned size() const { return unsigned(m_workers.size()); }
+    void post(std::function<void()> task);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<std::function<void()>> m_tasks;  // guarded by m_mutex
+    bool m_stop = false;                        // guarded by m_mutex
+};
+
+#endif // TASKPOOL_H
@@ -1,57 +1,67 @@
 #include "TileBag.h"
+#include "GameRules.h"
 #include <algorithm>
-#include <random>
+#include <cassert>
 #include <chrono>
+#include <utility>
 
-TileBag::TileBag() {
-    auto add = [&](QChar ch, int count){
+TileBag::TileBag(uint64_t seed) : m_seed(seed), m_rng(seed) {
+    auto add = [&](char ch, int count){
         if (ch == '=') {
-            for (int i=0; i<count; ++i) m_equalsTiles.append(ch);
+            for (int i=0; i<count; ++i) m_equalsTiles.push_back(ch);
         } else {
-            for (int i=0; i<count; ++i) m_otherTiles.append(ch);
+            for (int i=0; i<count; ++i) m_otherTiles.push_back(ch);
         }
     };
 
-    // Distribution: digits heavy, ops fewer, equals some
-    for (int d='0'; d<='9'; ++d) add(QChar(d), 6); // 60 digits
-    add('+', 10);
-    add('-', 10);
-    add('*', 8);
-    add('/', 8);
-    add('=', 12); // Equals tiles are now managed separately
+    // Distribution (see GameRules::tileCount): digits heavy, ops fewer, equals some.
+    // Equals tiles are managed separately.
+    for (int i=0; i<GameRules::SymbolCount; ++i) {
+        char ch = GameRules::symbolChar(i);
+        add(ch, GameRules::tileCount(ch));
+    }
+    assert(m_otherTiles.size() == OtherTileTotal && m_equalsTiles.size() == EqualsTileTotal);
 
     shuffleOthers();
 }
 
+uint64_t TileBag::randomSeed() {
+    return uint64_t(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+}
+
 void TileBag::shuffleOthers() {
-    unsigned seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-    std::mt19937 rng(seed);
-    std::shuffle(m_otherTiles.begin(), m_otherTiles.end(), rng);
+    // Fisher-Yates; std::shuffle's algorithm differs between implementations.
+    for (int i = int(m_otherTiles.size()) - 1; i > 0; --i) {
+        int j = int(m_rng() % uint64_t(i + 1));
+        std::swap(m_otherTiles[i], m_otherTiles[j]);
+    }
     m_otherIdx = 0; // Reset index after shuffle
+    ++m_shuffles;
 }
 
-QChar TileBag::drawEquals() {
-    if (m_equalsIdx >= m_equalsTiles.size()) return QChar();
+char TileBag::drawEquals() {
+    if (m_equalsIdx >= int(m_equalsTiles.size())) return '\0';
     return m_equalsTiles[m_equalsIdx++];
 }
 
-QChar TileBag::drawOther() {
-    if (otherTilesEmpty()) return QChar();
+char TileBag::drawOther() {
+    if (otherTilesEmpty()) return '\0';
     return m_otherTiles[m_otherIdx++];
 }
 
 bool TileBag::otherTilesEmpty() const {
-    return m_otherIdx >= m_otherTiles.size();
+    return m_otherIdx >= int(m_otherTiles.size());
 }
 
 int TileBag::otherTilesCount() const {
-    return m_otherTiles.size() - m_otherIdx;
+    return int(m_otherTiles.size()) - m_otherIdx;
 }
 
-void TileBag::returnTiles(const QList<QChar>& chars) {
+void TileBag::returnTiles(const char* chars, int n) {
     // This is a simple implementation: add tiles back to the end of the vector.
     // A more robust implementation might re-insert them at the current index.
-    for (QChar ch : chars) {
+    for (int i=0; i<n; ++i) {
+        char ch = chars[i];
         if (ch == '=') {
             // This case shouldn't happen with the swap logic, but is safe to have
             if (m_equalsIdx > 0) m_equalsIdx--;
@@ -65,3 +75,22 @@ void TileBag::returnTiles(const QList<QChar>& chars) {
     // Re-shuffle the bag to mix the returned tiles in
     shuffleOthers();
 }
+
+bool TileBag::restore(uint64_t seed, const char* others, int otherCursor, int equalsCursor, uint32_t shuffles) {
+    if (otherCursor < 0 || otherCursor > OtherTileTotal || equalsCursor < 0 || equalsCursor > EqualsTileTotal
+        || shuffles == 0 || shuffles > MaxShuffles)
+        return false;
+    for (int i = 0; i < OtherTileTotal; ++i) {
+        int sym = GameRules::symbolIndex(others[i]);
+        if (sym < 0 || sym == GameRules::EqualsSymbol) return false;
+    }
+
+    std::copy(others, others + OtherTileTotal, m_otherTiles.begin());
+    m_otherIdx = otherCursor;
+    m_equalsIdx = equalsCursor;
+    m_seed = seed;
+    m_rng.seed(seed);
+    m_rng.discard(uint64_t(shuffles) * uint64_t(OtherTileTotal - 1));
+    m_shuffles = shuffles;
+    return true;
+}
@@ -1,28 +1,59 @@
 #ifndef TILEBAG_H
 #define TILEBAG_H
 
-#include <QVector>
-#include <QChar>
-#include <QList>
+#include <cstdint>
+#include <random>
+#include <vector>
 
+// Qt-free so recorded games can be replayed without the GUI. The draw order
+// depends only on the seed: shuffling uses the raw mt19937_64 stream, which is
+// the same on every standard library.
 class TileBag {
 public:
-    TileBag();
+    // Pile sizes for the GameRules::tileCount distribution.
+    static constexpr int OtherTileTotal = 96;
+    static constexpr int EqualsTileTotal = 12;
+
+    // Most shuffles (one per swap, plus the first) a restored bag may have had.
+    static constexpr uint32_t MaxShuffles = 1u << 16;
+
+    explicit TileBag(uint64_t seed = randomSeed());
+    static uint64_t randomSeed();
+    uint64_t seed() const { return m_seed; }
+
     bool otherTilesEmpty() const;
     int otherTilesCount() const;
 
-    QChar drawEquals(); // Draws from the equals pile
-    QChar drawOther();  // Draws from the numbers/operators pile
+    char drawEquals(); // Draws from the equals pile, '\0' if empty
+    char drawOther();  // Draws from the numbers/operators pile, '\0' if empty
+
+    void returnTiles(const char* chars, int n); // For swapping
+
+    // Positions of the next draw in each pile, recorded with every move.
+    int equalsCursor() const { return m_equalsIdx; }
+    int otherCursor() const { return m_otherIdx; }
+
+    // The rest of the bag's state, for GameState snapshots: the order of the
+    // numbers/operators pile (OtherTileTotal chars) and how often it was shuffled.
+    const char* otherTiles() const { return m_otherTiles.data(); }
+    uint32_t shuffles() const { return m_shuffles; }
 
-    void returnTiles(const QList<QChar>& chars); // For swapping
+    // Put the bag back in a saved state, seed included. The generator is
+    // replayed past the saved shuffles, so this costs a few nanoseconds per
+    // tile per shuffle. Returns false, leaving the bag unchanged, on
+    // impossible values.
+    bool restore(uint64_t seed, const char* others, int otherCursor, int equalsCursor, uint32_t shuffles);
 
 private:
     void shuffleOthers();
 
-    QVector<QChar> m_equalsTiles;
-    QVector<QChar> m_otherTiles;
+    uint64_t m_seed;
+    std::mt19937_64 m_rng;
+    std::vector<char> m_equalsTiles;
+    std::vector<char> m_otherTiles;
     int m_equalsIdx = 0;
     int m_otherIdx = 0;
+    uint32_t m_shuffles = 0;
 };
 
 #endif // TILEBAG_H
@@ -11,14 +11,26 @@ TileLabel::TileLabel(QChar ch, QWidget *parent)
     setText(QString(ch));
     setAlignment(Qt::AlignCenter);
     setFixedSize(44,44);
-    setAttribute(Qt::WA_DeleteOnClose, true);
     styleMe();
 }
 
+void TileLabel::setTileChar(QChar ch) {
+    m_ch = ch;
+    setText(QString(ch));
+}
+
 void TileLabel::styleMe() {
     setFrameStyle(QFrame::Panel | QFrame::Raised);
     setLineWidth(2);
-    setStyleSheet("font-weight: bold; font-size: 18px; background: #fff8dc;");
+    // Font and palette rather than a style sheet: a rack is refilled every turn
+    QFont f = font();
+    f.setBold(true);
+    f.setPixelSize(18);
+    setFont(f);
+    QPalette p = palette();
+    p.setColor(QPalette::Window, QColor(0xff, 0xf8, 0xdc));
+    setPalette(p);
+    setAutoFillBackground(true);
 }
 
 void TileLabel::mousePressEvent(QMouseEvent *event) {
@@ -35,8 +47,8 @@ void TileLabel::mousePressEvent(QMouseEvent *event) {
     drag->setHotSpot(QPoint(width()/2, height()/2));
 
     if (drag->exec(Qt::MoveAction) == Qt::MoveAction) {
-        // remove from rack when successfully dropped
-        close(); // deletion via WA_DeleteOnClose
+        // the rack takes it off and keeps it for reuse
+        emit draggedAway(this);
     }
 }
 
@@ -9,6 +9,10 @@ class TileLabel : public QLabel {
 public:
     explicit TileLabel(QChar ch, QWidget *parent=nullptr);
     QChar tileChar() const { return m_ch; }
+    void setTileChar(QChar ch);   // reuse a pooled label for another tile
+
+signals:
+    void draggedAway(TileLabel *tile);   // dropped somewhere that accepted it
 
 protected:
     void mousePressEvent(QMouseEvent *event) override;
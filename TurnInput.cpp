@@ -0,0 +1,16 @@
+#include "TurnInput.h"
+#include "TurnTrace.h"
+#include <algorithm>
+#include <cstring>
+
+void TurnInput::capture(const char* board, const bool* multipliersUsed, const int* newCells, int n) {
+    TracePhase trace("capture");
+    const int N = GameRules::BoardSize;
+    std::memcpy(cells, board, sizeof cells);
+    std::memcpy(used, multipliersUsed, sizeof used);
+    for (int i = 0; i < n; ++i) tiles[i] = {newCells[i] / N, newCells[i] % N, cells[newCells[i]]};
+    std::sort(tiles, tiles + n, [](const TilePlacement& a, const TilePlacement& b) {
+        return a.row != b.row ? a.row < b.row : a.col < b.col;
+    });
+    count = n;
+}
@@ -0,0 +1,21 @@
+#ifndef TURNINPUT_H
+#define TURNINPUT_H
+
+#include "GameRules.h"
+
+// Scratch for one turn: the board, premium state and new tiles in the flat
+// form GameRules reads. Captured once per turn and reused, so validating and
+// scoring never allocate.
+struct TurnInput {
+    char cells[GameRules::CellCount];
+    bool used[GameRules::CellCount];
+    TilePlacement tiles[GameRules::CellCount];
+    int count = 0;
+
+    // Copy a board that already holds this turn's tiles, and take the tiles
+    // on newCells (row * BoardSize + col), sorted by square so errors and
+    // records do not depend on the order they were placed in.
+    void capture(const char* board, const bool* multipliersUsed, const int* newCells, int n);
+};
+
+#endif // TURNINPUT_H
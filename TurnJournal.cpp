@@ -0,0 +1,336 @@
+#include "TurnJournal.h"
+#include "TaskPool.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+int openForAppend(const char* path, uint64_t keepBytes) {
+#ifdef _WIN32
+    int fd = _open(path, _O_WRONLY | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+    if (fd < 0) return -1;
+    if (_chsize_s(fd, __int64(keepBytes)) != 0 || _lseeki64(fd, 0, SEEK_END) < 0) {
+        _close(fd);
+        return -1;
+    }
+#else
+    int fd = ::open(path, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+    if (ftruncate(fd, off_t(keepBytes)) != 0 || lseek(fd, 0, SEEK_END) < 0) {
+        ::close(fd);
+        return -1;
+    }
+#endif
+    return fd;
+}
+
+bool writeAll(int fd, const uint8_t* p, size_t n) {
+    while (n > 0) {
+#ifdef _WIN32
+        int w = _write(fd, p, unsigned(n));
+#else
+        ssize_t w = ::write(fd, p, n);
+#endif
+        if (w <= 0) return false;
+        p += w;
+        n -= size_t(w);
+    }
+    return true;
+}
+
+void syncFile(int fd) {
+#ifdef _WIN32
+    _commit(fd);
+#elif defined(__APPLE__)
+    fsync(fd);
+#else
+    fdatasync(fd);
+#endif
+}
+
+void closeFile(int fd) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+uint32_t fnv1a(const uint8_t* p, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+constexpr size_t kMaxFrame = 2 + 255 + 4;
+
+// Frame one event into out; returns its length
+size_t encode(uint8_t* out, JournalEvent type, const uint8_t* payload, int n) {
+    out[0] = uint8_t(type);
+    out[1] = uint8_t(n);
+    if (n) std::memcpy(out + 2, payload, size_t(n));
+    uint32_t h = fnv1a(out, size_t(n) + 2);
+    std::memcpy(out + 2 + n, &h, 4);
+    return 2 + size_t(n) + 4;
+}
+
+} // namespace
+
+TurnJournal::~TurnJournal() {
+    close();
+}
+
+bool TurnJournal::open(const char* path, uint64_t keepBytes) {
+    close();
+    m_fd = openForAppend(path, keepBytes);
+    if (m_fd < 0) return false;
+    m_stop = false;
+    if (!m_pool) m_writer = std::thread(&TurnJournal::writerLoop, this);
+    return true;
+}
+
+void TurnJournal::close() {
+    if (m_fd < 0) return;
+    if (m_pool) {
+        // Let a queued write finish, then write the rest here
+        std::vector<uint8_t> rest;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return !m_flushQueued; });
+            rest.swap(m_buffer);
+            m_syncPending = false;
+        }
+        if (!rest.empty()) writeAll(m_fd, rest.data(), rest.size());
+        syncFile(m_fd);
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            m_syncPending = true;
+        }
+        m_wake.notify_one();
+        m_writer.join();
+    }
+    closeFile(m_fd);
+    m_fd = -1;
+}
+
+void TurnJournal::append(JournalEvent type, const uint8_t* payload, int n, bool boundary) {
+    if (m_fd < 0) return;
+    uint8_t frame[kMaxFrame];
+    appendFrames(frame, encode(frame, type, payload, n), boundary);
+}
+
+void TurnJournal::appendFrames(const uint8_t* frames, size_t size, bool boundary) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffer.insert(m_buffer.end(), frames, frames + size);
+        m_syncPending |= boundary;
+        if (m_pool) {
+            if (m_flushQueued) return;  // the queued task picks this up too
+            m_flushQueued = true;
+        }
+    }
+    if (m_pool) m_pool->post([this] { flushTask(); });
+    else m_wake.notify_one();
+}
+
+void TurnJournal::flushTask() {
+    std::vector<uint8_t> batch;
+    for (;;) {
+        bool sync;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_buffer.empty() && !m_syncPending) {
+                m_flushQueued = false;
+                m_wake.notify_all();    // close() may be waiting
+                return;
+            }
+            batch.swap(m_buffer);
+            sync = m_syncPending;
+            m_syncPending = false;
+        }
+        if (!batch.empty()) writeAll(m_fd, batch.data(), batch.size());
+        batch.clear();
+        if (sync) syncFile(m_fd);
+    }
+}
+
+void TurnJournal::writerLoop() {
+    std::vector<uint8_t> batch;
+    for (;;) {
+        bool sync, stop;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stop || m_syncPending || !m_buffer.empty(); });
+            batch.swap(m_buffer);
+            sync = m_syncPending;
+            stop = m_stop;
+            m_syncPending = false;
+        }
+        if (!batch.empty()) writeAll(m_fd, batch.data(), batch.size());
+        batch.clear();
+        if (sync) syncFile(m_fd);
+        if (stop) return;
+    }
+}
+
+void TurnJournal::begin(uint64_t seed) {
+    uint8_t p[8];
+    std::memcpy(p, &seed, 8);
+    append(JournalEvent::Begin, p, 8, true);
+}
+
+void TurnJournal::restart(uint64_t seed, const RecordedMove* moves, int n) {
+    if (m_fd < 0) return;
+    std::vector<uint8_t> frames;
+    uint8_t frame[kMaxFrame];
+    auto add = [&](JournalEvent type, const uint8_t* payload, int size) {
+        frames.insert(frames.end(), frame, frame + encode(frame, type, payload, size));
+    };
+
+    uint32_t events = 0;
+    for (int i = 0; i < n; ++i) events += moves[i].kind == MoveKind::Swap ? 1 : uint32_t(moves[i].count) + 1;
+    uint8_t begin[12];
+    std::memcpy(begin, &seed, 8);
+    std::memcpy(begin + 8, &events, 4);
+    add(JournalEvent::Begin, begin, 12);
+    for (int i = 0; i < n; ++i) {
+        const RecordedMove& m = moves[i];
+        if (m.kind == MoveKind::Swap) {
+            add(JournalEvent::Swap, reinterpret_cast<const uint8_t*>(m.swapped), m.count);
+            continue;
+        }
+        for (int t = 0; t < m.count; ++t) {
+            uint8_t p[3] = {uint8_t(m.tiles[t].row), uint8_t(m.tiles[t].col), uint8_t(m.tiles[t].ch)};
+            add(JournalEvent::Place, p, 3);
+        }
+        uint32_t score = uint32_t(m.score);
+        uint8_t p[4];
+        std::memcpy(p, &score, 4);
+        add(JournalEvent::Validate, p, 4);
+    }
+    appendFrames(frames.data(), frames.size(), true);
+}
+
+void TurnJournal::place(int row, int col, char ch) {
+    uint8_t p[3] = {uint8_t(row), uint8_t(col), uint8_t(ch)};
+    append(JournalEvent::Place, p, 3, false);
+}
+
+void TurnJournal::undo() {
+    append(JournalEvent::Undo, nullptr, 0, false);
+}
+
+void TurnJournal::validate(int score) {
+    uint32_t s = uint32_t(score);
+    uint8_t p[4];
+    std::memcpy(p, &s, 4);
+    append(JournalEvent::Validate, p, 4, true);
+}
+
+void TurnJournal::swap(const char* tiles, int n) {
+    append(JournalEvent::Swap, reinterpret_cast<const uint8_t*>(tiles), n, true);
+}
+
+bool TurnJournal::recover(const char* path, JournalRecovery& out) {
+    out = JournalRecovery();
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    // While a restart's events are still being read, the game before it
+    JournalRecovery before;
+    uint32_t awaited = 0;
+
+    size_t pos = 0;
+    while (pos + 2 <= bytes.size()) {
+        const uint8_t* frame = bytes.data() + pos;
+        size_t n = frame[1];
+        if (pos + 2 + n + 4 > bytes.size()) break; // torn tail
+        uint32_t h;
+        std::memcpy(&h, frame + 2 + n, 4);
+        if (h != fnv1a(frame, n + 2)) break;
+        const uint8_t* p = frame + 2;
+
+        auto type = JournalEvent(frame[0]);
+        bool ok = true;
+        if (type == JournalEvent::Begin && (n == 8 || n == 12)) {
+            uint64_t seed;
+            std::memcpy(&seed, p, 8);
+            if (awaited == 0) before = std::move(out);
+            awaited = 0;
+            if (n == 12) std::memcpy(&awaited, p + 8, 4);
+            else before = JournalRecovery();
+            out.game = std::make_unique<GameState>(seed);
+            out.record = std::make_unique<GameRecordWriter>(seed);
+            out.pending.clear();
+            out.turns = 0;
+        } else if (!out.game) {
+            ok = false;
+        } else if (type == JournalEvent::Place && n == 3) {
+            out.pending.push_back({p[0], p[1], char(p[2])});
+        } else if (type == JournalEvent::Undo && n == 0) {
+            out.pending.clear();
+        } else if (type == JournalEvent::Validate && n == 4) {
+            uint32_t score;
+            std::memcpy(&score, p, 4);
+            RuleCheck check;
+            int points = 0;
+            ok = out.game->place(out.pending.data(), int(out.pending.size()), check, points)
+                 && uint32_t(points) == score;
+            if (ok) {
+                out.record->addPlacement(out.pending.data(), int(out.pending.size()), points, out.game->bag());
+                out.pending.clear();
+                ++out.turns;
+            }
+        } else if (type == JournalEvent::Swap && n <= size_t(GameRules::MaxRackTiles)) {
+            const char* tiles = reinterpret_cast<const char*>(p);
+            ok = out.pending.empty() && out.game->swap(tiles, int(n));
+            if (ok) {
+                out.record->addSwap(tiles, int(n), out.game->bag());
+                ++out.turns;
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) break;
+        if (awaited && type != JournalEvent::Begin) --awaited;
+        pos += 2 + n + 4;
+        out.validBytes = pos;
+    }
+    // A restart cut short falls back to the game before it, and the file is
+    // to be cut back to where that game ended
+    if (awaited) out = std::move(before);
+    if (!out.game) return false;
+
+    // Keep only pending tiles that are still on the mover's rack and on empty squares
+    int rack[GameRules::SymbolCount];
+    std::memcpy(rack, out.game->rack(out.game->currentPlayer()), sizeof rack);
+    bool taken[GameRules::CellCount] = {};
+    std::vector<TilePlacement> kept;
+    for (const TilePlacement& t : out.pending) {
+        int sym = GameRules::symbolIndex(t.ch);
+        int cell = t.row * GameRules::BoardSize + t.col;
+        if (sym < 0 || t.row >= GameRules::BoardSize || t.col >= GameRules::BoardSize
+            || out.game->board()[cell] || taken[cell] || rack[sym] == 0) continue;
+        --rack[sym];
+        taken[cell] = true;
+        kept.push_back(t);
+    }
+    out.pending.swap(kept);
+    return true;
+}
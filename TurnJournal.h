@@ -0,0 +1,88 @@
+#ifndef TURNJOURNAL_H
+#define TURNJOURNAL_H
+
+#include "GameRecord.h"
+#include "GameState.h"
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Append-only autosave journal of turn events.
+//
+// Each event is framed as  u8 type  u8 length  payload  u32 FNV-1a  so a torn
+// last write is detected and dropped on recovery. Callers only append to an
+// in-memory buffer; a background thread writes the buffer out as it fills and
+// fsyncs only after a turn boundary (validate or swap). A crash of the app
+// loses nothing that reached the buffer; a power loss loses at most the
+// placements of the turn in progress.
+//
+// Given a TaskPool, the writes run as pool tasks instead, at most one queued
+// per journal, so many open games share the pool's threads.
+
+enum class JournalEvent : uint8_t {
+    Begin = 1,      // u64 seed [u32 events]; a later Begin starts the game over,
+                    // once the events it counts have all followed
+    Place = 2,      // u8 row, u8 col, char symbol
+    Undo = 3,       // pending placements went back to the rack
+    Validate = 4,   // u32 score; pending placements become a move
+    Swap = 5        // swapped symbols
+};
+
+// State rebuilt from a journal.
+struct JournalRecovery {
+    std::unique_ptr<GameState> game;
+    std::unique_ptr<GameRecordWriter> record;
+    std::vector<TilePlacement> pending;  // placed this turn but not validated
+    int turns = 0;
+    uint64_t validBytes = 0;             // length of the intact prefix
+};
+
+class TaskPool;
+
+class TurnJournal {
+public:
+    explicit TurnJournal(TaskPool* pool = nullptr) : m_pool(pool) {}
+    ~TurnJournal();
+    TurnJournal(const TurnJournal&) = delete;
+    TurnJournal& operator=(const TurnJournal&) = delete;
+
+    // Start journaling to path. With keepBytes > 0 the file is cut to that
+    // length and appended to; otherwise it is truncated.
+    bool open(const char* path, uint64_t keepBytes = 0);
+    void close();   // flush, fsync and stop the writer thread
+
+    void begin(uint64_t seed);
+    // Journal a game afresh from its moves. A counted Begin and the moves
+    // are queued under one lock, so no write holds only part of them, and
+    // recovery ignores them unless all of them reached the file.
+    void restart(uint64_t seed, const RecordedMove* moves, int n);
+    void place(int row, int col, char ch);
+    void undo();
+    void validate(int score);
+    void swap(const char* tiles, int n);
+
+    // Re-apply the intact prefix of a journal. Returns false if there is no
+    // game to resume.
+    static bool recover(const char* path, JournalRecovery& out);
+
+private:
+    void append(JournalEvent type, const uint8_t* payload, int n, bool boundary);
+    void appendFrames(const uint8_t* frames, size_t size, bool boundary);
+    void writerLoop();
+    void flushTask();
+
+    TaskPool* m_pool;
+    int m_fd = -1;
+    std::thread m_writer;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<uint8_t> m_buffer;      // guarded by m_mutex
+    bool m_syncPending = false;         // guarded by m_mutex
+    bool m_stop = false;                // guarded by m_mutex
+    bool m_flushQueued = false;         // guarded by m_mutex; pool mode only
+};
+
+#endif // TURNJOURNAL_H
@@ -0,0 +1,146 @@
+#include "TurnTrace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+constexpr uint64_t kMask = TurnTrace::RingCapacity - 1;
+
+// Written only by the owning thread; readers copy and then discard what the
+// owner may have overwritten meanwhile, like a sequence lock.
+struct Event {
+    std::atomic<const char*> phase{nullptr};
+    std::atomic<uint64_t> start{0};
+    std::atomic<uint64_t> duration{0};
+};
+
+struct Ring {
+    int thread = 0;                     // 1-based, in order of first event
+    std::atomic<uint64_t> head{0};      // events ever written
+    std::atomic<uint64_t> base{0};      // events before this were cleared
+    Event events[TurnTrace::RingCapacity];
+};
+
+struct Copied {
+    const char* phase;
+    uint64_t start;
+    uint64_t duration;
+    int thread;
+};
+
+std::mutex g_registryMutex;
+std::vector<std::unique_ptr<Ring>> g_rings;     // kept for dumps after a thread exits
+thread_local Ring* t_ring = nullptr;
+
+Ring* attachRing() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_rings.push_back(std::make_unique<Ring>());
+    g_rings.back()->thread = int(g_rings.size());
+    t_ring = g_rings.back().get();
+    return t_ring;
+}
+
+std::vector<Copied> snapshot() {
+    std::vector<Copied> out;
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (const auto &ring : g_rings) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first = std::max(ring->base.load(std::memory_order_relaxed),
+                                  head > kMask ? head - kMask - 1 : 0);
+        size_t mark = out.size();
+        for (uint64_t i = first; i < head; ++i) {
+            const Event &e = ring->events[i & kMask];
+            out.push_back({e.phase.load(std::memory_order_relaxed), e.start.load(std::memory_order_relaxed),
+                           e.duration.load(std::memory_order_relaxed), ring->thread});
+        }
+        // Slots the owner reached during the copy, including one in progress
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = ring->head.load(std::memory_order_relaxed) + 1;
+        uint64_t valid = after > kMask + 1 ? after - kMask - 1 : 0;
+        if (valid > first) out.erase(out.begin() + long(mark), out.begin() + long(mark + std::min(valid, head) - first));
+    }
+    return out;
+}
+
+bool samePhase(const char* a, const char* b) {
+    return a == b || std::strcmp(a, b) == 0;
+}
+
+} // namespace
+
+uint64_t TurnTrace::now() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void TurnTrace::record(const char* phase, uint64_t startNs, uint64_t endNs) {
+    Ring *ring = t_ring ? t_ring : attachRing();
+    uint64_t h = ring->head.load(std::memory_order_relaxed);
+    Event &e = ring->events[h & kMask];
+    e.phase.store(phase, std::memory_order_relaxed);
+    e.start.store(startNs, std::memory_order_relaxed);
+    e.duration.store(endNs - startNs, std::memory_order_relaxed);
+    ring->head.store(h + 1, std::memory_order_release);
+}
+
+std::vector<TurnTrace::PhaseStats> TurnTrace::summary() {
+    std::vector<Copied> events = snapshot();
+    std::vector<std::pair<const char*, std::vector<uint64_t>>> byPhase;
+    for (const Copied &e : events) {
+        if (!e.phase) continue;
+        auto it = std::find_if(byPhase.begin(), byPhase.end(),
+                               [&](const auto& p) { return samePhase(p.first, e.phase); });
+        if (it == byPhase.end()) {
+            byPhase.push_back({e.phase, {}});
+            it = byPhase.end() - 1;
+        }
+        it->second.push_back(e.duration);
+    }
+
+    std::vector<PhaseStats> stats;
+    for (auto &p : byPhase) {
+        std::vector<uint64_t> &d = p.second;
+        std::sort(d.begin(), d.end());
+        auto at = [&](size_t pct) { return d[(d.size() - 1) * pct / 100]; };
+        stats.push_back({p.first, d.size(), at(50), at(99), d.back()});
+    }
+    return stats;
+}
+
+bool TurnTrace::writeChromeTrace(const char* path) {
+    std::vector<Copied> events = snapshot();
+    std::FILE *f = std::fopen(path, "w");
+    if (!f) return false;
+
+    std::fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    const char *sep = "\n";
+    int threads = 0;
+    for (const Copied &e : events) threads = std::max(threads, e.thread);
+    for (int t = 1; t <= threads; ++t) {
+        std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                     sep, t, t == 1 ? "main" : "worker");
+        sep = ",\n";
+    }
+    for (const Copied &e : events) {
+        if (!e.phase) continue;
+        std::fprintf(f, "%s{\"name\":\"", sep);
+        for (const char *p = e.phase; *p; ++p) {
+            if (*p == '"' || *p == '\\') std::fputc('\\', f);
+            std::fputc(*p, f);
+        }
+        std::fprintf(f, "\",\"cat\":\"turn\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                     e.thread, double(e.start) / 1e3, double(e.duration) / 1e3);
+        sep = ",\n";
+    }
+    std::fprintf(f, "\n]}\n");
+    return std::fclose(f) == 0;
+}
+
+void TurnTrace::clear() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (auto &ring : g_rings) ring->base.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
@@ -0,0 +1,57 @@
+#ifndef TURNTRACE_H
+#define TURNTRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Scoped timers for the phases of a turn. Each thread appends to its own
+// ring of the most recent events without locking; the rings can be dumped as
+// Chrome trace_event JSON (chrome://tracing, Perfetto) or summarised per
+// phase. While recording is off a TracePhase costs one relaxed load, and no
+// ring is allocated until the first event.
+//
+// Phase names must be string literals: events keep the pointer.
+class TurnTrace {
+public:
+    static constexpr int RingCapacity = 1 << 14;   // events kept per thread
+
+    static void setEnabled(bool on) { s_enabled.store(on, std::memory_order_relaxed); }
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    static uint64_t now();  // ns on the steady clock
+    static void record(const char* phase, uint64_t startNs, uint64_t endNs);
+
+    struct PhaseStats {
+        const char* phase;
+        uint64_t count;
+        uint64_t p50Ns;
+        uint64_t p99Ns;
+        uint64_t maxNs;
+    };
+    // Over the events still held in the rings, in order of first appearance.
+    static std::vector<PhaseStats> summary();
+
+    static bool writeChromeTrace(const char* path);
+    static void clear();
+
+private:
+    static inline std::atomic<bool> s_enabled{false};
+};
+
+class TracePhase {
+public:
+    explicit TracePhase(const char* phase)
+        : m_phase(TurnTrace::enabled() ? phase : nullptr), m_start(m_phase ? TurnTrace::now() : 0) {}
+    ~TracePhase() {
+        if (m_phase) TurnTrace::record(m_phase, m_start, TurnTrace::now());
+    }
+    TracePhase(const TracePhase&) = delete;
+    TracePhase& operator=(const TracePhase&) = delete;
+
+private:
+    const char* m_phase;
+    uint64_t m_start;
+};
+
+#endif // TURNTRACE_H
@@ -1,11 +1,45 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QTimer>
+
+namespace {
+
+// Logs the time from main() to the first frame the window painted.
+class FirstPaintReporter : public QObject {
+public:
+    FirstPaintReporter(const QElapsedTimer &clock, qint64 constructedMs)
+        : m_clock(clock), m_constructedMs(constructedMs) {}
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *e) override {
+        if (e->type() == QEvent::Paint && obj->isWidgetType()) {
+            qApp->removeEventFilter(this);
+            // Runs once the rest of the frame has been painted
+            QTimer::singleShot(0, this, [this] {
+                qInfo("startup: window built after %lld ms, first frame at %lld ms",
+                      m_constructedMs, m_clock.elapsed());
+            });
+        }
+        return false;
+    }
+
+private:
+    const QElapsedTimer &m_clock;
+    qint64 m_constructedMs;
+};
+
+} // namespace
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer clock;
+    clock.start();
     QApplication a(argc, argv);
     MainWindow w;
+    FirstPaintReporter reporter(clock, clock.elapsed());
+    a.installEventFilter(&reporter);
     w.show();
     return a.exec();
 }
@@ -1,317 +1,242 @@
 #include "mainwindow.h"
-#include "BoardView.h"
-#include "RackView.h"
-#include "TileBag.h"
-#include "EquationValidator.h"
-#include "SwapDialog.h"
+#include "GameTab.h"
+#include "TaskPool.h"
+#include "TurnTrace.h"
+#include "GameMetrics.h"
 
 #include <QVBoxLayout>
-#include <QHBoxLayout>
+#include <QTabWidget>
 #include <QToolBar>
 #include <QAction>
 #include <QMessageBox>
 #include <QStatusBar>
 #include <QLabel>
-#include <QTableWidgetItem>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileDialog>
+#include <QDir>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QFontDatabase>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
-    m_board(new BoardView(15, this)),
-    m_bag(new TileBag()),
-    m_currentPlayer(0)
+    m_pool(std::make_unique<TaskPool>()),
+    m_tabs(new QTabWidget(this))
 {
-    // create two racks (players)
-    m_racks[0] = new RackView(this);
-    m_racks[1] = new RackView(this);
-
     setWindowTitle("Equatix — Two Player");
     auto *central = new QWidget(this);
     auto *v = new QVBoxLayout(central);
 
     QLabel *title = new QLabel("Equatix", this);
     title->setAlignment(Qt::AlignCenter);
-    title->setStyleSheet("font-size: 22px; font-weight: bold;");
+    QFont titleFont = title->font();
+    titleFont.setPixelSize(22);
+    titleFont.setBold(true);
+    title->setFont(titleFont);
 
+    m_tabs->setTabsClosable(true);
+    m_tabs->setDocumentMode(true);
     v->addWidget(title);
-    v->addWidget(m_board, 1);
-
-    // Racks row: Player 1 | Player 2 + scores
-    auto *racksRow = new QHBoxLayout;
-    {
-        auto *p1Layout = new QVBoxLayout;
-        QLabel *p1label = new QLabel("Player 1 Rack:");
-        p1label->setAlignment(Qt::AlignCenter);
-        p1Layout->addWidget(p1label);
-        p1Layout->addWidget(m_racks[0]);
-        racksRow->addLayout(p1Layout);
+    v->addWidget(m_tabs, 1);
 
-        auto *spacer = new QWidget;
-        spacer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-        racksRow->addWidget(spacer);
-
-        auto *p2Layout = new QVBoxLayout;
-        QLabel *p2label = new QLabel("Player 2 Rack:");
-        p2label->setAlignment(Qt::AlignCenter);
-        p2Layout->addWidget(p2label);
-        p2Layout->addWidget(m_racks[1]);
-        racksRow->addLayout(p2Layout);
-    }
-    v->addLayout(racksRow);
-
-    // Score bar (below racks)
-    auto *scoreRow = new QHBoxLayout;
-    m_scoreLabels[0] = new QLabel("Player 1: 0");
-    m_scoreLabels[1] = new QLabel("Player 2: 0");
-    scoreRow->addWidget(m_scoreLabels[0]);
-    scoreRow->addStretch();
-    scoreRow->addWidget(m_scoreLabels[1]);
-    v->addLayout(scoreRow);
-
-    // Toolbar actions
+    // Toolbar actions, for the table in front
     auto *toolbar = addToolBar("Actions");
     QAction *validate = new QAction("Validate Turn", this);
     QAction *undo = new QAction("Undo", this);
+    QAction *redo = new QAction("Redo", this);
     QAction *swap = new QAction("Swap Tiles", this);
+    QAction *hint = new QAction("Hint", this);
+    QAction *save = new QAction("Save Record...", this);
+    QAction *newGame = new QAction("New Table", this);
+    QAction *timings = new QAction("Timings", this);
+    QAction *exportTrace = new QAction("Export Trace...", this);
+    timings->setCheckable(true);
+    undo->setShortcut(QKeySequence::Undo);
+    redo->setShortcut(QKeySequence::Redo);
+    newGame->setShortcut(QKeySequence::AddTab);
     toolbar->addAction(validate);
     toolbar->addAction(undo);
+    toolbar->addAction(redo);
     toolbar->addAction(swap);
-
-    connect(validate, &QAction::triggered, this, &MainWindow::onValidate);
-    connect(undo, &QAction::triggered, this, &MainWindow::onUndo);
-    connect(swap, &QAction::triggered, this, &MainWindow::onSwap);
+    toolbar->addAction(hint);
+    toolbar->addAction(save);
+    toolbar->addSeparator();
+    toolbar->addAction(newGame);
+    toolbar->addSeparator();
+    toolbar->addAction(timings);
+    toolbar->addAction(exportTrace);
+
+    auto forward = [this](QAction *action, void (GameTab::*slot)()) {
+        connect(action, &QAction::triggered, this, [this, slot] {
+            if (GameTab *game = currentGame()) (game->*slot)();
+        });
+    };
+    forward(validate, &GameTab::validateTurn);
+    forward(undo, &GameTab::undo);
+    forward(redo, &GameTab::redo);
+    forward(swap, &GameTab::swapTiles);
+    forward(hint, &GameTab::hint);
+    forward(save, &GameTab::saveRecord);
+    connect(newGame, &QAction::triggered, this, &MainWindow::onNewGame);
+    connect(m_tabs, &QTabWidget::tabCloseRequested, this, &MainWindow::onCloseGame);
+    connect(timings, &QAction::toggled, this, &MainWindow::onToggleTimings);
+    connect(exportTrace, &QAction::triggered, this, &MainWindow::onExportTrace);
+
+    m_traceOverlay = new QLabel(m_tabs);
+    m_traceOverlay->setAttribute(Qt::WA_TransparentForMouseEvents);
+    m_traceOverlay->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    QPalette overlay = m_traceOverlay->palette();
+    overlay.setColor(QPalette::Window, QColor(0, 0, 0, 170));
+    overlay.setColor(QPalette::WindowText, Qt::white);
+    m_traceOverlay->setPalette(overlay);
+    m_traceOverlay->setAutoFillBackground(true);
+    m_traceOverlay->setMargin(6);
+    m_traceOverlay->hide();
+    m_traceTimer = new QTimer(this);
+    m_traceTimer->setInterval(500);
+    connect(m_traceTimer, &QTimer::timeout, this, &MainWindow::updateTraceOverlay);
 
     setCentralWidget(central);
     statusBar()->showMessage("Player 1's turn. Drag tiles from your rack to the board to form valid equations.");
 
-    // initial fill for both racks
-    refillRack(0);
-    refillRack(1);
-
-    // ensure only the active player's rack is enabled
-    enableRacksForCurrentPlayer();
-}
-
-void MainWindow::enableRacksForCurrentPlayer() {
-    m_racks[0]->setEnabled(m_currentPlayer == 0);
-    m_racks[1]->setEnabled(m_currentPlayer == 1);
-}
-
-void MainWindow::refillRack(int player) {
-    if (player < 0 || player > 1) return;
-    RackView *rack = m_racks[player];
-
-    // Ensure each rack has exactly one '=' tile (if we want that invariant)
-    if (!rack->hasEqualsTile()) {
-        QChar eq = m_bag->drawEquals();
-        if (!eq.isNull()) {
-            rack->addTile(eq);
-        }
-    }
-
-    // Fill other tiles up to 7 non-equals tiles
-    while (rack->countNonEqualsTiles() < 7) {
-        QChar ch = m_bag->drawOther();
-        if (ch.isNull()) break;
-        rack->addTile(ch);
+    loadOpeningBook();
+
+    // Resume every table an earlier run left behind, or deal one new game
+    m_dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(m_dataDir);
+    QList<int> tables;
+    for (const QString &name : QDir(m_dataDir).entryList({"autosave*.eqxj"}, QDir::Files))
+        if (int table = tableOf(name)) tables.append(table);
+    std::sort(tables.begin(), tables.end());
+    if (tables.isEmpty()) tables.append(1);
+    for (int table : tables) addGame(table);
+    m_tabs->setCurrentIndex(0);
+
+    connect(m_tabs, &QTabWidget::currentChanged, this, [this] {
+        if (GameTab *game = currentGame())
+            statusBar()->showMessage(QString("%1: Player %2's turn").arg(m_tabs->tabText(m_tabs->currentIndex()))
+                                     .arg(game->game().currentPlayer() + 1), 2000);
+    });
+
+    // EQUATIX_TRACE=1 records from startup without showing the overlay
+    if (qEnvironmentVariableIntValue("EQUATIX_TRACE")) TurnTrace::setEnabled(true);
+
+    // Kiosks hand their counters to node_exporter's textfile collector
+    QByteArray metricsPath = qgetenv("EQUATIX_METRICS_FILE");
+    if (!metricsPath.isEmpty()) {
+        auto *metricsTimer = new QTimer(this);
+        connect(metricsTimer, &QTimer::timeout, this, [metricsPath] {
+            GameMetrics::writeTextfile(metricsPath.constData());
+        });
+        metricsTimer->start(15000);
     }
 }
 
-QVector<QVector<QChar>> MainWindow::boardSnapshot() const {
-    int R = m_board->rowCount(), C = m_board->columnCount();
-    QVector<QVector<QChar>> snap(R, QVector<QChar>(C));
-    for (int r = 0; r < R; ++r) {
-        for (int c = 0; c < C; ++c) {
-            QTableWidgetItem *it = m_board->item(r, c);
-            if (it && !it->text().isEmpty()) snap[r][c] = it->text().at(0);
-            else snap[r][c] = QChar();
-        }
-    }
-    return snap;
+MainWindow::~MainWindow() {
+    // Tabs flush their journals through the pool, so they go first
+    while (m_tabs->count()) delete m_tabs->widget(0);
 }
 
-void MainWindow::endTurn() {
-    // toggle player
-    m_currentPlayer = 1 - m_currentPlayer;
-    enableRacksForCurrentPlayer();
-    statusBar()->showMessage(QString("Player %1's turn").arg(m_currentPlayer + 1), 2000);
+GameTab* MainWindow::currentGame() const {
+    return qobject_cast<GameTab*>(m_tabs->currentWidget());
 }
 
-static int leftmost(const QVector<QVector<QChar>>& b, int r, int c) {
-    while (c-1 >= 0 && !b[r][c-1].isNull()) --c;
-    return c;
-}
-static int topmost(const QVector<QVector<QChar>>& b, int r, int c) {
-    while (r-1 >= 0 && !b[r-1][c].isNull()) --r;
-    return r;
+QString MainWindow::autosavePath(int table) const {
+    // Table 1 keeps the name a single-game build used
+    if (table == 1) return m_dataDir + "/autosave.eqxj";
+    return m_dataDir + QString("/autosave-%1.eqxj").arg(table);
 }
 
-// Tile base scoring rules:
-// digits '1'-'9' => numeric value
-// '0' => 1 point
-// operators '+-*/' => 2 points
-// '=' => 0 points
-static int baseTileScore(QChar ch) {
-    if (ch.isDigit()) {
-        if (ch == '0') return 1;
-        return ch.digitValue();
-    }
-    if (QString("+-*/").contains(ch)) return 2;
-    return 0; // '=' or blank
+int MainWindow::tableOf(const QString &fileName) {
+    if (fileName == "autosave.eqxj") return 1;
+    if (!fileName.startsWith("autosave-") || !fileName.endsWith(".eqxj")) return 0;
+    bool ok = false;
+    int table = fileName.mid(9, fileName.size() - 9 - 5).toInt(&ok);
+    return ok && table > 1 ? table : 0;
 }
 
-int MainWindow::computeScoreForTurn(const QVector<QVector<QChar>>& snap, const QSet<QPair<int,int>>& newTiles) {
-    // Calculate score for all distinct equations (horizontal and vertical) that are formed/affected by new tiles.
-    // Multipliers are applied only if multiplier not previously used (we check m_board->multiplierUsedAt).
-    int rows = snap.size();
-    int cols = snap[0].size();
-
-    QSet<QString> countedRuns;
-    int total = 0;
-
-    for (auto rc : newTiles) {
-        int r = rc.first, c = rc.second;
-
-        // Horizontal run
-        int startC = leftmost(snap, r, c);
-        int j = startC;
-        QString runH;
-        while (j < cols && !snap[r][j].isNull()) { runH.append(snap[r][j]); ++j; }
-        if (runH.size() >= 2 && runH.contains('=')) {
-            QString key = QString("H%1:%2").arg(r).arg(runH);
-            if (!countedRuns.contains(key)) {
-                countedRuns.insert(key);
-
-                // compute score for this run
-                long long runScore = 0;
-                long long equationMultiplier = 1;
-                for (int cc = startC; cc < j; ++cc) {
-                    QChar ch = snap[r][cc];
-                    int tileScore = baseTileScore(ch);
-                    // piece multiplier applies only if multiplier there and not used yet
-                    MultiplierType mt = m_board->multiplierAt(r, cc);
-                    bool used = m_board->multiplierUsedAt(r, cc);
-                    if (!used) {
-                        if (mt == DoublePiece) tileScore *= 2;
-                        else if (mt == TriplePiece) tileScore *= 3;
-                        else if (mt == DoubleEquation) equationMultiplier *= 2;
-                        else if (mt == TripleEquation) equationMultiplier *= 3;
-                    }
-                    runScore += tileScore;
-                }
-                runScore *= equationMultiplier;
-                total += int(runScore);
-            }
-        }
-
-        // Vertical run
-        int startR = topmost(snap, r, c);
-        int i = startR;
-        QString runV;
-        while (i < rows && !snap[i][c].isNull()) { runV.append(snap[i][c]); ++i; }
-        if (runV.size() >= 2 && runV.contains('=')) {
-            QString key = QString("V%1:%2").arg(c).arg(runV);
-            if (!countedRuns.contains(key)) {
-                countedRuns.insert(key);
+GameTab* MainWindow::addGame(int table) {
+    auto *game = new GameTab(m_pool.get(), &m_book, QFile::encodeName(autosavePath(table)), m_tabs);
+    game->setProperty("table", table);
+    connect(game, &GameTab::statusMessage, this, [this, game](const QString &text, int timeoutMs) {
+        if (game == currentGame()) statusBar()->showMessage(text, timeoutMs);
+    });
+
+    // Keep the tabs in table order
+    int index = 0;
+    while (index < m_tabs->count() && m_tabs->widget(index)->property("table").toInt() < table) ++index;
+    m_tabs->insertTab(index, game, QString("Table %1").arg(table));
+    return game;
+}
 
-                long long runScore = 0;
-                long long equationMultiplier = 1;
-                for (int rr = startR; rr < i; ++rr) {
-                    QChar ch = snap[rr][c];
-                    int tileScore = baseTileScore(ch);
-                    MultiplierType mt = m_board->multiplierAt(rr, c);
-                    bool used = m_board->multiplierUsedAt(rr, c);
-                    if (!used) {
-                        if (mt == DoublePiece) tileScore *= 2;
-                        else if (mt == TriplePiece) tileScore *= 3;
-                        else if (mt == DoubleEquation) equationMultiplier *= 2;
-                        else if (mt == TripleEquation) equationMultiplier *= 3;
-                    }
-                    runScore += tileScore;
-                }
-                runScore *= equationMultiplier;
-                total += int(runScore);
-            }
+void MainWindow::onNewGame() {
+    // The lowest table number not in use
+    int table = 1;
+    for (int i = 0; i < m_tabs->count(); ++i)
+        if (m_tabs->widget(i)->property("table").toInt() == table) {
+            ++table;
+            i = -1;
         }
-    }
-
-    return total;
+    m_tabs->setCurrentWidget(addGame(table));
+    statusBar()->showMessage(QString("Table %1: Player 1's turn.").arg(table), 2000);
 }
 
-void MainWindow::onValidate() {
-    // ensure the active player actually placed tiles
-    if (m_board->newTiles().isEmpty()) {
-        QMessageBox::information(this, "Empty Turn", "You haven't placed any tiles.");
+void MainWindow::onCloseGame(int index) {
+    auto *game = qobject_cast<GameTab*>(m_tabs->widget(index));
+    if (!game) return;
+    QString name = m_tabs->tabText(index);
+    if (QMessageBox::question(this, "Close Table", QString("Abandon the game at %1? Its autosave is deleted.").arg(name))
+        != QMessageBox::Yes)
         return;
-    }
+    game->discard();
+    m_tabs->removeTab(index);
+    game->deleteLater();    // the tab bar is still emitting
+    if (m_tabs->count() == 0) onNewGame();
+}
 
-    auto snap = boardSnapshot();
-    QString why;
-    if (!EquationValidator::validate(snap, m_board->newTiles(), why)) {
-        QMessageBox::warning(this, "Invalid Turn", why);
-        return;
+void MainWindow::onToggleTimings(bool on) {
+    TurnTrace::setEnabled(on || qEnvironmentVariableIntValue("EQUATIX_TRACE"));
+    m_traceOverlay->setVisible(on);
+    if (on) {
+        updateTraceOverlay();
+        m_traceTimer->start();
+    } else {
+        m_traceTimer->stop();
     }
-
-    // compute score for this turn (before consuming multipliers)
-    int points = computeScoreForTurn(snap, m_board->newTiles());
-    m_scores[m_currentPlayer] += points;
-    m_scoreLabels[m_currentPlayer]->setText(QString("Player %1: %2").arg(m_currentPlayer + 1).arg(m_scores[m_currentPlayer]));
-
-    // lock tiles and consume multipliers for newly covered squares
-    m_board->lockNewTiles();
-
-    // refill only the current player's rack
-    refillRack(m_currentPlayer);
-
-    // end turn: switch to other player
-    endTurn();
-
-    statusBar()->showMessage(QString("Player %1 scored %2 points.").arg(m_currentPlayer == 0 ? 2 : 1).arg(points), 3000);
 }
 
-void MainWindow::onUndo() {
-    // only the current player may undo their new placements during their turn
-    QList<QChar> returned;
-    m_board->rollbackNewTiles(returned);
-    // give tiles back to current player's rack
-    for (QChar c : returned) {
-        m_racks[m_currentPlayer]->addTile(c);
+void MainWindow::updateTraceOverlay() {
+    if (!m_traceOverlay->isVisible()) return;
+    auto us = [](uint64_t ns) { return QString::number(double(ns) / 1000.0, 'f', 1); };
+    QString text = QString("%1 %2 %3 %4").arg("phase", -20).arg("n", 6).arg("p50 us", 9).arg("p99 us", 9);
+    for (const TurnTrace::PhaseStats &s : TurnTrace::summary()) {
+        text += QString("\n%1 %2 %3 %4").arg(QString::fromLatin1(s.phase), -20).arg(s.count, 6)
+                    .arg(us(s.p50Ns), 9).arg(us(s.p99Ns), 9);
     }
-    statusBar()->showMessage("Undid placements", 1500);
+    m_traceOverlay->setText(text);
+    m_traceOverlay->adjustSize();
+    m_traceOverlay->move(8, 40);
+    m_traceOverlay->raise();
 }
 
-void MainWindow::onSwap() {
-    // Swap operates on current player's rack
-    RackView *rack = m_racks[m_currentPlayer];
-
-    SwapDialog dlg(rack->nonEqualsTiles(), this);
-    if (dlg.exec() == QDialog::Accepted) {
-        QList<QChar> tilesToSwap = dlg.getSelectedTiles();
-        if (tilesToSwap.isEmpty()) {
-            return; // nothing selected
-        }
-
-        int swapCount = tilesToSwap.count();
-
-        // Ensure bag has enough tiles
-        if (m_bag->otherTilesCount() < swapCount) {
-            QMessageBox::warning(this, "Cannot Swap", "There are not enough tiles left in the bag to perform this swap.");
-            return;
-        }
-
-        // Remove selected tiles from player's rack
-        rack->removeTiles(tilesToSwap);
-
-        // Return them to bag
-        m_bag->returnTiles(tilesToSwap);
-
-        // Draw replacements and add them to player's rack
-        for (int i = 0; i < swapCount; ++i) {
-            QChar newTile = m_bag->drawOther();
-            if (!newTile.isNull()) rack->addTile(newTile);
-        }
+void MainWindow::onExportTrace() {
+    QString path = QFileDialog::getSaveFileName(this, "Export Trace", QString(), "Chrome traces (*.json)");
+    if (path.isEmpty()) return;
+    if (!TurnTrace::writeChromeTrace(QFile::encodeName(path).constData())) {
+        QMessageBox::warning(this, "Export Failed", QString("Could not write %1").arg(path));
+        return;
+    }
+    statusBar()->showMessage(QString("Wrote trace to %1; open it in chrome://tracing or Perfetto.").arg(path), 3000);
+}
 
-        // end player's turn after swapping
-        endTurn();
-        statusBar()->showMessage(QString("Player %1 swapped %2 tile(s).").arg(m_currentPlayer == 0 ? 2 : 1).arg(swapCount), 2000);
+void MainWindow::loadOpeningBook() {
+    // Built offline by equatix-openings; hints fall back to a search without it.
+    m_bookFile = new QFile(QCoreApplication::applicationDirPath() + "/openings.bin", this);
+    if (!m_bookFile->open(QIODevice::ReadOnly)) return;
+    uchar *data = m_bookFile->map(0, m_bookFile->size());
+    if (!data || !m_book.attach(data, size_t(m_bookFile->size()))) {
+        qWarning("openings.bin is not a valid opening book");
     }
 }
@@ -2,45 +2,57 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QVector>
-#include <QChar>
+#include <QString>
+#include <memory>
+#include "OpeningBook.h"
 
-class BoardView;
-class RackView;
-class TileBag;
+class GameTab;
+class TaskPool;
 class QLabel;
+class QFile;
+class QTabWidget;
+class QTimer;
 
+// Hosts any number of tables, one GameTab each, so a club kiosk runs them all
+// in one process. The tabs share one TaskPool and one mapped opening book;
+// the toolbar acts on the table in front.
 class MainWindow : public QMainWindow {
     Q_OBJECT
 public:
     explicit MainWindow(QWidget *parent = nullptr);
-    ~MainWindow() override = default;
+    ~MainWindow() override;
 
 private slots:
-    void onValidate();
-    void onUndo();
-    void onSwap();
+    void onNewGame();
+    void onCloseGame(int index);
+    void onToggleTimings(bool on);
+    void onExportTrace();
 
 private:
-    // UI / game widgets
-    BoardView *m_board;
-    RackView *m_racks[2]; // two racks, index 0 = Player 1, index 1 = Player 2
-    TileBag *m_bag;
+    // autosave writes and hint searches of every table; the tabs are deleted
+    // in ~MainWindow, before it
+    std::unique_ptr<TaskPool> m_pool;
 
-    // game state
-    int m_currentPlayer; // 0 or 1
+    QTabWidget *m_tabs;
 
-    // scoring
-    int m_scores[2] = {0, 0};
-    QLabel *m_scoreLabels[2] = {nullptr, nullptr};
+    // autosaves live here, one file per table
+    QString m_dataDir;
 
-    // helpers
-    void refillRack(int player);                 // refill specific player's rack
-    QVector<QVector<QChar>> boardSnapshot() const;
-    void endTurn();                              // toggle players, enable appropriate rack, update status
-    void enableRacksForCurrentPlayer();          // enable/disable racks according to current player
+    // precomputed first moves, mapped from openings.bin next to the executable
+    QFile *m_bookFile = nullptr;
+    OpeningBook m_book;
+
+    // per-phase p50/p99 drawn over the tables while timings are on
+    QLabel *m_traceOverlay = nullptr;
+    QTimer *m_traceTimer = nullptr;
 
-    int computeScoreForTurn(const QVector<QVector<QChar>>& snap, const QSet<QPair<int,int>>& newTiles);
+    // helpers
+    GameTab* currentGame() const;
+    GameTab* addGame(int table);                 // resumes the table's autosave if there is one
+    QString autosavePath(int table) const;
+    static int tableOf(const QString &fileName); // 0 if not an autosave
+    void loadOpeningBook();
+    void updateTraceOverlay();
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,122 @@
+// Damaged archives GameArchive and GameArchiveWriter must refuse.
+//
+// Usage: archive_checks
+//
+// Writes a two-segment archive of self-played games to /tmp, then copies of
+// it with the last segment's index damaged. Each check prints one line and
+// the run fails if any does not hold.
+
+#include "GameArchive.h"
+#include "GameRecord.h"
+#include "GameState.h"
+#include "MoveGenerator.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+void expect(bool ok, const char* what) {
+    std::printf("%s: %s\n", ok ? "ok" : "FAILED", what);
+    if (!ok) ++g_failures;
+}
+
+std::vector<uint8_t> selfPlay(uint64_t seed) {
+    GameState game(seed);
+    GameRecordWriter record(seed);
+    Move m;
+    for (int ply = 0; ply < 10 && MoveGenerator(game).best(m); ++ply) {
+        RuleCheck check;
+        int points;
+        if (!game.place(m.tiles, m.count, check, points)) break;
+        record.addPlacement(m.tiles, m.count, points, game.bag());
+    }
+    return record.bytes();
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::vector<uint8_t> bytes;
+    if (std::FILE* f = std::fopen(path.c_str(), "rb")) {
+        uint8_t buf[4096];
+        for (size_t n; (n = std::fread(buf, 1, sizeof buf, f)) > 0;) bytes.insert(bytes.end(), buf, buf + n);
+        std::fclose(f);
+    }
+    return bytes;
+}
+
+void writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+    if (std::FILE* f = std::fopen(path.c_str(), "wb")) {
+        std::fwrite(bytes.data(), 1, bytes.size(), f);
+        std::fclose(f);
+    }
+}
+
+// Write a copy with the u64 at `at` replaced
+void writeDamaged(const std::string& path, const std::vector<uint8_t>& good, uint64_t at, uint64_t value) {
+    std::vector<uint8_t> bad = good;
+    std::memcpy(bad.data() + at, &value, 8);
+    writeFile(path, bad);
+}
+
+bool opensWith(const std::string& path, const std::vector<uint8_t>& good, uint64_t at, uint64_t value) {
+    writeDamaged(path, good, at, value);
+    GameArchive archive;
+    return archive.open(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    std::string path = "/tmp/equatix-archive-checks-" + std::to_string(getpid());
+    std::string damaged = path + ".bad";
+    std::vector<std::vector<uint8_t>> records;
+    for (uint64_t seed = 1; seed <= 6; ++seed) records.push_back(selfPlay(seed));
+
+    {
+        GameArchiveWriter writer;
+        expect(writer.open(path.c_str()), "an archive is created");
+        for (int i = 0; i < 3; ++i) writer.add(records[i].data(), records[i].size());
+        expect(writer.commit(), "the first segment commits");
+        for (int i = 3; i < 6; ++i) writer.add(records[i].data(), records[i].size());
+        expect(writer.commit() && writer.commit(), "the second segment commits, and again with nothing pending");
+    }
+
+    GameArchive archive;
+    expect(archive.open(path.c_str()) && archive.gameCount() == 6, "the archive opens with every game");
+    bool same = true;
+    for (uint32_t id = 0; id < 6; ++id) {
+        ArchivedGame g = archive.game(id);
+        same = same && g.size == records[id].size() && std::memcmp(g.data, records[id].data(), g.size) == 0;
+    }
+    expect(same, "every game reads back");
+    archive.close();
+
+    std::vector<uint8_t> good = readFile(path);
+    ArchiveTrailer t;
+    std::memcpy(&t, good.data() + good.size() - sizeof t, sizeof t);
+    uint64_t offsets = t.indexOffset, trailer = good.size() - sizeof t;
+    uint64_t first, second;
+    std::memcpy(&first, good.data() + offsets, 8);
+    std::memcpy(&second, good.data() + offsets + 8, 8);
+
+    expect(!opensWith(damaged, good, offsets + 8, first - 1), "offsets that run backwards are refused");
+    expect(!opensWith(damaged, good, offsets, t.prevEnd - 8), "an offset inside the previous segment is refused");
+    expect(!opensWith(damaged, good, offsets + 3*8, t.indexOffset + 8), "an offset past the index is refused");
+    expect(!opensWith(damaged, good, offsets + 3*8, ~uint64_t(0)), "an offset past the file is refused");
+    expect(!opensWith(damaged, good, trailer + 24, uint64_t(t.gameCount) << 32 | (t.firstGame + 1)),
+           "game ids that skip ahead are refused");
+    expect(opensWith(damaged, good, offsets + 8, second), "an undamaged copy opens");
+    writeDamaged(damaged, good, offsets + 8, first - 1);
+    GameArchiveWriter writer;
+    expect(!writer.open(damaged.c_str()), "the writer refuses to append to a damaged archive");
+
+    unlink(path.c_str());
+    unlink(damaged.c_str());
+    if (g_failures) std::printf("%d checks failed\n", g_failures);
+    return g_failures ? 1 : 0;
+}
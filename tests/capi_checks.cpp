@@ -0,0 +1,131 @@
+// Moves and saved states the C interface (EquatixApi.h) must refuse, and
+// saved states it must accept.
+//
+// Usage: capi_checks
+//
+// Each check prints one line and the run fails if any does not hold. A
+// refused call must leave the game exactly as it was, compared by its saved
+// bytes.
+
+#include "EquatixApi.h"
+#include "GameState.h"
+#include "MoveGenerator.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+int g_failures = 0;
+
+void expect(bool ok, const char* what) {
+    std::printf("%s: %s\n", ok ? "ok" : "FAILED", what);
+    if (!ok) ++g_failures;
+}
+
+bool sameState(const eqx_game* game, const unsigned char* saved) {
+    unsigned char now[EQX_STATE_SIZE];
+    return eqx_game_save(game, now, sizeof now) == EQX_OK && std::memcmp(now, saved, sizeof now) == 0;
+}
+
+// A second tile on a square the move already covers
+void repeatedSquare() {
+    for (uint64_t seed = 1; seed < 100; ++seed) {
+        GameState game(seed);
+        Move m;
+        if (!MoveGenerator(game).best(m) || m.count >= GameRules::MaxRackTiles) continue;
+        int spare = -1;
+        for (int s = 0; s < GameRules::OtherSymbolCount && spare < 0; ++s) {
+            int used = 0;
+            for (int t = 0; t < m.count; ++t) used += GameRules::symbolIndex(m.tiles[t].ch) == s;
+            if (game.rack(0)[s] > used) spare = s;
+        }
+        if (spare < 0) continue;
+
+        int rows[EQX_MAX_TILES], cols[EQX_MAX_TILES];
+        char symbols[EQX_MAX_TILES];
+        rows[0] = m.tiles[0].row;
+        cols[0] = m.tiles[0].col;
+        symbols[0] = GameRules::symbolChar(spare);
+        for (int t = 0; t < m.count; ++t) {
+            rows[t + 1] = m.tiles[t].row;
+            cols[t + 1] = m.tiles[t].col;
+            symbols[t + 1] = m.tiles[t].ch;
+        }
+
+        eqx_game *g = eqx_game_create(seed, EQX_VARIANT_STANDARD);
+        unsigned char before[EQX_STATE_SIZE];
+        eqx_game_save(g, before, sizeof before);
+        eqx_result result;
+        expect(eqx_validate(g, rows, cols, symbols, m.count + 1, &result) == EQX_CELL_UNAVAILABLE,
+               "eqx_validate refuses a square named twice");
+        expect(eqx_apply(g, rows, cols, symbols, m.count + 1, &result) == EQX_CELL_UNAVAILABLE,
+               "eqx_apply refuses a square named twice");
+        expect(sameState(g, before), "the refused move leaves the game unchanged");
+        expect(eqx_apply(g, rows + 1, cols + 1, symbols + 1, m.count, &result) == EQX_OK && result.score == m.score,
+               "the move without the extra tile is played");
+        eqx_game_destroy(g);
+        return;
+    }
+    expect(false, "a position for the repeated-square check");
+}
+
+// Saved games with tiles made up or lost, and real ones that must load
+void tamperedState() {
+    GameState game(11);
+    for (int ply = 0; ply < 6; ++ply) {
+        Move m;
+        RuleCheck check;
+        int points;
+        if (!MoveGenerator(game).best(m) || !game.place(m.tiles, m.count, check, points)) break;
+    }
+    GameSnapshot good;
+    expect(game.save(good), "a game in progress saves");
+    eqx_game *g = eqx_game_load(&good, sizeof good);
+    expect(g != nullptr, "a saved game loads");
+    if (!g) return;
+    unsigned char before[EQX_STATE_SIZE];
+    eqx_game_save(g, before, sizeof before);
+
+    GameSnapshot bad = good;
+    for (char &ch : bad.cells)
+        if (!ch) {
+            ch = '7';
+            break;
+        }
+    expect(eqx_game_restore(g, &bad, sizeof bad) == EQX_BAD_STATE, "a tile added to the board is refused");
+    bad = good;
+    ++bad.racks[0][GameRules::symbolIndex('3')];
+    expect(eqx_game_restore(g, &bad, sizeof bad) == EQX_BAD_STATE, "a tile added to a rack is refused");
+    bad = good;
+    bad.racks[1][GameRules::EqualsSymbol] = 0;
+    expect(eqx_game_restore(g, &bad, sizeof bad) == EQX_BAD_STATE, "an '=' missing from a rack is refused");
+    bad = good;
+    bad.otherTiles[TileBag::OtherTileTotal - 1] = bad.otherTiles[TileBag::OtherTileTotal - 1] == '1' ? '2' : '1';
+    expect(eqx_game_restore(g, &bad, sizeof bad) == EQX_BAD_STATE, "a tile changed in the bag is refused");
+    expect(sameState(g, before), "refused states leave the game unchanged");
+
+    // After a swap the pile is not checked against the tiles in play
+    int rack[EQX_SYMBOL_COUNT];
+    eqx_rack(g, eqx_current_player(g), rack);
+    char swapped[2];
+    int n = 0;
+    for (int s = 0; s < GameRules::OtherSymbolCount && n < 2; ++s)
+        if (rack[s]) swapped[n++] = GameRules::symbolChar(s);
+    expect(eqx_swap(g, swapped, n) == EQX_OK, "a swap is played");
+    unsigned char swappedState[EQX_STATE_SIZE];
+    eqx_game_save(g, swappedState, sizeof swappedState);
+    eqx_game *copy = eqx_game_load(swappedState, sizeof swappedState);
+    expect(copy && sameState(copy, swappedState), "a game saved after a swap loads");
+    eqx_game_destroy(copy);
+    eqx_game_destroy(g);
+}
+
+} // namespace
+
+int main() {
+    repeatedSquare();
+    tamperedState();
+    if (g_failures) std::printf("%d checks failed\n", g_failures);
+    return g_failures ? 1 : 0;
+}
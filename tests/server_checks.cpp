@@ -0,0 +1,155 @@
+// Requests equatix-server (GameServer) must refuse, checked over a real
+// socket.
+//
+// Usage: server_checks
+//
+// Runs a GameServer on a Unix socket in a background thread and talks to it
+// with blocking clients. Each check prints one line and the run fails if any
+// does not hold.
+
+#include "GameServer.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+int g_failures = 0;
+
+void expect(bool ok, const char* what) {
+    std::printf("%s: %s\n", ok ? "ok" : "FAILED", what);
+    if (!ok) ++g_failures;
+}
+
+struct Reply {
+    MsgType type = MsgType(0);
+    std::vector<uint8_t> payload;
+};
+
+class Client {
+public:
+    explicit Client(const char* path) {
+        m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::snprintf(addr.sun_path, sizeof addr.sun_path, "%s", path);
+        if (m_fd >= 0 && connect(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+        timeval timeout {5, 0};
+        if (m_fd >= 0) setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+    }
+    ~Client() { if (m_fd >= 0) ::close(m_fd); }
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    bool connected() const { return m_fd >= 0; }
+
+    void send(MsgType type, uint32_t gameId) {
+        std::vector<uint8_t> out;
+        WireWriter w(out);
+        w.begin(type);
+        w.u32(gameId);
+        w.end();
+        sendAll(out);
+    }
+    void create() {
+        std::vector<uint8_t> out;
+        WireWriter w(out);
+        w.begin(MsgType::CreateGame);
+        w.u64(1);
+        w.end();
+        sendAll(out);
+    }
+
+    // The next frame, or type 0 on a timeout or a closed connection
+    Reply read() {
+        Reply reply;
+        uint32_t len = 0;
+        if (!readAll(&len, 4) || len == 0 || len > kMaxFrame) return reply;
+        uint8_t type = 0;
+        reply.payload.resize(len - 1);
+        if (!readAll(&type, 1) || !readAll(reply.payload.data(), len - 1)) return reply;
+        reply.type = MsgType(type);
+        return reply;
+    }
+
+private:
+    void sendAll(const std::vector<uint8_t>& out) {
+        for (size_t done = 0; m_fd >= 0 && done < out.size();) {
+            ssize_t n = ::send(m_fd, out.data() + done, out.size() - done, MSG_NOSIGNAL);
+            if (n <= 0) return;
+            done += size_t(n);
+        }
+    }
+    bool readAll(void* p, size_t n) {
+        for (size_t done = 0; done < n;) {
+            ssize_t got = ::recv(m_fd, static_cast<uint8_t*>(p) + done, n - done, 0);
+            if (got <= 0) return false;
+            done += size_t(got);
+        }
+        return true;
+    }
+
+    int m_fd = -1;
+};
+
+bool isError(const Reply& r, ServerError e) {
+    return r.type == MsgType::Error && r.payload.size() == 1 && r.payload[0] == uint8_t(e);
+}
+
+uint32_t joinedGame(const Reply& r) {
+    uint32_t gameId = 0;
+    if (r.type == MsgType::Joined && r.payload.size() == 5) std::memcpy(&gameId, r.payload.data(), 4);
+    return gameId;
+}
+
+// The spectator feed shows both racks, so players may not watch their own game
+void seatedSpectators(const char* path) {
+    Client first(path), second(path), watcher(path);
+    expect(first.connected() && second.connected() && watcher.connected(), "clients connect");
+    first.create();
+    uint32_t gameId = joinedGame(first.read());
+    expect(gameId != 0, "a game is created");
+    second.send(MsgType::JoinGame, gameId);
+    expect(joinedGame(second.read()) == gameId, "a second player joins");
+
+    first.send(MsgType::Spectate, gameId);
+    expect(isError(first.read(), ServerError::SeatedSpectator), "the creator cannot spectate the game");
+    second.send(MsgType::Spectate, gameId);
+    expect(isError(second.read(), ServerError::SeatedSpectator), "the joiner cannot spectate the game");
+
+    watcher.send(MsgType::Spectate, gameId);
+    expect(watcher.read().type == MsgType::Keyframe, "anyone else can spectate");
+    // Catch-up may add deltas; the refusal follows them
+    Reply r;
+    watcher.send(MsgType::JoinGame, gameId);
+    do r = watcher.read(); while (r.type == MsgType::Delta);
+    expect(isError(r, ServerError::SeatedSpectator), "a spectator cannot take a seat at the game");
+}
+
+} // namespace
+
+int main() {
+    std::string path = "/tmp/equatix-server-checks-" + std::to_string(getpid());
+    GameServer server;
+    if (!server.listenUnix(path.c_str())) {
+        std::printf("FAILED: cannot listen on %s\n", path.c_str());
+        return 1;
+    }
+    std::thread loop([&] { server.run(); });
+
+    seatedSpectators(path.c_str());
+
+    server.stop();
+    loop.join();
+    unlink(path.c_str());
+    if (g_failures) std::printf("%d checks failed\n", g_failures);
+    return g_failures ? 1 : 0;
+}
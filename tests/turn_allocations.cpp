@@ -0,0 +1,122 @@
+// The per-turn path must not allocate: capture, GameRules::validate,
+// scoreTurn, GameState::place and the metrics and trace they record.
+//
+// Usage: turn_allocations [--games N]
+//
+// Self-plays N games with MoveGenerator. Every move is captured and checked
+// as GameTab does it, and so is the same move with one digit changed, which
+// the equation check rejects. operator new is replaced to count allocations
+// while a turn runs. Fails on any allocation or on a score that differs from
+// MoveGenerator's. The first turn sets up per-thread trace state and is not
+// counted.
+
+#include "GameMetrics.h"
+#include "GameState.h"
+#include "MoveGenerator.h"
+#include "TurnInput.h"
+#include "TurnTrace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+bool g_watch = false;
+long g_allocs = 0;
+
+void* allocate(size_t n) {
+    if (g_watch) ++g_allocs;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(size_t n) { return allocate(n); }
+void* operator new[](size_t n) { return allocate(n); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept {
+    if (g_watch) ++g_allocs;
+    return std::malloc(n ? n : 1);
+}
+void* operator new[](size_t n, const std::nothrow_t&) noexcept {
+    if (g_watch) ++g_allocs;
+    return std::malloc(n ? n : 1);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+    int games = 20;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) games = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::fprintf(stderr, "usage: %s [--games N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    TurnTrace::setEnabled(true);
+    static TurnInput turn;
+    long turns = 0, watched = 0, allocs = 0;
+    int mismatches = 0;
+    for (int g = 0; g < games; ++g) {
+        GameState game(uint64_t(g) + 1);
+        Move m;
+        while (MoveGenerator(game).best(m)) {
+            // The board as the GUI holds it: this turn's tiles already down
+            char board[GameRules::CellCount];
+            int newCells[GameRules::MaxRackTiles];
+            std::memcpy(board, game.board(), sizeof board);
+            for (int t = 0; t < m.count; ++t) {
+                newCells[t] = m.tiles[t].row*GameRules::BoardSize + m.tiles[t].col;
+                board[newCells[t]] = m.tiles[t].ch;
+            }
+            int digit = -1;
+            for (int t = 0; t < m.count && digit < 0; ++t)
+                if (m.tiles[t].ch >= '0' && m.tiles[t].ch <= '9') digit = t;
+
+            g_allocs = 0;
+            g_watch = turns > 0;
+            RuleCheck check;
+            int points = 0;
+            bool ok;
+            {
+                TracePhase trace("turn");
+                turn.capture(board, game.multipliersUsed(), newCells, m.count);
+                ok = GameRules::validate(turn.cells, turn.tiles, turn.count, check);
+                points = GameRules::scoreTurn(turn.cells, turn.used, turn.tiles, turn.count);
+                if (digit >= 0) {
+                    // Rejected turns take the error paths
+                    RuleCheck rejected;
+                    char &ch = board[newCells[digit]];
+                    ch = ch == '9' ? '1' : char(ch + 1);
+                    turn.capture(board, game.multipliersUsed(), newCells, m.count);
+                    GameRules::validate(turn.cells, turn.tiles, turn.count, rejected);
+                    GameMetrics::recordValidation(rejected);
+                }
+                int placed = 0;
+                ok = ok && game.place(m.tiles, m.count, check, placed) && placed == points;
+                GameMetrics::recordValidation(check);
+                GameMetrics::recordScore(points);
+            }
+            g_watch = false;
+            if (turns++ > 0) {
+                ++watched;
+                allocs += g_allocs;
+            }
+            if (!ok || points != m.score) {
+                ++mismatches;
+                break;
+            }
+        }
+    }
+
+    std::printf("%ld turns, %ld watched, %ld heap allocations\n", turns, watched, allocs);
+    if (mismatches) std::printf("%d moves rejected or scored differently from MoveGenerator\n", mismatches);
+    return allocs || mismatches ? 1 : 0;
+}
@@ -0,0 +1,165 @@
+// Annotate recorded games with the best move at every turn (see GameAnalyzer.h).
+//
+// Usage: equatix-analyze [--threads N] [--summary] RECORD...
+//        equatix-analyze [--threads N] [--summary] --archive ARCHIVE [--first ID] [--count N]
+//
+// Every move is listed with the points it scored, the best move the mover had
+// (tiles as symbol@row,col), the points given up and the rank of the move
+// played among all placements. --summary prints one line per game instead.
+// Positions from many games are analyzed together, so a whole archive keeps
+// every thread busy.
+
+#include "GameAnalyzer.h"
+#include "GameArchive.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kBatchPositions = 4096;
+
+struct Options {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    bool summary = false;
+};
+
+struct PendingGame {
+    std::string name;
+    size_t first = 0;       // into the batch's positions
+    size_t count = 0;
+    const char* error = nullptr;
+};
+
+// Positions of several games, analyzed in one parallel pass.
+class Batch {
+public:
+    explicit Batch(const Options& opt) : m_opt(opt) {}
+
+    void add(std::string name, const uint8_t* data, size_t size) {
+        PendingGame g;
+        g.name = std::move(name);
+        g.first = m_positions.size();
+        GameAnalyzer::positions(data, size, m_positions, &g.error);
+        g.count = m_positions.size() - g.first;
+        m_games.push_back(std::move(g));
+        if (m_positions.size() >= kBatchPositions) flush();
+    }
+
+    void flush() {
+        m_results.resize(m_positions.size());
+        GameAnalyzer::analyze(m_positions.data(), m_positions.size(), m_results.data(), m_opt.threads);
+        for (const PendingGame& g : m_games) print(g);
+        m_positions.clear();
+        m_games.clear();
+    }
+
+    uint64_t games = 0, moves = 0, failures = 0;
+
+private:
+    void print(const PendingGame& g) {
+        const PlyAnalysis* a = m_results.data() + g.first;
+        int scores[2] = {0, 0}, lost[2] = {0, 0}, best = 0;
+        for (size_t i = 0; i < g.count; ++i) {
+            scores[a[i].player] += a[i].played;
+            lost[a[i].player] += a[i].lost();
+            best += a[i].lost() == 0;
+        }
+        ++games;
+        moves += g.count;
+        if (g.error) ++failures;
+
+        std::printf("%s: %zu moves, %d-%d, lost %d-%d, %d best", g.name.c_str(), g.count,
+                    scores[0], scores[1], lost[0], lost[1], best);
+        if (g.error) std::printf(", FAILED at move %zu: %s", g.count + 1, g.error);
+        std::printf("\n");
+        if (m_opt.summary || g.count == 0) return;
+
+        std::printf("  %4s %6s %6s %5s %5s %10s  %s\n", "ply", "player", "played", "best", "lost", "rank", "best move");
+        for (size_t i = 0; i < g.count; ++i) {
+            const PlyAnalysis& p = a[i];
+            char played[8], rank[24];
+            if (p.kind == MoveKind::Swap) std::snprintf(played, sizeof played, "swap");
+            else std::snprintf(played, sizeof played, "%d", p.played);
+            std::snprintf(rank, sizeof rank, "%d/%d", p.rank, p.moves);
+            std::printf("  %4d %6s %6s %5d %5d %10s ", p.ply, p.player ? "P2" : "P1", played,
+                        p.best.score, p.lost(), rank);
+            if (p.best.count == 0) std::printf(" -");
+            for (int t = 0; t < p.best.count; ++t)
+                std::printf(" %c@%d,%d", p.best.tiles[t].ch, p.best.tiles[t].row, p.best.tiles[t].col);
+            std::printf("\n");
+        }
+    }
+
+    const Options& m_opt;
+    std::vector<AnalysisPosition> m_positions;
+    std::vector<PlyAnalysis> m_results;
+    std::vector<PendingGame> m_games;
+};
+
+int usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "usage: %s [--threads N] [--summary] RECORD...\n"
+                 "       %s [--threads N] [--summary] --archive ARCHIVE [--first ID] [--count N]\n",
+                 argv0, argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    const char* archivePath = nullptr;
+    uint32_t first = 0, count = UINT32_MAX;
+    std::vector<const char*> records;
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        if (!std::strcmp(a, "--threads") && i + 1 < argc) opt.threads = unsigned(std::max(1, std::atoi(argv[++i])));
+        else if (!std::strcmp(a, "--summary")) opt.summary = true;
+        else if (!std::strcmp(a, "--archive") && i + 1 < argc) archivePath = argv[++i];
+        else if (!std::strcmp(a, "--first") && i + 1 < argc) first = uint32_t(std::strtoul(argv[++i], nullptr, 0));
+        else if (!std::strcmp(a, "--count") && i + 1 < argc) count = uint32_t(std::strtoul(argv[++i], nullptr, 0));
+        else if (a[0] != '-') records.push_back(a);
+        else return usage(argv[0]);
+    }
+    if (archivePath ? !records.empty() : records.empty()) return usage(argv[0]);
+
+    Batch batch(opt);
+    auto t0 = std::chrono::steady_clock::now();
+    if (archivePath) {
+        GameArchive archive;
+        if (!archive.open(archivePath)) {
+            std::fprintf(stderr, "%s: not a game archive\n", archivePath);
+            return 1;
+        }
+        uint32_t end = first + std::min(count, archive.gameCount() - std::min(first, archive.gameCount()));
+        for (uint32_t id = first; id < end; ++id) {
+            ArchivedGame g = archive.game(id);
+            batch.add("game " + std::to_string(g.id), g.data, g.size);
+        }
+        batch.flush();
+    } else {
+        for (const char* path : records) {
+            MappedFile f;
+            if (!f.open(path)) {
+                std::fprintf(stderr, "%s: cannot open\n", path);
+                return 2;
+            }
+            batch.add(path, f.data(), f.size());   // positions are copied out of the record
+        }
+        batch.flush();
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::fprintf(stderr, "%llu games, %llu moves in %.3f s (%.0f moves/s) on %u threads\n",
+                 (unsigned long long)batch.games, (unsigned long long)batch.moves, secs,
+                 secs > 0 ? double(batch.moves) / secs : 0.0, opt.threads);
+    return batch.failures ? 1 : 0;
+}
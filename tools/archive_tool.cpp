@@ -0,0 +1,148 @@
+// Build and query game archives (see GameArchive.h).
+//
+//   equatix-archive add ARCHIVE RECORD...      append records as one segment
+//   equatix-archive scan ARCHIVE [--repeat N] [--replay]
+//                                              decode every game, report GB/s
+//   equatix-archive find ARCHIVE HASH          games that reached a position
+//   equatix-archive positions RECORD           position hash after each move
+
+#include "GameArchive.h"
+#include "GameRecord.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+int usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "usage: %s add ARCHIVE RECORD...\n"
+                 "       %s scan ARCHIVE [--repeat N] [--replay]\n"
+                 "       %s find ARCHIVE HASH\n"
+                 "       %s positions RECORD\n", argv0, argv0, argv0, argv0);
+    return 2;
+}
+
+int add(const char* archive, char** records, int count) {
+    GameArchiveWriter writer;
+    if (!writer.open(archive)) {
+        std::fprintf(stderr, "%s: cannot open archive\n", archive);
+        return 1;
+    }
+    int rejected = 0;
+    for (int i = 0; i < count; ++i) {
+        MappedFile f;
+        if (!f.open(records[i]) || !writer.add(f.data(), f.size())) {
+            std::fprintf(stderr, "%s: not a game record, skipped\n", records[i]);
+            ++rejected;
+        }
+    }
+    if (!writer.close()) {
+        std::fprintf(stderr, "%s: write failed\n", archive);
+        return 1;
+    }
+    std::printf("%s: %u games\n", archive, writer.gameCount());
+    return rejected ? 1 : 0;
+}
+
+int scan(const char* path, int repeat, bool replay) {
+    GameArchive archive;
+    if (!archive.open(path)) {
+        std::fprintf(stderr, "%s: not a game archive\n", path);
+        return 1;
+    }
+
+    uint64_t games = 0, moves = 0, bytes = 0, failures = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repeat; ++rep) {
+        for (ArchivedGame g : archive) {
+            ++games;
+            bytes += g.size;
+            if (replay) {
+                ReplayResult r = GameReplayer::replay(g.data, g.size);
+                moves += uint64_t(r.plies);
+                failures += !r.ok;
+                continue;
+            }
+            GameRecordReader reader(g.data, g.size);
+            RecordedMove move;
+            while (reader.next(move)) ++moves;
+            failures += !reader.isValid() || reader.truncated();
+        }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("%" PRIu64 " games, %" PRIu64 " moves, %" PRIu64 " bytes in %.3f s\n", games, moves, bytes, secs);
+    if (secs > 0) {
+        std::printf("%.3f GB/s, %.0f games/s, %.0f moves/s\n",
+                    bytes / secs / 1e9, games / secs, moves / secs);
+    }
+    if (failures) std::printf("%" PRIu64 " games failed to %s\n", failures, replay ? "replay" : "decode");
+    return failures ? 1 : 0;
+}
+
+int find(const char* path, const char* hashText) {
+    GameArchive archive;
+    if (!archive.open(path)) {
+        std::fprintf(stderr, "%s: not a game archive\n", path);
+        return 1;
+    }
+    uint64_t hash = std::strtoull(hashText, nullptr, 16);
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<ArchivePosition> hits = archive.findPosition(hash);
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    for (const ArchivePosition& p : hits) std::printf("game %u ply %u\n", p.game, p.ply);
+    std::printf("%zu hits in %.1f us\n", hits.size(), us);
+    return 0;
+}
+
+int positions(const char* path) {
+    MappedFile f;
+    if (!f.open(path)) {
+        std::fprintf(stderr, "%s: cannot open\n", path);
+        return 1;
+    }
+    GameRecordReader reader(f.data(), f.size());
+    if (!reader.isValid()) {
+        std::fprintf(stderr, "%s: not a game record\n", path);
+        return 1;
+    }
+    uint64_t hash = 0;
+    int ply = 0;
+    RecordedMove move;
+    while (reader.next(move)) {
+        ++ply;
+        if (move.kind != MoveKind::Place) continue;
+        for (int i = 0; i < move.count; ++i) {
+            const TilePlacement& t = move.tiles[i];
+            hash ^= GameRules::zobrist(t.row * GameRules::BoardSize + t.col, GameRules::symbolIndex(t.ch));
+        }
+        std::printf("ply %d %016" PRIx64 "\n", ply, hash);
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) return usage(argv[0]);
+    const char* cmd = argv[1];
+    if (std::strcmp(cmd, "add") == 0 && argc >= 4) return add(argv[2], argv + 3, argc - 3);
+    if (std::strcmp(cmd, "find") == 0 && argc == 4) return find(argv[2], argv[3]);
+    if (std::strcmp(cmd, "positions") == 0) return positions(argv[2]);
+    if (std::strcmp(cmd, "scan") == 0) {
+        int repeat = 1;
+        bool replay = false;
+        for (int i = 3; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) repeat = std::max(1, std::atoi(argv[++i]));
+            else if (std::strcmp(argv[i], "--replay") == 0) replay = true;
+            else return usage(argv[0]);
+        }
+        return scan(argv[2], repeat, replay);
+    }
+    return usage(argv[0]);
+}
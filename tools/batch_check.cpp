@@ -0,0 +1,268 @@
+// Check equation strings in bulk, one per line.
+//
+// Usage: equatix-check [--eval] [--rules VARIANT] [--threads N] [--batch MB]
+//                      [--output PATH | --quiet] [FILE | -]
+//
+// Each input line gets one output line, in input order:
+//   ok VALUE              a true equation, VALUE being both sides
+//   unequal LHS RHS       both sides evaluate but differ
+//   equals-count | missing-side | lhs-invalid | rhs-invalid
+// With --eval lines are expressions instead and come back as VALUE or
+// invalid. Files are mapped, stdin is read in batches; each batch is cut at
+// line ends into blocks that are checked in parallel and written back in
+// order. Counts and throughput go to stderr.
+
+#include "MappedFile.h"
+#include "RuleVariants.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kBlockBytes = 256 << 10;
+
+const char* const kVerdicts[] = {"ok", "equals-count", "missing-side", "lhs-invalid", "rhs-invalid", "unequal"};
+constexpr int kVerdictCount = int(std::size(kVerdicts));
+constexpr int kInvalid = 1;     // --eval tallies under ok and this
+
+struct Options {
+    const RuleEngine* rules = &RuleEngine::get(RuleVariant::Standard);
+    bool eval = false;
+    bool quiet = false;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t batchBytes = size_t(64) << 20;
+};
+
+struct Block {
+    const char* begin;
+    const char* end;
+    std::string out;
+    uint64_t tally[kVerdictCount] = {};
+};
+
+void put(std::string& out, const char* s) {
+    out.append(s);
+}
+
+void put(std::string& out, long long v) {
+    char buf[24];
+    out.append(buf, std::to_chars(buf, buf + sizeof buf, v).ptr);
+}
+
+void checkBlock(const Options& opt, Block& b) {
+    b.out.clear();
+    b.out.reserve(size_t(b.end - b.begin) + (size_t(b.end - b.begin) >> 1));
+    for (const char* p = b.begin; p < b.end;) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', size_t(b.end - p)));
+        const char* eol = nl ? nl : b.end;
+        int n = int(eol - p);
+        if (n > 0 && p[n-1] == '\r') --n;
+        if (opt.eval) {
+            std::optional<long long> v = opt.rules->evalExpr(p, n);
+            ++b.tally[v ? 0 : kInvalid];
+            if (!opt.quiet) {
+                if (v) put(b.out, *v);
+                else put(b.out, "invalid");
+            }
+        } else {
+            long long lhs = 0, rhs = 0;
+            EquationError why = opt.rules->checkEquation(p, n, &lhs, &rhs);
+            ++b.tally[int(why)];
+            if (!opt.quiet) {
+                put(b.out, kVerdicts[int(why)]);
+                if (why == EquationError::None || why == EquationError::Unequal) {
+                    b.out += ' ';
+                    put(b.out, lhs);
+                }
+                if (why == EquationError::Unequal) {
+                    b.out += ' ';
+                    put(b.out, rhs);
+                }
+            }
+        }
+        if (!opt.quiet) b.out += '\n';
+        p = eol + 1;
+    }
+}
+
+// Checks whole lines in [begin, end) and writes the results in order.
+class Checker {
+public:
+    Checker(const Options& opt, std::FILE* out) : m_opt(opt), m_out(out) {}
+
+    bool run(const char* begin, const char* end) {
+        m_blocks.clear();
+        while (begin < end) {
+            const char* cut = begin + std::min(kBlockBytes, size_t(end - begin));
+            if (cut < end) {
+                const char* nl = static_cast<const char*>(std::memchr(cut, '\n', size_t(end - cut)));
+                cut = nl ? nl + 1 : end;
+            }
+            m_blocks.push_back({begin, cut, {}, {}});
+            begin = cut;
+        }
+        if (m_blocks.empty()) return true;
+
+        // Workers claim blocks in order; this thread writes each one as soon
+        // as it and everything before it is done.
+        std::atomic<size_t> next{0};
+        std::unique_ptr<std::atomic<bool>[]> done(new std::atomic<bool>[m_blocks.size()]);
+        for (size_t i = 0; i < m_blocks.size(); ++i) done[i] = false;
+        auto work = [&] {
+            for (size_t i; (i = next++) < m_blocks.size();) {
+                checkBlock(m_opt, m_blocks[i]);
+                done[i].store(true, std::memory_order_release);
+            }
+        };
+        unsigned helpers = std::min<size_t>(m_opt.threads, m_blocks.size()) - 1;
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < helpers; ++t) pool.emplace_back(work);
+
+        bool ok = true;
+        for (size_t i = 0; i < m_blocks.size(); ++i) {
+            if (!done[i].load(std::memory_order_acquire)) {
+                // Check a block ourselves rather than wait
+                size_t j = next++;
+                if (j < m_blocks.size()) {
+                    checkBlock(m_opt, m_blocks[j]);
+                    done[j].store(true, std::memory_order_release);
+                }
+                while (!done[i].load(std::memory_order_acquire)) std::this_thread::yield();
+            }
+            Block &b = m_blocks[i];
+            if (!b.out.empty() && std::fwrite(b.out.data(), 1, b.out.size(), m_out) != b.out.size()) ok = false;
+            for (int v = 0; v < kVerdictCount; ++v) tally[v] += b.tally[v];
+            std::string().swap(b.out);
+        }
+        for (auto &th : pool) th.join();
+        return ok;
+    }
+
+    uint64_t tally[kVerdictCount] = {};
+
+private:
+    const Options& m_opt;
+    std::FILE* m_out;
+    std::vector<Block> m_blocks;
+};
+
+// Reads a stream in batches, carrying a partial last line into the next one.
+bool checkStream(std::FILE* in, Checker& checker, size_t batchBytes, uint64_t& bytes) {
+    std::vector<char> buf(batchBytes);
+    size_t carry = 0;
+    for (;;) {
+        if (carry == buf.size()) buf.resize(buf.size() * 2);   // one very long line
+        size_t got = std::fread(buf.data() + carry, 1, buf.size() - carry, in);
+        bytes += got;
+        size_t have = carry + got;
+        if (got == 0) return checker.run(buf.data(), buf.data() + have) && !std::ferror(in);
+        size_t whole = have;
+        while (whole > 0 && buf[whole-1] != '\n') --whole;
+        if (!checker.run(buf.data(), buf.data() + whole)) return false;
+        carry = have - whole;
+        std::memmove(buf.data(), buf.data() + whole, carry);
+    }
+}
+
+int usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "usage: %s [--eval] [--rules VARIANT] [--threads N] [--batch MB]\n"
+                 "          [--output PATH | --quiet] [FILE | -]\n", argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    const char* inPath = "-";
+    const char* outPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--eval") == 0) opt.eval = true;
+        else if (std::strcmp(argv[i], "--quiet") == 0) opt.quiet = true;
+        else if (std::strcmp(argv[i], "--rules") == 0 && i + 1 < argc) {
+            opt.rules = RuleEngine::find(argv[++i]);
+            if (!opt.rules) {
+                std::fprintf(stderr, "%s: unknown rules\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) opt.threads = unsigned(std::max(1, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) opt.batchBytes = size_t(std::max(1, std::atoi(argv[++i]))) << 20;
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) outPath = argv[++i];
+        else if (argv[i][0] != '-' || std::strcmp(argv[i], "-") == 0) inPath = argv[i];
+        else return usage(argv[0]);
+    }
+
+    std::FILE *out = outPath ? std::fopen(outPath, "wb") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "%s: cannot open\n", outPath);
+        return 1;
+    }
+    std::setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+    Checker checker(opt, out);
+    uint64_t bytes = 0;
+    bool ok;
+    auto t0 = std::chrono::steady_clock::now();
+    MappedFile mapped;
+    if (std::strcmp(inPath, "-") != 0 && mapped.open(inPath)) {
+        // Batches bound the output held in memory, not the input
+        const char* p = reinterpret_cast<const char*>(mapped.data());
+        const char* end = p + mapped.size();
+        bytes = mapped.size();
+        ok = true;
+        while (ok && p < end) {
+            const char* cut = p + std::min(opt.batchBytes, size_t(end - p));
+            if (cut < end) {
+                const char* nl = static_cast<const char*>(std::memchr(cut, '\n', size_t(end - cut)));
+                cut = nl ? nl + 1 : end;
+            }
+            ok = checker.run(p, cut);
+            p = cut;
+        }
+    } else {
+        // stdin, a pipe, or an empty file
+        std::FILE *in = std::strcmp(inPath, "-") == 0 ? stdin : std::fopen(inPath, "rb");
+        if (!in) {
+            std::fprintf(stderr, "%s: cannot open\n", inPath);
+            return 1;
+        }
+        ok = checkStream(in, checker, opt.batchBytes, bytes);
+        if (in != stdin) std::fclose(in);
+    }
+    if (std::fflush(out) != 0) ok = false;
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (out != stdout) std::fclose(out);
+
+    uint64_t lines = 0;
+    for (uint64_t n : checker.tally) lines += n;
+    if (opt.eval) {
+        std::fprintf(stderr, "%llu expressions: %llu valid, %llu invalid\n", (unsigned long long)lines,
+                     (unsigned long long)checker.tally[0], (unsigned long long)checker.tally[kInvalid]);
+    } else {
+        std::fprintf(stderr, "%llu equations:", (unsigned long long)lines);
+        for (int v = 0; v < kVerdictCount; ++v)
+            std::fprintf(stderr, " %s %llu%s", kVerdicts[v], (unsigned long long)checker.tally[v],
+                         v + 1 < kVerdictCount ? "," : "\n");
+    }
+    std::fprintf(stderr, "%.3f s, %.1f M lines/s, %.0f MB/s, %u threads, %s rules\n",
+                 secs, secs > 0 ? double(lines) / secs / 1e6 : 0.0, secs > 0 ? double(bytes) / secs / 1e6 : 0.0,
+                 opt.threads, opt.rules->name);
+    if (!ok) {
+        std::fprintf(stderr, "write failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,253 @@
+// Offline solver for the opening book (see OpeningBook.h).
+//
+// Usage: equatix-openings [output-file]
+//
+// Every true equation that fits in an opening rack is LHS '=' RHS with at most
+// seven non-equals tiles in total. Each side is enumerated once and bucketed
+// by value; pairing the buckets yields every equation. The best placement of
+// each equation on the centre row is reduced to a best score per tile
+// multiset, and each full rack then takes the best of its sub-multisets.
+
+#include "GameRules.h"
+#include "OpeningBook.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kMaxSide = OpeningBook::RackSize - 1;
+constexpr int kBits = 3; // per-symbol count field in a packed multiset
+
+struct Expr {
+    long long value;
+    uint64_t packed;    // kBits per symbol count
+    uint8_t len;
+    char s[kMaxSide];
+};
+
+struct Best {
+    int score = -1;
+    uint8_t start = 0;
+    uint8_t len = 0;
+    char eq[8] = {};
+};
+
+bool better(const Best& a, const Best& b) {
+    if (a.score != b.score) return a.score > b.score;
+    int c = std::memcmp(a.eq, b.eq, sizeof a.eq);
+    if (c != 0) return c < 0;
+    return a.start < b.start;
+}
+
+// Piece and equation multipliers along the centre row.
+int g_piece[GameRules::BoardSize];
+int g_equation[GameRules::BoardSize];
+
+void initRow() {
+    for (int c = 0; c < GameRules::BoardSize; ++c) {
+        MultiplierType mt = GameRules::multiplierAt(GameRules::Center, c);
+        g_piece[c] = mt == DoublePiece ? 2 : mt == TriplePiece ? 3 : 1;
+        g_equation[c] = mt == DoubleEquation ? 2 : mt == TripleEquation ? 3 : 1;
+    }
+}
+
+std::vector<Expr> enumerateSides() {
+    std::vector<Expr> out;
+    char buf[kMaxSide];
+    int digits[kMaxSide];
+    for (int len = 1; len <= kMaxSide; ++len) {
+        std::fill(digits, digits + len, 0);
+        for (;;) {
+            for (int i = 0; i < len; ++i) buf[i] = GameRules::symbolChar(digits[i]);
+            if (auto v = GameRules::evalExpr(buf, len)) {
+                Expr e;
+                e.value = *v;
+                e.packed = 0;
+                e.len = uint8_t(len);
+                std::memcpy(e.s, buf, len);
+                for (int i = 0; i < len; ++i) e.packed += uint64_t(1) << (kBits * digits[i]);
+                out.push_back(e);
+            }
+            int i = len - 1;
+            while (i >= 0 && ++digits[i] == GameRules::OtherSymbolCount) digits[i--] = 0;
+            if (i < 0) break;
+        }
+    }
+    return out;
+}
+
+uint32_t packedIndex(uint64_t packed, int size) {
+    int counts[GameRules::OtherSymbolCount];
+    for (int s = 0; s < GameRules::OtherSymbolCount; ++s)
+        counts[s] = int((packed >> (kBits * s)) & ((1u << kBits) - 1));
+    return OpeningBook::multisetIndex(counts, size);
+}
+
+// Best placement of one equation covering the centre square.
+void placeEquation(const char* eq, int n, Best& best) {
+    int lo = std::max(0, GameRules::Center - n + 1);
+    int hi = std::min(GameRules::Center, GameRules::BoardSize - n);
+    for (int s = lo; s <= hi; ++s) {
+        int sum = 0, mult = 1;
+        for (int i = 0; i < n; ++i) {
+            sum += GameRules::baseTileScore(eq[i]) * g_piece[s + i];
+            mult *= g_equation[s + i];
+        }
+        Best cand;
+        cand.score = sum * mult;
+        cand.start = uint8_t(s);
+        cand.len = uint8_t(n);
+        std::memcpy(cand.eq, eq, n);
+        if (better(cand, best)) best = cand;
+    }
+}
+
+using BestTable = std::vector<std::vector<Best>>; // [size][multisetIndex]
+
+BestTable makeTable() {
+    BestTable t(OpeningBook::RackSize + 1);
+    for (int k = 2; k <= OpeningBook::RackSize; ++k) t[k].resize(OpeningBook::multisetCount(k));
+    return t;
+}
+
+// Pair every LHS with every RHS of the same value. [first, last) spans one value.
+void pairBucket(const Expr* first, const Expr* last, BestTable& table, uint64_t& pairs) {
+    const Expr* byLen[kMaxSide + 2];
+    for (int len = 1; len <= kMaxSide + 1; ++len) {
+        byLen[len] = std::find_if(first, last, [len](const Expr& e) { return e.len >= len; });
+    }
+    char eq[8];
+    for (int a = 1; a <= kMaxSide; ++a) {
+        for (int b = 1; a + b <= OpeningBook::RackSize; ++b) {
+            for (const Expr* l = byLen[a]; l != byLen[a+1]; ++l) {
+                std::memcpy(eq, l->s, a);
+                eq[a] = '=';
+                for (const Expr* r = byLen[b]; r != byLen[b+1]; ++r) {
+                    std::memcpy(eq + a + 1, r->s, b);
+                    Best& slot = table[a + b][packedIndex(l->packed + r->packed, a + b)];
+                    placeEquation(eq, a + b + 1, slot);
+                    ++pairs;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* outPath = argc > 1 ? argv[1] : "openings.bin";
+    auto t0 = std::chrono::steady_clock::now();
+    initRow();
+
+    std::vector<Expr> sides = enumerateSides();
+    std::sort(sides.begin(), sides.end(), [](const Expr& a, const Expr& b) {
+        return a.value != b.value ? a.value < b.value : a.len < b.len;
+    });
+    std::vector<size_t> bucketStarts;
+    for (size_t i = 0; i < sides.size(); ++i)
+        if (i == 0 || sides[i].value != sides[i-1].value) bucketStarts.push_back(i);
+    bucketStarts.push_back(sides.size());
+    std::printf("%zu expressions, %zu distinct values\n", sides.size(), bucketStarts.size() - 1);
+
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<BestTable> tables(threads);
+    std::vector<uint64_t> pairCounts(threads, 0);
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            tables[t] = makeTable();
+            for (size_t b; (b = next++) + 1 < bucketStarts.size();) {
+                pairBucket(sides.data() + bucketStarts[b], sides.data() + bucketStarts[b+1],
+                           tables[t], pairCounts[t]);
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+
+    BestTable& best = tables[0];
+    uint64_t pairs = pairCounts[0];
+    for (unsigned t = 1; t < threads; ++t) {
+        pairs += pairCounts[t];
+        for (int k = 2; k <= OpeningBook::RackSize; ++k)
+            for (size_t i = 0; i < best[k].size(); ++i)
+                if (better(tables[t][k][i], best[k][i])) best[k][i] = tables[t][k][i];
+    }
+    std::printf("%llu equations scored\n", (unsigned long long)pairs);
+
+    // Every full rack takes the best opening among its sub-multisets.
+    std::vector<OpeningBookEntry> entries;
+    int counts[GameRules::OtherSymbolCount] = {};
+    int limit[GameRules::OtherSymbolCount];
+    for (int s = 0; s < GameRules::OtherSymbolCount; ++s)
+        limit[s] = std::min(OpeningBook::RackSize, GameRules::tileCount(GameRules::symbolChar(s)));
+
+    // Enumerate racks as count vectors summing to RackSize, in index order.
+    auto visitRack = [&]() {
+        Best rackBest;
+        int sub[GameRules::OtherSymbolCount] = {};
+        for (;;) {
+            int k = 0;
+            for (int s = 0; s < GameRules::OtherSymbolCount; ++s) k += sub[s];
+            if (k >= 2) {
+                const Best& b = best[k][OpeningBook::multisetIndex(sub, k)];
+                if (b.score >= 0 && better(b, rackBest)) rackBest = b;
+            }
+            int s = 0;
+            while (s < GameRules::OtherSymbolCount && ++sub[s] > counts[s]) sub[s++] = 0;
+            if (s == GameRules::OtherSymbolCount) break;
+        }
+        OpeningBookEntry e {};
+        e.rack = OpeningBook::rackIndex(counts);
+        if (rackBest.score >= 0) {
+            e.score = uint16_t(rackBest.score);
+            e.startCol = rackBest.start;
+            e.length = rackBest.len;
+            std::memcpy(e.equation, rackBest.eq, sizeof e.equation);
+        }
+        entries.push_back(e);
+    };
+    auto recurse = [&](auto& self, int sym, int remaining) -> void {
+        if (sym == GameRules::OtherSymbolCount - 1) {
+            if (remaining > limit[sym]) return;
+            counts[sym] = remaining;
+            visitRack();
+            return;
+        }
+        for (int c = std::min(remaining, limit[sym]); c >= 0; --c) {
+            counts[sym] = c;
+            self(self, sym + 1, remaining - c);
+        }
+        counts[sym] = 0;
+    };
+    recurse(recurse, 0, OpeningBook::RackSize);
+    std::sort(entries.begin(), entries.end(),
+              [](const OpeningBookEntry& a, const OpeningBookEntry& b) { return a.rack < b.rack; });
+
+    OpeningBookHeader h {};
+    std::memcpy(h.magic, "EQXOPEN1", 8);
+    h.version = OpeningBook::Version;
+    h.count = uint32_t(entries.size());
+    std::ofstream out(outPath, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    out.write(reinterpret_cast<const char*>(entries.data()), std::streamsize(entries.size() * sizeof(OpeningBookEntry)));
+    if (!out) {
+        std::fprintf(stderr, "failed to write %s\n", outPath);
+        return 1;
+    }
+
+    size_t solvable = std::count_if(entries.begin(), entries.end(),
+                                    [](const OpeningBookEntry& e) { return e.length > 0; });
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("%zu racks (%zu with an opening) written to %s in %.1f s\n",
+                entries.size(), solvable, outPath, secs);
+    return 0;
+}
@@ -0,0 +1,231 @@
+// Generate "find the top-scoring move" puzzles (see PuzzlePack.h).
+//
+// Usage: equatix-puzzles [--count N] [--seed S] [--threads T] [--margin PCT]
+//                        [--min-moves M] [--plies MIN MAX] OUTPUT
+//        equatix-puzzles --show PACK [INDEX]
+//
+// Each attempt self-plays a game from its own seed, choosing at random among
+// the few best moves so boards look like real play. Self-play solves every
+// position with MoveGenerator anyway, so each one from ply MIN to MAX is
+// vetted on the way: it needs at least M legal moves, a single move with the
+// best score, and that score PCT percent above the next best. Attempts are
+// numbered and the pack keeps the first N puzzles in attempt and ply order,
+// so the output depends on the seed and not on the thread count.
+
+#include "GameState.h"
+#include "MappedFile.h"
+#include "MoveGenerator.h"
+#include "PuzzlePack.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int count = 1000;
+    uint64_t seed = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int margin = 10;
+    int minMoves = 20;
+    int minPly = 6;
+    int maxPly = 30;
+};
+
+constexpr int kTopChoices = 4;  // self-play picks among this many best moves
+
+struct Candidate {
+    uint64_t attempt;
+    PuzzleEntry entry;
+};
+
+uint64_t splitmix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// Whether the position passes; fills the entry if so.
+bool vet(const Options& opt, const GameState& game, const std::vector<Move>& moves, int ply, PuzzleEntry& e) {
+    if (int(moves.size()) < opt.minMoves) return false;
+    const Move *best = nullptr;
+    int runnerUp = -1;
+    for (const Move &m : moves) {
+        if (!best || m.score > best->score) {
+            if (best) runnerUp = best->score;
+            best = &m;
+        } else {
+            runnerUp = std::max(runnerUp, m.score);
+        }
+    }
+    if (best->score <= runnerUp || best->score * 100 < runnerUp * (100 + opt.margin)) return false;
+
+    e = PuzzleEntry {};
+    e.position = game.positionHash();
+    e.score = uint16_t(best->score);
+    e.runnerUp = uint16_t(runnerUp);
+    e.moveCount = uint16_t(std::min<size_t>(moves.size(), UINT16_MAX));
+    e.ply = uint8_t(ply);
+    e.solutionCount = uint8_t(best->count);
+    int n = 0;
+    const int *rack = game.rack(game.currentPlayer());
+    for (int s = 0; s < GameRules::SymbolCount; ++s)
+        for (int k = 0; k < rack[s] && n < GameRules::MaxRackTiles; ++k) e.rack[n++] = GameRules::symbolChar(s);
+    for (int i = 0; i < best->count; ++i) {
+        const TilePlacement &t = best->tiles[i];
+        e.solution[i][0] = uint8_t(t.row * GameRules::BoardSize + t.col);
+        e.solution[i][1] = uint8_t(t.ch);
+    }
+    PuzzlePack::packBoard(game.board(), e);
+    return true;
+}
+
+// Self-plays one game, appending the positions that pass.
+void attempt(const Options& opt, uint64_t index, std::vector<Candidate>& out) {
+    std::mt19937_64 rng(splitmix(opt.seed ^ splitmix(index)));
+    GameState game(rng());
+    std::vector<Move> moves;
+    Candidate c;
+    c.attempt = index;
+    for (int ply = 0; ply <= opt.maxPly; ++ply) {
+        moves = MoveGenerator(game).all();
+        if (ply >= opt.minPly && vet(opt, game, moves, ply, c.entry)) out.push_back(c);
+        if (ply == opt.maxPly) return;
+
+        if (moves.empty()) {
+            // Swap the whole rack, as a stuck player would
+            char tiles[GameRules::MaxRackTiles];
+            int n = 0;
+            const int *rack = game.rack(game.currentPlayer());
+            for (int s = 0; s < GameRules::OtherSymbolCount; ++s)
+                for (int k = 0; k < rack[s]; ++k) tiles[n++] = GameRules::symbolChar(s);
+            if (!game.swap(tiles, std::min(n, game.bag().otherTilesCount()))) return;
+            continue;
+        }
+        int top = std::min<int>(kTopChoices, int(moves.size()));
+        std::partial_sort(moves.begin(), moves.begin() + top, moves.end(),
+                          [](const Move& a, const Move& b) { return a.score > b.score; });
+        // Best move half the time, otherwise one of the next few
+        int pick = rng() % 2 ? 0 : int(rng() % uint64_t(top));
+        RuleCheck check;
+        int points;
+        if (!game.place(moves[size_t(pick)].tiles, moves[size_t(pick)].count, check, points)) return;
+    }
+}
+
+int show(const char* path, int only) {
+    MappedFile f;
+    PuzzlePack pack;
+    if (!f.open(path) || !pack.attach(f.data(), f.size())) {
+        std::fprintf(stderr, "%s: not a puzzle pack\n", path);
+        return 1;
+    }
+    std::printf("%u puzzles\n", pack.size());
+    for (uint32_t i = 0; i < pack.size(); ++i) {
+        if (only >= 0 && i != uint32_t(only)) continue;
+        const PuzzleEntry &e = pack[i];
+        std::printf("\n#%u  ply %d, rack %.*s, %d moves, best %d, next %d\n", i, e.ply,
+                    int(strnlen(e.rack, sizeof e.rack)), e.rack, e.moveCount, e.score, e.runnerUp);
+        for (int r = 0; r < GameRules::BoardSize; ++r) {
+            std::printf("  ");
+            for (int c = 0; c < GameRules::BoardSize; ++c) {
+                char ch = PuzzlePack::cell(e, r * GameRules::BoardSize + c);
+                std::putchar(ch ? ch : '.');
+            }
+            std::putchar('\n');
+        }
+        std::printf("  solution:");
+        for (int k = 0; k < e.solutionCount; ++k)
+            std::printf(" %c@%d,%d", e.solution[k][1], e.solution[k][0] / GameRules::BoardSize,
+                        e.solution[k][0] % GameRules::BoardSize);
+        std::putchar('\n');
+    }
+    return 0;
+}
+
+int usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "usage: %s [--count N] [--seed S] [--threads T] [--margin PCT]\n"
+                 "          [--min-moves M] [--plies MIN MAX] OUTPUT\n"
+                 "       %s --show PACK [INDEX]\n", argv0, argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && std::strcmp(argv[1], "--show") == 0)
+        return show(argv[2], argc > 3 ? std::atoi(argv[3]) : -1);
+
+    Options opt;
+    const char* outPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) opt.count = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) opt.seed = std::strtoull(argv[++i], nullptr, 0);
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) opt.threads = unsigned(std::max(1, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--margin") == 0 && i + 1 < argc) opt.margin = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--min-moves") == 0 && i + 1 < argc) opt.minMoves = std::max(2, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--plies") == 0 && i + 2 < argc) {
+            opt.minPly = std::clamp(std::atoi(argv[++i]), 1, 200);
+            opt.maxPly = std::clamp(std::atoi(argv[++i]), opt.minPly, 200);
+        }
+        else if (argv[i][0] != '-' && !outPath) outPath = argv[i];
+        else return usage(argv[0]);
+    }
+    if (!outPath) return usage(argv[0]);
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::atomic<uint64_t> next{0};
+    std::atomic<int> accepted{0};
+    std::mutex lock;
+    std::vector<Candidate> found;
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < opt.threads; ++t) {
+        pool.emplace_back([&] {
+            std::vector<Candidate> mine;
+            // Every attempt below the last one claimed finishes, so the
+            // first count accepted are the same whatever the timing
+            while (accepted.load(std::memory_order_relaxed) < opt.count) {
+                size_t before = mine.size();
+                attempt(opt, next++, mine);
+                accepted += int(mine.size() - before);
+            }
+            std::lock_guard<std::mutex> g(lock);
+            found.insert(found.end(), mine.begin(), mine.end());
+        });
+    }
+    for (auto &th : pool) th.join();
+
+    std::sort(found.begin(), found.end(), [](const Candidate& a, const Candidate& b) {
+        return a.attempt != b.attempt ? a.attempt < b.attempt : a.entry.ply < b.entry.ply;
+    });
+    found.resize(size_t(opt.count));
+
+    PuzzlePackHeader h {};
+    std::memcpy(h.magic, "EQXPUZZ1", 8);
+    h.version = PuzzlePack::Version;
+    h.count = uint32_t(found.size());
+    std::ofstream out(outPath, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    for (const Candidate &c : found) out.write(reinterpret_cast<const char*>(&c.entry), sizeof c.entry);
+    if (!out) {
+        std::fprintf(stderr, "failed to write %s\n", outPath);
+        return 1;
+    }
+
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    uint64_t games = next.load();
+    std::printf("%d puzzles from %llu games written to %s in %.1f s, %.0f puzzles/min on %u threads\n",
+                opt.count, (unsigned long long)games, outPath, secs, double(opt.count) / secs * 60.0, opt.threads);
+    return 0;
+}
@@ -0,0 +1,249 @@
+// Per-call cost of the C interface (EquatixApi.h) as an embedding service sees it.
+//
+// Usage: equatix-capibench [--positions N] [--repeat R] [--threads T] [--seed S]
+//
+// Self-plays N mid-game positions, loads each into the library from its saved
+// state and takes every legal move in it from MoveGenerator. Then times, in
+// ns per call:
+//   call      eqx_current_player, the cost of crossing into the library
+//   validate  eqx_validate of each move
+//   direct    GameState::evaluate of the same moves, without the C layer
+//   restore   eqx_game_restore
+//   apply     eqx_apply of each move, after a restore not counted
+//   save      eqx_game_save
+// Every score must match MoveGenerator's. malloc is watched during the timed
+// loops (glibc only) and any allocation fails the run. With --threads T the
+// validate loop also runs on T threads at once, each on its own games.
+
+#include "EquatixApi.h"
+#include "GameState.h"
+#include "MoveGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+// The library allocates through the same malloc, so counting here covers it
+std::atomic<bool> g_watchHeap{false};
+std::atomic<long> g_heapCalls{0};
+
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+
+void* malloc(size_t n) {
+    if (g_watchHeap.load(std::memory_order_relaxed)) ++g_heapCalls;
+    return __libc_malloc(n);
+}
+void* calloc(size_t n, size_t size) {
+    if (g_watchHeap.load(std::memory_order_relaxed)) ++g_heapCalls;
+    return __libc_calloc(n, size);
+}
+void* realloc(void* p, size_t n) {
+    if (g_watchHeap.load(std::memory_order_relaxed)) ++g_heapCalls;
+    return __libc_realloc(p, n);
+}
+}
+#endif
+
+namespace {
+
+// A move as a caller of the C interface holds it
+struct CallMove {
+    int count;
+    int rows[GameRules::MaxRackTiles];
+    int cols[GameRules::MaxRackTiles];
+    char symbols[GameRules::MaxRackTiles];
+    int score;
+    Move move;
+};
+
+struct Position {
+    GameState game{0};
+    unsigned char state[EQX_STATE_SIZE];
+    std::vector<CallMove> moves;
+};
+
+// Mid-game positions with plenty of moves, from greedy self-play.
+std::vector<Position> makePositions(int count, uint64_t seed) {
+    std::vector<Position> out;
+    std::mt19937_64 rng(seed);
+    while (int(out.size()) < count) {
+        Position p;
+        p.game = GameState(rng());
+        int plies = 4 + int(rng() % 16);
+        for (int ply = 0; ply < plies; ++ply) {
+            Move m;
+            RuleCheck check;
+            int points;
+            if (!MoveGenerator(p.game).best(m) || !p.game.place(m.tiles, m.count, check, points)) break;
+        }
+        GameSnapshot snapshot;
+        if (!p.game.save(snapshot)) continue;
+        std::memcpy(p.state, &snapshot, sizeof p.state);
+        for (const Move &m : MoveGenerator(p.game).all()) {
+            CallMove c;
+            c.count = m.count;
+            for (int t = 0; t < m.count; ++t) {
+                c.rows[t] = m.tiles[t].row;
+                c.cols[t] = m.tiles[t].col;
+                c.symbols[t] = m.tiles[t].ch;
+            }
+            c.score = m.score;
+            c.move = m;
+            p.moves.push_back(c);
+        }
+        if (p.moves.size() >= 20) out.push_back(std::move(p));
+    }
+    return out;
+}
+
+double nowNs() {
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int positions = 40, repeat = 200;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--positions") == 0 && i + 1 < argc) positions = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) repeat = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = unsigned(std::max(1, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 0);
+        else {
+            std::fprintf(stderr, "usage: %s [--positions N] [--repeat R] [--threads T] [--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (eqx_abi_version() != EQX_ABI_VERSION) {
+        std::fprintf(stderr, "library ABI %d, header %d\n", eqx_abi_version(), EQX_ABI_VERSION);
+        return 1;
+    }
+
+    std::vector<Position> all = makePositions(positions, seed);
+    std::vector<eqx_game*> games;
+    size_t moves = 0;
+    for (const Position &p : all) {
+        games.push_back(eqx_game_load(p.state, sizeof p.state));
+        moves += p.moves.size();
+    }
+    std::printf("%zu positions, %zu moves, %d repeats\n\n", all.size(), moves, repeat);
+
+    int mismatches = 0;
+    volatile int sink = 0;
+    double callNs = 0, validateNs = 0, directNs = 0, restoreNs = 0, applyNs = 0, saveNs = 0;
+    unsigned char saved[EQX_STATE_SIZE];
+    g_watchHeap = true;
+    for (size_t i = 0; i < all.size(); ++i) {
+        Position &p = all[i];
+        eqx_game *g = games[i];
+
+        double t0 = nowNs();
+        for (int r = 0; r < repeat; ++r)
+            for (size_t m = 0; m < p.moves.size(); ++m) sink = sink + eqx_current_player(g);
+        callNs += nowNs() - t0;
+
+        t0 = nowNs();
+        for (int r = 0; r < repeat; ++r)
+            for (const CallMove &c : p.moves) {
+                eqx_result result;
+                eqx_validate(g, c.rows, c.cols, c.symbols, c.count, &result);
+                if (r == 0) mismatches += result.error != EQX_OK || result.score != c.score;
+            }
+        validateNs += nowNs() - t0;
+
+        t0 = nowNs();
+        for (int r = 0; r < repeat; ++r)
+            for (const CallMove &c : p.moves) {
+                RuleCheck check;
+                int points;
+                p.game.evaluate(c.move.tiles, c.count, check, points);
+                sink = sink + points;
+            }
+        directNs += nowNs() - t0;
+
+        t0 = nowNs();
+        for (int r = 0; r < repeat; ++r)
+            for (size_t m = 0; m < p.moves.size(); ++m) eqx_game_restore(g, p.state, sizeof p.state);
+        double restore = nowNs() - t0;
+        restoreNs += restore;
+
+        t0 = nowNs();
+        for (int r = 0; r < repeat; ++r)
+            for (const CallMove &c : p.moves) {
+                eqx_game_restore(g, p.state, sizeof p.state);
+                eqx_result result;
+                eqx_apply(g, c.rows, c.cols, c.symbols, c.count, &result);
+                if (r == 0) mismatches += result.error != EQX_OK || result.score != c.score;
+            }
+        applyNs += nowNs() - t0 - restore;
+        eqx_game_restore(g, p.state, sizeof p.state);
+
+        t0 = nowNs();
+        for (int r = 0; r < repeat; ++r)
+            for (size_t m = 0; m < p.moves.size(); ++m) eqx_game_save(g, saved, sizeof saved);
+        saveNs += nowNs() - t0;
+        mismatches += std::memcmp(saved, p.state, sizeof saved) != 0;
+    }
+    g_watchHeap = false;
+    long heapCalls = g_heapCalls;
+
+    double n = double(moves) * repeat;
+    std::printf("%-10s %10s\n", "function", "ns/call");
+    std::printf("%-10s %10.2f\n", "call", callNs / n);
+    std::printf("%-10s %10.2f\n", "validate", validateNs / n);
+    std::printf("%-10s %10.2f\n", "direct", directNs / n);
+    std::printf("%-10s %10.2f\n", "restore", restoreNs / n);
+    std::printf("%-10s %10.2f\n", "apply", applyNs / n);
+    std::printf("%-10s %10.2f\n", "save", saveNs / n);
+
+    if (threads > 1) {
+        // Each thread validates on games of its own, loaded before the clock starts
+        std::atomic<int> threadMismatches{0};
+        std::vector<std::vector<eqx_game*>> own(threads);
+        for (auto &list : own)
+            for (const Position &p : all) list.push_back(eqx_game_load(p.state, sizeof p.state));
+        double t0 = nowNs();
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; ++t)
+            pool.emplace_back([&, t] {
+                for (int r = 0; r < repeat; ++r)
+                    for (size_t i = 0; i < all.size(); ++i)
+                        for (const CallMove &c : all[i].moves)
+                            if (eqx_score(own[t][i], c.rows, c.cols, c.symbols, c.count) != c.score) ++threadMismatches;
+            });
+        for (auto &th : pool) th.join();
+        double wall = nowNs() - t0;
+        std::printf("\n%u threads: %.2f ns/validate per thread, %.1f M validates/s\n",
+                    threads, wall / n, n * threads / wall * 1e3);
+        mismatches += threadMismatches;
+        for (auto &list : own)
+            for (eqx_game *g : list) eqx_game_destroy(g);
+    }
+    for (eqx_game *g : games) eqx_game_destroy(g);
+
+    int failed = 0;
+#ifdef __GLIBC__
+    std::printf("\nheap allocations in timed calls: %ld\n", heapCalls);
+    failed |= heapCalls != 0;
+#else
+    (void)heapCalls;
+#endif
+    if (mismatches) {
+        std::printf("\n%d results differ from MoveGenerator\n", mismatches);
+        failed = 1;
+    }
+    return failed;
+}
@@ -0,0 +1,376 @@
+// Interactive latency benchmark for the GUI.
+//
+// Usage: equatix-guibench [--turns N] [--resizes N] [--startups N] [--json PATH]
+//
+// Drives a real MainWindow under the offscreen platform (set unless
+// QT_QPA_PLATFORM says otherwise) and times what a player waits for:
+//   startup          MainWindow (one table) constructed and shown -> first board paint
+//   drop_to_paint    tile dropped on the board -> board repainted
+//   validate_to_rack "Validate Turn" -> next player's rack enabled and painted
+//   swap_open        "Swap Tiles" -> dialog painted
+//   swap_close       dialog accepted -> next player's rack painted
+//   resize           window resized with a full board -> board repainted
+// Moves come from MoveGenerator, so every turn is legal. Before each one is
+// validated, the validate path is also run on a copy of the game with malloc
+// watched (glibc only): any heap allocation there fails the run. Results are
+// written as JSON (stdout by default) for comparison between builds.
+
+#include "mainwindow.h"
+#include "GameTab.h"
+#include "BoardView.h"
+#include "EquationValidator.h"
+#include "GameMetrics.h"
+#include "RackView.h"
+#include "SwapDialog.h"
+#include "MoveGenerator.h"
+
+#include <QAction>
+#include <QApplication>
+#include <QCheckBox>
+#include <QDir>
+#include <QDropEvent>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMessageBox>
+#include <QMimeData>
+#include <QPointer>
+#include <QStandardPaths>
+#include <QTableWidgetItem>
+#include <QTest>
+#include <QTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+// Qt containers allocate with malloc directly, so count there rather than in
+// operator new. glibc keeps its allocator reachable under __libc_ names.
+std::atomic<bool> g_watchHeap{false};
+std::atomic<long> g_heapCalls{0};
+
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+
+void* malloc(size_t n) {
+    if (g_watchHeap.load(std::memory_order_relaxed)) ++g_heapCalls;
+    return __libc_malloc(n);
+}
+void* calloc(size_t n, size_t size) {
+    if (g_watchHeap.load(std::memory_order_relaxed)) ++g_heapCalls;
+    return __libc_calloc(n, size);
+}
+void* realloc(void* p, size_t n) {
+    if (g_watchHeap.load(std::memory_order_relaxed)) ++g_heapCalls;
+    return __libc_realloc(p, n);
+}
+}
+#endif
+
+namespace {
+
+constexpr int kPaintTimeoutMs = 2000;
+
+// Notes the first paint event reaching a widget or any of its children, or
+// with armForDialogs any widget in a dialog that does not exist yet
+class PaintProbe : public QObject {
+public:
+    void arm(QWidget* w) {
+        disarm();
+        m_watched.append(w);
+        for (QWidget *child : w->findChildren<QWidget*>()) m_watched.append(child);
+        for (QWidget *x : m_watched) x->installEventFilter(this);
+    }
+    void armForDialogs() {
+        disarm();
+        m_dialogs = true;
+        qApp->installEventFilter(this);
+    }
+    void disarm() {
+        for (QWidget *x : m_watched)
+            if (x) x->removeEventFilter(this);
+        m_watched.clear();
+        if (m_dialogs) qApp->removeEventFilter(this);
+        m_dialogs = false;
+        m_seen = false;
+    }
+    bool seen() const { return m_seen; }
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* e) override {
+        if (e->type() != QEvent::Paint) return false;
+        if (!m_dialogs || (obj->isWidgetType() && qobject_cast<QDialog*>(static_cast<QWidget*>(obj)->window())))
+            m_seen = true;
+        return false;
+    }
+
+private:
+    QList<QPointer<QWidget>> m_watched;
+    bool m_dialogs = false;
+    bool m_seen = false;
+};
+
+struct Series {
+    std::vector<double> us;
+    void add(const QElapsedTimer& t) { us.push_back(double(t.nsecsElapsed()) / 1000.0); }
+};
+
+std::map<std::string, Series> g_series;
+int g_timeouts = 0;
+int g_dismissed = 0;
+long g_validateAllocs = 0;  // most heap allocations seen in one validation
+int g_validateChecks = 0;
+
+// Spin the event loop until the probe fires; the paint has completed when
+// processEvents returns. Busy-waits rather than sleeping so the timings are
+// not rounded up to the sleep quantum.
+bool waitForPaint(PaintProbe& probe) {
+    QElapsedTimer limit;
+    limit.start();
+    while (!probe.seen()) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents);
+        if (limit.elapsed() > kPaintTimeoutMs) {
+            ++g_timeouts;
+            probe.disarm();
+            return false;
+        }
+    }
+    QCoreApplication::processEvents(QEventLoop::AllEvents);
+    probe.disarm();
+    return true;
+}
+
+QAction* findAction(QWidget* w, const QString& text) {
+    for (QAction *a : w->findChildren<QAction*>())
+        if (a->text() == text) return a;
+    return nullptr;
+}
+
+QString autosavePath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/autosave.eqxj";
+}
+
+void dropTile(BoardView* board, int r, int c, char ch) {
+    QMimeData mime;
+    mime.setData("application/x-equatix-tile", QByteArray(1, ch));
+    QPointF pos = board->visualRect(board->model()->index(r, c)).center();
+    QDropEvent drop(pos, Qt::MoveAction, &mime, Qt::LeftButton, Qt::NoModifier);
+    QCoreApplication::sendEvent(board->viewport(), &drop);
+}
+
+// The board as the rules see it, read back from the widgets
+void readBoard(BoardView* board, char* cells, bool* used) {
+    const int N = GameRules::BoardSize;
+    for (int r = 0; r < N; ++r) {
+        for (int c = 0; c < N; ++c) {
+            QTableWidgetItem *it = board->item(r, c);
+            cells[r*N + c] = it && !it->text().isEmpty() ? it->text().at(0).toLatin1() : '\0';
+            used[r*N + c] = board->multiplierUsedAt(r, c);
+        }
+    }
+}
+
+// The validate path GameTab runs, on the tiles just dropped, against a copy of
+// its game. The first call sets up per-thread trace and metrics state, so it
+// is not counted.
+void watchValidation(GameTab* tab) {
+    static TurnInput turn;
+    GameState game = tab->game();   // copied before watching
+    RuleCheck check;
+    int points = 0;
+    g_heapCalls = 0;
+    g_watchHeap = g_validateChecks > 0;
+    EquationValidator::capture(*tab->board(), turn);
+    bool ok = game.place(turn.tiles, turn.count, check, points);
+    GameMetrics::recordValidation(check);
+    g_watchHeap = false;
+    if (ok && g_validateChecks++ > 0) g_validateAllocs = std::max(g_validateAllocs, g_heapCalls.load());
+}
+
+bool playMove(MainWindow& w, GameTab* tab, RackView* rack, RackView* next) {
+    BoardView *board = tab->board();
+    char cells[GameRules::CellCount];
+    bool used[GameRules::CellCount];
+    readBoard(board, cells, used);
+    Move m;
+    if (!MoveGenerator(cells, used, rack->model().counts()).best(m)) return false;
+
+    PaintProbe probe;
+    QElapsedTimer t;
+    for (int i = 0; i < m.count; ++i) {
+        const TilePlacement &p = m.tiles[i];
+        rack->removeTiles({QChar::fromLatin1(p.ch)});   // a real drag takes it off the rack
+        probe.arm(board->viewport());
+        t.start();
+        dropTile(board, p.row, p.col, p.ch);
+        if (waitForPaint(probe)) g_series["drop_to_paint"].add(t);
+    }
+
+    watchValidation(tab);
+    probe.arm(next);
+    t.start();
+    findAction(&w, "Validate Turn")->trigger();
+    if (next->isEnabled() && waitForPaint(probe)) g_series["validate_to_rack"].add(t);
+    return true;
+}
+
+bool swapOne(MainWindow& w, RackView* rack, RackView* next) {
+    if (rack->countNonEqualsTiles() == 0) return false;
+    PaintProbe probe;
+    QElapsedTimer t;
+    bool accepted = false;
+
+    // Runs inside the dialog's exec() loop
+    std::function<void()> driveDialog = [&] {
+        auto *dlg = qobject_cast<SwapDialog*>(QApplication::activeModalWidget());
+        if (!dlg) {
+            QTimer::singleShot(0, driveDialog);
+            return;
+        }
+        if (waitForPaint(probe)) g_series["swap_open"].add(t);
+        QList<QCheckBox*> boxes = dlg->findChildren<QCheckBox*>();
+        if (!boxes.isEmpty()) boxes.first()->setChecked(true);
+        probe.arm(next);
+        t.start();
+        accepted = true;
+        dlg->accept();
+    };
+
+    probe.armForDialogs();
+    t.start();
+    QTimer::singleShot(0, driveDialog);
+    findAction(&w, "Swap Tiles")->trigger();
+    if (accepted && next->isEnabled() && waitForPaint(probe)) g_series["swap_close"].add(t);
+    return accepted;
+}
+
+MainWindow* openWindow(bool record) {
+    QFile::remove(autosavePath());
+    PaintProbe probe;
+    QElapsedTimer t;
+    t.start();
+    auto *w = new MainWindow;
+    w->resize(1000, 900);
+    probe.arm(w);
+    w->show();
+    if (waitForPaint(probe) && record) g_series["startup"].add(t);
+    QTest::qWaitForWindowExposed(w);
+    return w;
+}
+
+void writeJson(std::FILE* out, qint64 firstFrameUs) {
+    std::fprintf(out, "{\n  \"platform\": \"%s\",\n  \"qt\": \"%s\",\n",
+                 qPrintable(QGuiApplication::platformName()), qVersion());
+    std::fprintf(out, "  \"cold_start_to_first_frame_us\": %lld,\n", (long long)firstFrameUs);
+    std::fprintf(out, "  \"validate_heap_allocs\": %ld,\n  \"validations_watched\": %d,\n",
+                 g_validateAllocs, std::max(0, g_validateChecks - 1));
+    std::fprintf(out, "  \"timeouts\": %d,\n  \"dialogs_dismissed\": %d,\n  \"latency_us\": {", g_timeouts, g_dismissed);
+    const char *sep = "\n";
+    for (auto &[name, s] : g_series) {
+        std::vector<double> v = s.us;
+        if (v.empty()) continue;
+        std::sort(v.begin(), v.end());
+        auto at = [&](double q) { return v[size_t(q * double(v.size() - 1))]; };
+        double sum = 0;
+        for (double x : v) sum += x;
+        std::fprintf(out, "%s    \"%s\": {\"n\": %zu, \"mean\": %.1f, \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+                     sep, name.c_str(), v.size(), sum / double(v.size()), at(0.5), at(0.9), at(0.99), v.back());
+        sep = ",\n";
+    }
+    std::fprintf(out, "\n  }\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QElapsedTimer sinceMain;
+    sinceMain.start();
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    int turns = 40, resizes = 30, startups = 5;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--turns") == 0 && i + 1 < argc) turns = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--resizes") == 0 && i + 1 < argc) resizes = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--startups") == 0 && i + 1 < argc) startups = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--turns N] [--resizes N] [--startups N] [--json PATH]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    QApplication app(argc, argv);
+    QStandardPaths::setTestModeEnabled(true);   // keep away from a real autosave
+    QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+
+    // Anything modal other than the swap dialog would stall the run
+    QTimer guard;
+    QObject::connect(&guard, &QTimer::timeout, [] {
+        if (auto *box = qobject_cast<QMessageBox*>(QApplication::activeModalWidget())) {
+            ++g_dismissed;
+            box->accept();
+        }
+    });
+    guard.start(100);
+
+    // The first window also pays for fonts, styles and the platform plugin
+    MainWindow *w = openWindow(false);
+    qint64 firstFrameUs = sinceMain.nsecsElapsed() / 1000;
+    for (int i = 1; i < startups; ++i) {
+        delete w;
+        w = openWindow(true);
+    }
+
+    GameTab *tab = w->findChild<GameTab*>();
+    BoardView *board = tab ? tab->board() : nullptr;
+    QList<RackView*> racks = w->findChildren<RackView*>();
+    if (!board || racks.size() != 2) {
+        std::fprintf(stderr, "unexpected window layout\n");
+        return 1;
+    }
+
+    for (int turn = 0; turn < turns; ++turn) {
+        int p = racks[0]->isEnabled() ? 0 : 1;
+        RackView *rack = racks[p], *next = racks[1 - p];
+        // Every fifth turn swaps, as does any turn without a legal move
+        bool played = turn % 5 != 4 && playMove(*w, tab, rack, next);
+        if (!played && !swapOne(*w, rack, next)) break;
+    }
+
+    // Fill the rest of the board, then resize through a few window sizes
+    for (int r = 0; r < GameRules::BoardSize; ++r)
+        for (int c = 0; c < GameRules::BoardSize; ++c)
+            if (!board->item(r, c)) board->restoreLockedTile(r, c, QChar::fromLatin1(char('1' + (r + c) % 9)));
+    const QSize sizes[] = {{1000, 900}, {1280, 1024}, {800, 700}, {1600, 1200}, {900, 1000}};
+    PaintProbe probe;
+    for (int i = 0; i < resizes; ++i) {
+        probe.arm(board->viewport());
+        QElapsedTimer t;
+        t.start();
+        w->resize(sizes[i % std::size(sizes)]);
+        if (waitForPaint(probe)) g_series["resize"].add(t);
+    }
+
+    delete w;
+    QFile::remove(autosavePath());
+
+    std::FILE *out = jsonPath ? std::fopen(jsonPath, "w") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "%s: cannot open\n", jsonPath);
+        return 1;
+    }
+    writeJson(out, firstFrameUs);
+    if (out != stdout) std::fclose(out);
+    if (g_validateAllocs) std::fprintf(stderr, "validation allocated on the heap (%ld calls)\n", g_validateAllocs);
+    return g_timeouts || g_validateAllocs ? 1 : 0;
+}
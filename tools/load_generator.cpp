@@ -0,0 +1,766 @@
+// Load generator for equatix-server.
+//
+// Usage: equatix-loadgen [--unix PATH | --port N] [--spawn SERVER | --server-pid PID]
+//                        [--games N] [--max-games M] [--threads T]
+//                        [--duration S] [--warmup S] [--think-ms MS] [--slo-ms MS]
+//                        [--plies N] [--candidates K] [--seed S] [--hgrm PREFIX]
+//
+// Each game is two simulated players on their own connections. A player waits
+// a log-normal think time (median --think-ms), fetches the state, picks the
+// best of the first K legal moves from MoveGenerator and plays it, or swaps
+// when it has none. After --plies moves both players disconnect and the table
+// starts a new game, so the number of live games stays at the level. A table
+// that cannot connect tries again after 10 ms, doubling up to about 1.3 s;
+// these connect failures are reported apart from errors.
+//
+// With --max-games the level doubles from --games until the server saturates:
+// moves/s stops growing with the games (below 85% of linear) or the p99 of
+// a move exceeds --slo-ms. Server CPU and resident memory come from /proc
+// for --spawn or --server-pid. --hgrm writes one percentile file per level
+// and operation for the HdrHistogram plotters.
+
+#include "LatencyHistogram.h"
+#include "MoveGenerator.h"
+#include "ServerProtocol.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <queue>
+#include <random>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+constexpr uint32_t kWakeTag = UINT32_MAX;
+
+// Round trips to the server, plus the client's own move search (queueing
+// included) so a load generator that cannot keep up is visible.
+enum Op { OpConnect, OpCreate, OpJoin, OpState, OpPlace, OpSwap, OpSearch, OpCount };
+const char* const kOpNames[OpCount] = {"connect", "create", "join", "state", "place", "swap", "search"};
+
+struct Options {
+    const char* unixPath = nullptr;
+    int port = 7415;
+    const char* spawn = nullptr;
+    int serverPid = 0;
+    int games = 100;
+    int maxGames = 0;
+    int threads = 0;
+    double duration = 10;
+    double warmup = 2;
+    double thinkMs = 1500;
+    double sloMs = 50;
+    int plies = 40;
+    int candidates = 16;
+    uint64_t seed = 1;
+    const char* hgrm = nullptr;
+};
+
+struct Stats {
+    LatencyHistogram ops[OpCount];
+    uint64_t moves = 0;         // accepted places and swaps
+    uint64_t rejected = 0;      // moves the server refused
+    uint64_t errors = 0;        // Error replies and lost connections
+    uint64_t connectFailures = 0;   // refused or out of descriptors; retried
+    uint64_t gamesFinished = 0;
+
+    void merge(const Stats& o) {
+        for (int i = 0; i < OpCount; ++i) ops[i].merge(o.ops[i]);
+        moves += o.moves;
+        rejected += o.rejected;
+        errors += o.errors;
+        connectFailures += o.connectFailures;
+        gamesFinished += o.gamesFinished;
+    }
+};
+
+int connectServer(const Options& opt) {
+    int fd;
+    if (opt.unixPath) {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::snprintf(addr.sun_path, sizeof addr.sun_path, "%s", opt.unixPath);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+            ::close(fd);
+            return -1;
+        }
+    } else {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(uint16_t(opt.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    }
+    if (fd >= 0) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+// One event loop driving a share of the tables.
+class Worker {
+public:
+    Worker(const Options& opt, int tables, uint64_t seed)
+        : m_opt(opt), m_tables(size_t(tables)), m_rng(seed) {}
+
+    ~Worker() {
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            m_quit = true;
+        }
+        m_jobReady.notify_one();
+        if (m_thinker.joinable()) m_thinker.join();
+        for (Table &t : m_tables) closeTable(t);
+        if (m_wake >= 0) ::close(m_wake);
+        if (m_epoll >= 0) ::close(m_epoll);
+    }
+
+    void run(const std::atomic<bool>& stop, const std::atomic<bool>& measuring) {
+        m_measuring = &measuring;
+        m_epoll = epoll_create1(EPOLL_CLOEXEC);
+        m_wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event ev {};
+        ev.events = EPOLLIN;
+        ev.data.u32 = kWakeTag;
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wake, &ev);
+        m_thinker = std::thread([this] { think(); });
+        for (size_t i = 0; i < m_tables.size(); ++i) startGame(int(i));
+
+        epoll_event events[256];
+        while (!stop.load(std::memory_order_relaxed)) {
+            int timeout = 100;
+            if (!m_timers.empty()) {
+                auto wait = std::chrono::ceil<std::chrono::milliseconds>(m_timers.top().at - Clock::now()).count();
+                timeout = int(std::max<long long>(0, std::min<long long>(wait, timeout)));
+            }
+            int n = epoll_wait(m_epoll, events, 256, timeout);
+            for (int i = 0; i < n; ++i) {
+                if (events[i].data.u32 == kWakeTag) onDecisions();
+                else onReadable(int(events[i].data.u32));
+            }
+            for (auto now = Clock::now(); !m_timers.empty() && m_timers.top().at <= now;) {
+                Timer t = m_timers.top();
+                m_timers.pop();
+                Table &table = m_tables[size_t(t.seatKey / 2)];
+                if (t.generation != table.generation) continue;
+                if (t.reconnect) startGame(t.seatKey / 2);
+                else request(t.seatKey, OpState);
+            }
+        }
+    }
+
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct Seat {
+        int fd = -1;
+        std::vector<uint8_t> in;
+        Op pending = OpCount;
+        Clock::time_point sent;
+    };
+
+    struct Table {
+        Seat seats[2];
+        uint32_t game = 0;
+        int plies = 0;
+        int passes = 0;
+        uint32_t generation = 0;
+        int connectFailures = 0;    // in a row, for the retry backoff
+    };
+
+    struct Job {
+        int seatKey = 0;
+        uint32_t generation = 0;
+        uint32_t game = 0;
+        int bag = 0;
+        int rack[GameRules::SymbolCount] = {};
+        char board[GameRules::CellCount] = {};
+        Clock::time_point received;
+        bool found = false;
+        Move move;
+    };
+
+    struct Timer {
+        Clock::time_point at;
+        int seatKey;
+        uint32_t generation;
+        bool reconnect = false;     // start the table's game again
+        bool operator<(const Timer& o) const { return at > o.at; }
+    };
+
+    bool measuring() const { return m_measuring->load(std::memory_order_relaxed); }
+
+    void startGame(int index) {
+        Table &t = m_tables[size_t(index)];
+        t.plies = 0;
+        t.passes = 0;
+        for (int s = 0; s < 2; ++s) {
+            auto t0 = Clock::now();
+            int fd = connectServer(m_opt);
+            if (fd < 0) {
+                retryGame(index);
+                return;
+            }
+            if (measuring()) m_stats.ops[OpConnect].record(uint64_t((Clock::now() - t0).count()));
+            t.seats[s].fd = fd;
+            t.seats[s].in.clear();
+            t.seats[s].pending = OpCount;
+            epoll_event ev {};
+            ev.events = EPOLLIN;
+            ev.data.u32 = uint32_t(index * 2 + s);
+            epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev);
+        }
+        t.connectFailures = 0;
+        request(index * 2, OpCreate);
+    }
+
+    // Connecting fails near saturation (full backlog, no descriptors), so the
+    // table tries again with backoff rather than lowering the offered load.
+    void retryGame(int index) {
+        Table &t = m_tables[size_t(index)];
+        ++m_stats.connectFailures;
+        closeTable(t);
+        int shift = std::min(t.connectFailures++, 7);
+        auto delay = std::chrono::milliseconds((10 << shift) + int(m_rng() % 10));
+        m_timers.push({Clock::now() + delay, index * 2, t.generation, true});
+    }
+
+    void closeTable(Table& t) {
+        ++t.generation;
+        for (Seat &s : t.seats) {
+            if (s.fd >= 0) ::close(s.fd);
+            s.fd = -1;
+        }
+    }
+
+    void endGame(int index, bool finished) {
+        if (finished) ++m_stats.gamesFinished;
+        closeTable(m_tables[size_t(index)]);
+        startGame(index);
+    }
+
+    void thinkThenMove(int seatKey) {
+        const Table &t = m_tables[size_t(seatKey / 2)];
+        double ms = 0;
+        if (m_opt.thinkMs > 0) ms = m_opt.thinkMs * std::exp(0.6 * m_normal(m_rng));
+        auto at = Clock::now() + std::chrono::microseconds(static_cast<long long>(ms * 1000));
+        m_timers.push({at, seatKey, t.generation});
+    }
+
+    void send(int seatKey, Op op, const std::vector<uint8_t>& frame) {
+        Seat &s = m_tables[size_t(seatKey / 2)].seats[seatKey % 2];
+        s.pending = op;
+        s.sent = Clock::now();
+        size_t done = 0;
+        while (done < frame.size()) {
+            ssize_t n = write(s.fd, frame.data() + done, frame.size() - done);
+            if (n > 0) {
+                done += size_t(n);
+            } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+                pollfd p {s.fd, POLLOUT, 0};
+                poll(&p, 1, 100);
+            } else {
+                ++m_stats.errors;
+                endGame(seatKey / 2, false);
+                return;
+            }
+        }
+    }
+
+    void request(int seatKey, Op op) {
+        Table &t = m_tables[size_t(seatKey / 2)];
+        m_frame.clear();
+        WireWriter w(m_frame);
+        if (op == OpCreate) {
+            w.begin(MsgType::CreateGame);
+            w.u64(m_rng() | 1);
+        } else if (op == OpJoin) {
+            w.begin(MsgType::JoinGame);
+            w.u32(t.game);
+        } else {
+            w.begin(MsgType::GetState);
+            w.u32(t.game);
+        }
+        w.end();
+        send(seatKey, op, m_frame);
+    }
+
+    void onReadable(int seatKey) {
+        Table &t = m_tables[size_t(seatKey / 2)];
+        Seat &s = t.seats[seatKey % 2];
+        if (s.fd < 0) return;
+        uint8_t buf[4096];
+        for (;;) {
+            ssize_t n = read(s.fd, buf, sizeof buf);
+            if (n > 0) {
+                s.in.insert(s.in.end(), buf, buf + n);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) break;
+            ++m_stats.errors;
+            endGame(seatKey / 2, false);
+            return;
+        }
+
+        size_t pos = 0;
+        uint32_t generation = t.generation;
+        while (generation == t.generation && s.in.size() - pos >= 5) {
+            uint32_t len;
+            std::memcpy(&len, s.in.data() + pos, 4);
+            if (len == 0) {
+                // no type byte: the rest of the stream cannot be framed
+                ++m_stats.errors;
+                endGame(seatKey / 2, false);
+                return;
+            }
+            if (s.in.size() - pos - 4 < len) break;
+            WireReader r(s.in.data() + pos + 5, len - 1);
+            MsgType type = MsgType(s.in[pos + 4]);
+            pos += 4 + len;
+            onFrame(seatKey, type, r);
+        }
+        if (generation == t.generation) s.in.erase(s.in.begin(), s.in.begin() + long(pos));
+    }
+
+    void onFrame(int seatKey, MsgType type, WireReader& r) {
+        int index = seatKey / 2;
+        Table &t = m_tables[size_t(index)];
+        Seat &s = t.seats[seatKey % 2];
+        if (type != MsgType::OpponentMoved && s.pending != OpCount) {
+            if (measuring()) m_stats.ops[s.pending].record(uint64_t((Clock::now() - s.sent).count()));
+            s.pending = OpCount;
+        }
+
+        switch (type) {
+        case MsgType::Joined:
+            if (seatKey % 2 == 0) {
+                t.game = r.u32();
+                request(seatKey + 1, OpJoin);
+            } else {
+                thinkThenMove(seatKey - 1);
+            }
+            break;
+        case MsgType::State:
+            play(seatKey, r);
+            break;
+        case MsgType::MoveResult: {
+            r.u32();
+            bool ok = r.u8();
+            if (ok) {
+                ++m_stats.moves;
+                if (++t.plies >= m_opt.plies || t.passes >= 4) endGame(index, true);
+            } else {
+                ++m_stats.rejected;
+                endGame(index, false);
+            }
+            break;
+        }
+        case MsgType::OpponentMoved:
+            thinkThenMove(seatKey);
+            break;
+        default:
+            ++m_stats.errors;
+            endGame(index, false);
+            break;
+        }
+    }
+
+    // Hand the state the server sent to the thinker thread.
+    void play(int seatKey, WireReader& r) {
+        Table &t = m_tables[size_t(seatKey / 2)];
+        Job job;
+        job.seatKey = seatKey;
+        job.generation = t.generation;
+        job.received = Clock::now();
+        job.game = r.u32();
+        r.u8(); // current player
+        r.u32();
+        r.u32();
+        job.bag = r.u16();
+        uint8_t rack[GameRules::SymbolCount];
+        r.bytes(rack, sizeof rack);
+        r.bytes(job.board, sizeof job.board);
+        if (!r.ok()) {
+            ++m_stats.errors;
+            endGame(seatKey / 2, false);
+            return;
+        }
+        for (int i = 0; i < GameRules::SymbolCount; ++i) job.rack[i] = rack[i];
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            m_jobs.push_back(job);
+        }
+        m_jobReady.notify_one();
+    }
+
+    // Runs on its own thread so that replies are timestamped as they arrive,
+    // not after the event loop finishes someone else's move search.
+    void think() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_jobMutex);
+                m_jobReady.wait(lock, [&] { return m_quit || !m_jobs.empty(); });
+                if (m_quit) return;
+                job = m_jobs.front();
+                m_jobs.pop_front();
+            }
+
+            bool used[GameRules::CellCount];
+            for (int i = 0; i < GameRules::CellCount; ++i) used[i] = job.board[i] != '\0';
+            int seen = 0;
+            MoveGenerator gen(job.board, used, job.rack);
+            gen.forEach([&](const Move& m) {
+                if (seen == 0 || m.score > job.move.score) job.move = m;
+                return ++seen < m_opt.candidates;
+            });
+            job.found = seen > 0;
+
+            {
+                std::lock_guard<std::mutex> lock(m_jobMutex);
+                m_decisions.push_back(job);
+            }
+            uint64_t one = 1;
+            ssize_t ignored = write(m_wake, &one, sizeof one);
+            (void)ignored;
+        }
+    }
+
+    void onDecisions() {
+        uint64_t count;
+        ssize_t ignored = read(m_wake, &count, sizeof count);
+        (void)ignored;
+        std::deque<Job> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            ready.swap(m_decisions);
+        }
+        auto now = Clock::now();
+        for (const Job &job : ready) {
+            if (measuring()) m_stats.ops[OpSearch].record(uint64_t((now - job.received).count()));
+            Table &t = m_tables[size_t(job.seatKey / 2)];
+            if (job.generation == t.generation) sendMove(job);
+        }
+    }
+
+    void sendMove(const Job& job) {
+        int index = job.seatKey / 2;
+        Table &t = m_tables[size_t(index)];
+        m_frame.clear();
+        WireWriter w(m_frame);
+        if (job.found) {
+            t.passes = 0;
+            w.begin(MsgType::Place);
+            w.u32(job.game);
+            w.u8(uint8_t(job.move.count));
+            for (int i = 0; i < job.move.count; ++i) {
+                w.u8(uint8_t(job.move.tiles[i].row));
+                w.u8(uint8_t(job.move.tiles[i].col));
+                w.u8(uint8_t(job.move.tiles[i].ch));
+            }
+            w.end();
+            send(job.seatKey, OpPlace, m_frame);
+            return;
+        }
+
+        // Nothing to play: swap up to three tiles, or end a game that is stuck
+        char swapped[3];
+        int n = 0;
+        for (int sym = 0; sym < GameRules::OtherSymbolCount && n < 3 && n < job.bag; ++sym)
+            for (int k = 0; k < job.rack[sym] && n < 3 && n < job.bag; ++k) swapped[n++] = GameRules::symbolChar(sym);
+        if (n == 0) {
+            endGame(index, true);
+            return;
+        }
+        ++t.passes;
+        w.begin(MsgType::Swap);
+        w.u32(job.game);
+        w.u8(uint8_t(n));
+        for (int i = 0; i < n; ++i) w.u8(uint8_t(swapped[i]));
+        w.end();
+        send(job.seatKey, OpSwap, m_frame);
+    }
+
+    const Options& m_opt;
+    std::vector<Table> m_tables;
+    std::mt19937_64 m_rng;
+    std::normal_distribution<double> m_normal;
+    std::priority_queue<Timer> m_timers;
+    std::vector<uint8_t> m_frame;
+    Stats m_stats;
+    int m_epoll = -1;
+    const std::atomic<bool>* m_measuring = nullptr;
+
+    // Move searches handed to the thinker; finished ones wake the loop
+    std::thread m_thinker;
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobReady;
+    std::deque<Job> m_jobs;
+    std::deque<Job> m_decisions;
+    bool m_quit = false;
+    int m_wake = -1;
+};
+
+struct ProcSample {
+    bool ok = false;
+    double cpuSeconds = 0;
+    long rssKb = 0;
+};
+
+ProcSample sampleProcess(int pid) {
+    ProcSample s;
+    if (pid <= 0) return s;
+    char path[64];
+    std::snprintf(path, sizeof path, "/proc/%d/stat", pid);
+    if (std::FILE *f = std::fopen(path, "r")) {
+        // utime and stime are fields 14 and 15, after the parenthesised name
+        char line[1024];
+        if (std::fgets(line, sizeof line, f)) {
+            const char *p = std::strrchr(line, ')');
+            unsigned long long utime = 0, stime = 0;
+            if (p && std::sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+                                 &utime, &stime) == 2) {
+                s.cpuSeconds = double(utime + stime) / double(sysconf(_SC_CLK_TCK));
+                s.ok = true;
+            }
+        }
+        std::fclose(f);
+    }
+    std::snprintf(path, sizeof path, "/proc/%d/status", pid);
+    if (std::FILE *f = std::fopen(path, "r")) {
+        char line[256];
+        while (std::fgets(line, sizeof line, f)) {
+            if (std::sscanf(line, "VmRSS: %ld", &s.rssKb) == 1) break;
+        }
+        std::fclose(f);
+    }
+    return s;
+}
+
+double selfCpuSeconds() {
+    rusage ru {};
+    getrusage(RUSAGE_SELF, &ru);
+    return double(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) + double(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+struct LevelResult {
+    int games = 0;
+    double seconds = 0;
+    Stats stats;
+    ProcSample before, after;
+    double clientCpu = 0;
+};
+
+LevelResult runLevel(const Options& opt, int games) {
+    int threads = std::max(1, std::min(opt.threads, games));
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < threads; ++i) {
+        int share = games / threads + (i < games % threads ? 1 : 0);
+        workers.push_back(std::make_unique<Worker>(opt, share, opt.seed * 7919 + uint64_t(games) * 131 + uint64_t(i)));
+    }
+
+    std::atomic<bool> stop{false}, measuring{false};
+    std::vector<std::thread> pool;
+    for (auto &w : workers) pool.emplace_back([&, wp = w.get()] { wp->run(stop, measuring); });
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(opt.warmup));
+    LevelResult res;
+    res.games = games;
+    res.before = sampleProcess(opt.serverPid);
+    double cpu0 = selfCpuSeconds();
+    auto t0 = Clock::now();
+    measuring = true;
+    std::this_thread::sleep_for(std::chrono::duration<double>(opt.duration));
+    measuring = false;
+    res.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    res.clientCpu = selfCpuSeconds() - cpu0;
+    res.after = sampleProcess(opt.serverPid);
+
+    stop = true;
+    for (auto &th : pool) th.join();
+    for (auto &w : workers) res.stats.merge(w->stats());
+    return res;
+}
+
+double ms(uint64_t ns) { return double(ns) / 1e6; }
+
+void printLevel(const LevelResult& r, long baselineRssKb) {
+    const Stats &s = r.stats;
+    std::printf("\n== %d games, %.1f s ==\n", r.games, r.seconds);
+    std::printf("moves %llu (%.0f/s), games finished %llu, rejected %llu, errors %llu, connect failures %llu\n",
+                (unsigned long long)s.moves, double(s.moves) / r.seconds,
+                (unsigned long long)s.gamesFinished, (unsigned long long)s.rejected,
+                (unsigned long long)s.errors, (unsigned long long)s.connectFailures);
+    std::printf("  %-8s %9s %9s %9s %9s %9s %9s %9s\n", "op", "count", "mean ms", "p50", "p90", "p99", "p99.9", "max");
+    for (int op = 0; op < OpCount; ++op) {
+        const LatencyHistogram &h = s.ops[op];
+        if (!h.count()) continue;
+        std::printf("  %-8s %9llu %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n", kOpNames[op],
+                    (unsigned long long)h.count(), h.mean() / 1e6, ms(h.percentile(50)), ms(h.percentile(90)),
+                    ms(h.percentile(99)), ms(h.percentile(99.9)), ms(h.max()));
+    }
+    if (r.before.ok && r.after.ok) {
+        double cpu = r.after.cpuSeconds - r.before.cpuSeconds;
+        std::printf("server: %.1f%% of a core, %.1f us CPU per move, %.3f ms CPU per game-second, %.1f KiB RSS per game\n",
+                    100.0 * cpu / r.seconds, s.moves ? 1e6 * cpu / double(s.moves) : 0.0,
+                    1e3 * cpu / r.seconds / r.games, double(r.after.rssKb - baselineRssKb) / r.games);
+    }
+    std::printf("loadgen: %.1f%% of a core\n", 100.0 * r.clientCpu / r.seconds);
+}
+
+void writeHgrm(const Options& opt, const LevelResult& r) {
+    for (int op = 0; op < OpCount; ++op) {
+        if (!r.stats.ops[op].count()) continue;
+        std::string path = std::string(opt.hgrm) + "-" + std::to_string(r.games) + "-" + kOpNames[op] + ".hgrm";
+        if (std::FILE *f = std::fopen(path.c_str(), "w")) {
+            r.stats.ops[op].writeHgrm(f, 1e6);
+            std::fclose(f);
+        }
+    }
+}
+
+int usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "usage: %s [--unix PATH | --port N] [--spawn SERVER | --server-pid PID]\n"
+                 "          [--games N] [--max-games M] [--threads T] [--duration S] [--warmup S]\n"
+                 "          [--think-ms MS] [--slo-ms MS] [--plies N] [--candidates K] [--seed S]\n"
+                 "          [--hgrm PREFIX]\n", argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        if (i + 1 >= argc) return usage(argv[0]);
+        const char *v = argv[++i];
+        if (!std::strcmp(a, "--unix")) opt.unixPath = v;
+        else if (!std::strcmp(a, "--port")) opt.port = std::atoi(v);
+        else if (!std::strcmp(a, "--spawn")) opt.spawn = v;
+        else if (!std::strcmp(a, "--server-pid")) opt.serverPid = std::atoi(v);
+        else if (!std::strcmp(a, "--games")) opt.games = std::max(1, std::atoi(v));
+        else if (!std::strcmp(a, "--max-games")) opt.maxGames = std::atoi(v);
+        else if (!std::strcmp(a, "--threads")) opt.threads = std::atoi(v);
+        else if (!std::strcmp(a, "--duration")) opt.duration = std::atof(v);
+        else if (!std::strcmp(a, "--warmup")) opt.warmup = std::atof(v);
+        else if (!std::strcmp(a, "--think-ms")) opt.thinkMs = std::atof(v);
+        else if (!std::strcmp(a, "--slo-ms")) opt.sloMs = std::atof(v);
+        else if (!std::strcmp(a, "--plies")) opt.plies = std::max(1, std::atoi(v));
+        else if (!std::strcmp(a, "--candidates")) opt.candidates = std::max(1, std::atoi(v));
+        else if (!std::strcmp(a, "--seed")) opt.seed = std::strtoull(v, nullptr, 0);
+        else if (!std::strcmp(a, "--hgrm")) opt.hgrm = v;
+        else return usage(argv[0]);
+    }
+    if (opt.threads <= 0) opt.threads = int(std::max(1u, std::thread::hardware_concurrency() / 2)); // plus one thinker each
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // Two descriptors per game, on both sides
+    rlimit lim {};
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0) {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+
+    std::string spawnedSocket;
+    if (opt.spawn) {
+        spawnedSocket = "/tmp/equatix-loadgen-" + std::to_string(getpid()) + ".sock";
+        opt.unixPath = spawnedSocket.c_str();
+        pid_t pid = fork();
+        if (pid == 0) {
+            int null = open("/dev/null", O_WRONLY);
+            if (null >= 0) dup2(null, STDOUT_FILENO);
+            execl(opt.spawn, opt.spawn, "--unix", opt.unixPath, static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        opt.serverPid = pid;
+        int fd = -1;
+        for (int tries = 0; tries < 100 && (fd = connectServer(opt)) < 0; ++tries)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        if (fd < 0) {
+            std::fprintf(stderr, "%s did not start\n", opt.spawn);
+            kill(pid, SIGTERM);
+            return 1;
+        }
+        ::close(fd);
+    }
+
+    long baselineRss = sampleProcess(opt.serverPid).rssKb;
+    std::printf("think time median %.0f ms, %d plies per game, %d client threads\n",
+                opt.thinkMs, opt.plies, opt.threads);
+
+    int rc = 0;
+    LevelResult first;
+    int saturatedAt = 0;
+    bool clientBound = false;
+    for (int games = opt.games;; games *= 2) {
+        LevelResult r = runLevel(opt, games);
+        printLevel(r, baselineRss);
+        if (opt.hgrm) writeHgrm(opt, r);
+        if (r.stats.rejected || r.stats.errors) rc = 1;
+
+        if (first.games == 0) first = r;
+        double rate = double(r.stats.moves) / r.seconds;
+        double linear = double(first.stats.moves) / first.seconds * games / first.games;
+        double p99 = ms(r.stats.ops[OpPlace].percentile(99));
+        if (games > first.games && rate < 0.85 * linear) {
+            std::printf("saturated: %.0f moves/s is %.0f%% of linear scaling\n", rate, 100.0 * rate / linear);
+            saturatedAt = games;
+        } else if (p99 > opt.sloMs) {
+            std::printf("saturated: place p99 %.3f ms exceeds %.1f ms\n", p99, opt.sloMs);
+            saturatedAt = games;
+        }
+        if (saturatedAt && r.before.ok && r.after.ok) {
+            // Only a server that is the busier process has really saturated
+            double serverCpu = r.after.cpuSeconds - r.before.cpuSeconds;
+            clientBound = r.clientCpu > serverCpu;
+        }
+        if (saturatedAt || opt.maxGames <= 0 || games * 2 > opt.maxGames) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200)); // let the server drop the old games
+    }
+    if (opt.maxGames > 0) {
+        if (saturatedAt && clientBound)
+            std::printf("\nthe load generator saturated first at %d games; give it more cores or lower --candidates\n",
+                        saturatedAt);
+        else if (saturatedAt) std::printf("\nsaturation point: %d concurrent games\n", saturatedAt);
+        else std::printf("\nno saturation up to %d concurrent games\n", opt.maxGames);
+    }
+
+    if (opt.spawn) {
+        kill(opt.serverPid, SIGTERM);
+        waitpid(opt.serverPid, nullptr, 0);
+        unlink(spawnedSocket.c_str());
+    }
+    return rc;
+}
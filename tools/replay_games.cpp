@@ -0,0 +1,60 @@
+// Re-check recorded games against the current rules.
+//
+// Usage: equatix-replay [--repeat N] record...
+//
+// Every move is re-applied through GameState and its score and bag cursor are
+// compared with the record. --repeat replays each file N times for timing.
+
+#include "GameRecord.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+int main(int argc, char** argv) {
+    int repeat = 1;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) repeat = std::max(1, std::atoi(argv[++i]));
+        else paths.push_back(argv[i]);
+    }
+    if (paths.empty()) {
+        std::fprintf(stderr, "usage: %s [--repeat N] record...\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<std::vector<uint8_t>> records;
+    for (const char* path : paths) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "%s: cannot open\n", path);
+            return 2;
+        }
+        records.emplace_back(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    int failures = 0;
+    long long moves = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repeat; ++rep) {
+        for (size_t i = 0; i < records.size(); ++i) {
+            ReplayResult r = GameReplayer::replay(records[i].data(), records[i].size());
+            moves += r.plies;
+            if (rep > 0) continue;
+            if (r.ok) {
+                std::printf("%s: ok, %d moves, %d-%d\n", paths[i], r.plies, r.scores[0], r.scores[1]);
+            } else {
+                std::printf("%s: FAILED at move %d: %s\n", paths[i], r.plies + 1, r.error);
+                ++failures;
+            }
+        }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("%lld moves in %.3f s (%.0f moves/s)\n", moves, secs, secs > 0 ? moves / secs : 0.0);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+// Compare batch scoring (BatchScorer) with scoring moves one at a time.
+//
+// Usage: equatix-scorebench [--positions N] [--repeat R] [--seed S]
+//
+// Self-plays N mid-game positions and takes every legal move in each. Each
+// position is then scored R times per method:
+//   per-move       GameRules::scoreTurn on the board with the move's tiles added
+//   build          filling a ScoreBatch from the moves with ScoreBatch::add
+//   KERNEL         BatchScorer::score over the filled batch, for each kernel
+//                  the CPU supports
+//   build+KERNEL   both, the cost of batching moves that are already listed
+// and the moves are generated R times, scored two ways:
+//   generate       MoveGenerator::all, which scores each move with scoreTurn
+//   gen+KERNEL     MoveGenerator::all(ScoreBatch&), which hands over the runs
+//                  it has walked, then the best kernel
+// Every method must reproduce MoveGenerator's scores. Times are ns per move;
+// speedups compare whole jobs, batch building included.
+
+#include "BatchScorer.h"
+#include "GameState.h"
+#include "MoveGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Position {
+    char board[GameRules::CellCount];
+    bool used[GameRules::CellCount];
+    int rack[GameRules::SymbolCount];
+    std::vector<Move> moves;
+};
+
+// Mid-game positions with plenty of moves, from greedy self-play.
+std::vector<Position> makePositions(int count, uint64_t seed) {
+    std::vector<Position> out;
+    std::mt19937_64 rng(seed);
+    while (int(out.size()) < count) {
+        GameState game(rng());
+        int plies = 4 + int(rng() % 16);
+        for (int ply = 0; ply < plies; ++ply) {
+            Move m;
+            RuleCheck check;
+            int points;
+            if (!MoveGenerator(game).best(m) || !game.place(m.tiles, m.count, check, points)) break;
+        }
+        Position p;
+        std::memcpy(p.board, game.board(), sizeof p.board);
+        std::memcpy(p.used, game.multipliersUsed(), sizeof p.used);
+        std::memcpy(p.rack, game.rack(game.currentPlayer()), sizeof p.rack);
+        p.moves = MoveGenerator(game).all();
+        if (p.moves.size() >= 50) out.push_back(std::move(p));
+    }
+    return out;
+}
+
+template <class F>
+double timeNs(int repeat, F&& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) f();
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int positions = 40, repeat = 200;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--positions") == 0 && i + 1 < argc) positions = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) repeat = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 0);
+        else {
+            std::fprintf(stderr, "usage: %s [--positions N] [--repeat R] [--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Position> all = makePositions(positions, seed);
+    size_t moves = 0;
+    for (const Position &p : all) moves += p.moves.size();
+    std::printf("%zu positions, %zu moves, %d repeats\n\n", all.size(), moves, repeat);
+
+    const BatchScorer::Kernel kernels[] = {BatchScorer::Kernel::Scalar, BatchScorer::Kernel::Sse41, BatchScorer::Kernel::Avx2};
+    BatchScorer::Kernel best = BatchScorer::bestKernel();
+    double perMove = 0, build = 0, kernelNs[3] = {}, generate = 0, generateBatched = 0;
+    int mismatches = 0;
+    std::vector<int> scores;
+    ScoreBatch batch;
+    for (Position &p : all) {
+        scores.assign(p.moves.size(), 0);
+        perMove += timeNs(repeat, [&] {
+            for (size_t m = 0; m < p.moves.size(); ++m) {
+                const Move &mv = p.moves[m];
+                for (int t = 0; t < mv.count; ++t) p.board[mv.tiles[t].row*GameRules::BoardSize + mv.tiles[t].col] = mv.tiles[t].ch;
+                scores[m] = GameRules::scoreTurn(p.board, p.used, mv.tiles, mv.count);
+                for (int t = 0; t < mv.count; ++t) p.board[mv.tiles[t].row*GameRules::BoardSize + mv.tiles[t].col] = '\0';
+            }
+        });
+        for (size_t m = 0; m < p.moves.size(); ++m) mismatches += scores[m] != p.moves[m].score;
+
+        build += timeNs(repeat, [&] {
+            batch.clear(p.board);
+            for (const Move &mv : p.moves) batch.add(mv.tiles, mv.count);
+        });
+        BatchScorer scorer(p.used);
+        for (int k = 0; k < 3; ++k) {
+            if (!BatchScorer::supported(kernels[k])) continue;
+            scorer.setKernel(kernels[k]);
+            std::fill(scores.begin(), scores.end(), -1);
+            kernelNs[k] += timeNs(repeat, [&] { scorer.score(batch, scores.data()); });
+            for (size_t m = 0; m < p.moves.size(); ++m) mismatches += scores[m] != p.moves[m].score;
+        }
+
+        // Generation included, where the batch replaces scoreTurn
+        std::vector<Move> generated;
+        generate += timeNs(repeat, [&] { generated = MoveGenerator(p.board, p.used, p.rack).all(); });
+        scorer.setKernel(best);
+        generateBatched += timeNs(repeat, [&] {
+            generated = MoveGenerator(p.board, p.used, p.rack).all(batch);
+            scores.resize(generated.size());
+            scorer.score(batch, scores.data());
+        });
+        mismatches += generated.size() != p.moves.size();
+        for (size_t m = 0; m < p.moves.size() && m < generated.size(); ++m) mismatches += scores[m] != p.moves[m].score;
+    }
+
+    double n = double(moves) * repeat;
+    std::printf("%-14s %10s %10s\n", "method", "ns/move", "speedup");
+    std::printf("%-14s %10.2f %10s\n", "per-move", perMove / n, "1.00x");
+    std::printf("%-14s %10.2f %10s\n", "build", build / n, "");
+    for (int k = 0; k < 3; ++k) {
+        if (!BatchScorer::supported(kernels[k])) continue;
+        std::printf("%-14s %10.2f %10s\n", BatchScorer::kernelName(kernels[k]), kernelNs[k] / n, "");
+    }
+    for (int k = 0; k < 3; ++k) {
+        if (!BatchScorer::supported(kernels[k])) continue;
+        std::string name = std::string("build+") + BatchScorer::kernelName(kernels[k]);
+        std::printf("%-14s %10.2f %9.2fx\n", name.c_str(), (build + kernelNs[k]) / n, perMove / (build + kernelNs[k]));
+    }
+    std::string batched = std::string("gen+") + BatchScorer::kernelName(best);
+    std::printf("\n%-14s %10.2f %10s\n", "generate", generate / n, "1.00x");
+    std::printf("%-14s %10.2f %9.2fx\n", batched.c_str(), generateBatched / n, generate / generateBatched);
+    if (mismatches) {
+        std::printf("\n%d scores differ from MoveGenerator\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
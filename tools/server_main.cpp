@@ -0,0 +1,71 @@
+// Equatix game server.
+//
+// Usage: equatix-server [--port N] [--unix PATH] [--metrics-file PATH]
+//
+// Listens on 127.0.0.1:N (default 7415) and/or a Unix socket and hosts any
+// number of concurrent games until interrupted. --metrics-file keeps a
+// Prometheus textfile (for node_exporter's textfile collector) up to date.
+
+#include "GameServer.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/resource.h>
+
+namespace {
+
+GameServer* g_server = nullptr;
+
+void onSignal(int) {
+    if (g_server) g_server->stop();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int port = -1;
+    const char* unixPath = nullptr;
+    const char* metricsPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) port = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--unix") == 0 && i + 1 < argc) unixPath = argv[++i];
+        else if (std::strcmp(argv[i], "--metrics-file") == 0 && i + 1 < argc) metricsPath = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--port N] [--unix PATH] [--metrics-file PATH]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (port < 0 && !unixPath) port = 7415;
+
+    // One descriptor per seated player
+    rlimit lim {};
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0) {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+
+    GameServer server;
+    if (metricsPath) server.setMetricsFile(metricsPath);
+    if (port >= 0 && !server.listenTcp(uint16_t(port))) {
+        std::fprintf(stderr, "cannot listen on port %d\n", port);
+        return 1;
+    }
+    if (unixPath && !server.listenUnix(unixPath)) {
+        std::fprintf(stderr, "cannot listen on %s\n", unixPath);
+        return 1;
+    }
+
+    g_server = &server;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+    if (port >= 0) std::printf("listening on 127.0.0.1:%d\n", port);
+    if (unixPath) std::printf("listening on %s\n", unixPath);
+    std::fflush(stdout);
+
+    int rc = server.run();
+    std::printf("stopped with %zu games, %zu connections\n", server.gameCount(), server.connectionCount());
+    return rc;
+}
@@ -0,0 +1,238 @@
+// Round-robin tournament between bots (see BotPlayer.h for the specs).
+//
+// Usage: equatix-tournament [--seeds N] [--seed S] [--threads T] [--max-plies N]
+//                           [--sprt ELO0 ELO1] [--alpha A] [--beta B] BOT BOT...
+//
+// Every pair of bots plays each of N bag seeds twice with the seats swapped,
+// so both sides get the same draws and most of the luck cancels. Game pairs
+// run in parallel. With --sprt a pairing stops as soon as a sequential
+// probability ratio test over game-pair scores tells whether the first bot is
+// ELO1 stronger or no more than ELO0 (the normal approximation used by chess
+// engine testers). A game ends when both players pass in a row or after
+// --max-plies turns. Reports pairwise Elo with 95% intervals, each bot's
+// score against the field, games/s and think time per move for every bot.
+
+#include "BotPlayer.h"
+#include "GameState.h"
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int seeds = 200;
+    uint64_t seed = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int maxPlies = 200;
+    bool sprt = false;
+    double elo0 = 0, elo1 = 10;
+    double alpha = 0.05, beta = 0.05;
+};
+
+// Results of one pairing from the first bot's side.
+struct Pairing {
+    int a, b;
+    int wins = 0, draws = 0, losses = 0;
+    int pairs = 0;
+    double sum = 0, sumSq = 0;  // of game-pair scores in [0, 1]
+    double llr = 0;
+    const char* verdict = nullptr;
+};
+
+uint64_t splitmix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+double expectedScore(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+double eloOf(double score) {
+    score = std::clamp(score, 1e-3, 1.0 - 1e-3);
+    return 0.0 - 400.0 * std::log10(1.0 / score - 1.0);     // 0, not -0, for an even score
+}
+
+// Final scores of one game; think gets the time of every decision per bot.
+void playGame(const Options& opt, const BotPlayer* const seats[2], const int botOf[2], uint64_t bagSeed,
+              std::vector<LatencyHistogram>& think, int scores[2]) {
+    GameState game(bagSeed);
+    std::mt19937_64 rng(splitmix(bagSeed ^ uint64_t(botOf[0]) << 32 ^ uint64_t(botOf[1])));
+    int passes = 0;
+    for (int ply = 0; ply < opt.maxPlies && passes < 2; ++ply) {
+        int p = game.currentPlayer();
+        auto t0 = std::chrono::steady_clock::now();
+        BotAction action = seats[p]->choose(game, rng);
+        think[size_t(botOf[p])].record(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count()));
+        int points;
+        if (!BotPlayer::apply(game, action, points)) {
+            // A bot bug; count it as a pass rather than stall the game
+            game.pass();
+            action.kind = BotAction::Pass;
+        }
+        passes = action.kind == BotAction::Pass ? passes + 1 : 0;
+    }
+    scores[0] = game.score(0);
+    scores[1] = game.score(1);
+}
+
+// Variance of a game-pair score, with two pseudo pairs half a point either
+// side of the mean. A few identical results (every pair split 1-1, say) then
+// still leave a wide interval; the pseudo pairs fade as real ones pile up.
+double pairVariance(const Pairing& pr) {
+    double mean = pr.sum / pr.pairs;
+    double observed = std::max(0.0, pr.sumSq / pr.pairs - mean * mean);
+    return (observed * pr.pairs + 0.5) / (pr.pairs + 2);
+}
+
+void updateSprt(const Options& opt, Pairing& pr) {
+    if (!opt.sprt || pr.pairs < 2) return;
+    double mean = pr.sum / pr.pairs;
+    double var = pairVariance(pr);
+    double s0 = expectedScore(opt.elo0), s1 = expectedScore(opt.elo1);
+    pr.llr = pr.pairs * (s1 - s0) * (2 * mean - s0 - s1) / (2 * var);
+    if (pr.llr >= std::log((1 - opt.beta) / opt.alpha)) pr.verdict = "H1";
+    else if (pr.llr <= std::log(opt.beta / (1 - opt.alpha))) pr.verdict = "H0";
+}
+
+int usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "usage: %s [--seeds N] [--seed S] [--threads T] [--max-plies N]\n"
+                 "          [--sprt ELO0 ELO1] [--alpha A] [--beta B] BOT BOT...\n"
+                 "bots: greedy, sim[:K[:S]], endgame[:T[:K]]\n", argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    std::vector<std::unique_ptr<BotPlayer>> bots;
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        if (!std::strcmp(a, "--seeds") && i + 1 < argc) opt.seeds = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(a, "--seed") && i + 1 < argc) opt.seed = std::strtoull(argv[++i], nullptr, 0);
+        else if (!std::strcmp(a, "--threads") && i + 1 < argc) opt.threads = unsigned(std::max(1, std::atoi(argv[++i])));
+        else if (!std::strcmp(a, "--max-plies") && i + 1 < argc) opt.maxPlies = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(a, "--alpha") && i + 1 < argc) opt.alpha = std::atof(argv[++i]);
+        else if (!std::strcmp(a, "--beta") && i + 1 < argc) opt.beta = std::atof(argv[++i]);
+        else if (!std::strcmp(a, "--sprt") && i + 2 < argc) {
+            opt.sprt = true;
+            opt.elo0 = std::atof(argv[++i]);
+            opt.elo1 = std::atof(argv[++i]);
+        }
+        else if (a[0] != '-') {
+            bots.push_back(BotPlayer::create(a));
+            if (!bots.back()) {
+                std::fprintf(stderr, "%s: unknown bot\n", a);
+                return 2;
+            }
+        }
+        else return usage(argv[0]);
+    }
+    if (bots.size() < 2 || opt.alpha <= 0 || opt.beta <= 0 || opt.alpha >= 1 || opt.beta >= 1)
+        return usage(argv[0]);
+
+    std::vector<Pairing> pairings;
+    for (int a = 0; a < int(bots.size()); ++a)
+        for (int b = a + 1; b < int(bots.size()); ++b) pairings.push_back({a, b});
+
+    // Seed-major order keeps every pairing moving at the same pace
+    const uint64_t jobs = uint64_t(opt.seeds) * pairings.size();
+    std::atomic<uint64_t> next{0};
+    std::atomic<uint64_t> games{0};
+    std::mutex lock;
+    std::vector<LatencyHistogram> think(bots.size());
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < opt.threads; ++t) {
+        pool.emplace_back([&] {
+            std::vector<LatencyHistogram> mine(bots.size());
+            for (uint64_t j; (j = next++) < jobs;) {
+                Pairing &pr = pairings[j % pairings.size()];
+                {
+                    std::lock_guard<std::mutex> g(lock);
+                    if (pr.verdict) continue;
+                }
+                uint64_t bagSeed = splitmix(opt.seed + j / pairings.size());
+                double pairScore = 0;
+                int outcome[2];
+                for (int swap = 0; swap < 2; ++swap) {
+                    const BotPlayer *seats[2] = {bots[size_t(pr.a)].get(), bots[size_t(pr.b)].get()};
+                    int botOf[2] = {pr.a, pr.b};
+                    if (swap) {
+                        std::swap(seats[0], seats[1]);
+                        std::swap(botOf[0], botOf[1]);
+                    }
+                    int scores[2];
+                    playGame(opt, seats, botOf, bagSeed, mine, scores);
+                    int aScore = scores[swap], bScore = scores[1 - swap];
+                    outcome[swap] = aScore > bScore ? 2 : aScore == bScore ? 1 : 0;
+                    pairScore += outcome[swap] / 4.0;
+                }
+                games += 2;
+                std::lock_guard<std::mutex> g(lock);
+                if (pr.verdict) continue;   // decided while this pair was playing
+                for (int o : outcome) (o == 2 ? pr.wins : o == 1 ? pr.draws : pr.losses)++;
+                ++pr.pairs;
+                pr.sum += pairScore;
+                pr.sumSq += pairScore * pairScore;
+                updateSprt(opt, pr);
+            }
+            std::lock_guard<std::mutex> g(lock);
+            for (size_t b = 0; b < bots.size(); ++b) think[b].merge(mine[b]);
+        });
+    }
+    for (auto &th : pool) th.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("%llu games in %.1f s (%.1f games/s) on %u threads\n\n",
+                (unsigned long long)games.load(), secs, double(games.load()) / secs, opt.threads);
+    std::printf("%-14s %-14s %7s %7s %7s %7s %8s %13s", "bot", "vs", "pairs", "wins", "draws", "losses", "score", "elo (95%)");
+    if (opt.sprt) std::printf(" %8s  sprt [%g, %g]", "llr", opt.elo0, opt.elo1);
+    std::printf("\n");
+    std::vector<double> botScore(bots.size(), 0), botGames(bots.size(), 0);
+    for (const Pairing &pr : pairings) {
+        int n = pr.wins + pr.draws + pr.losses;
+        double mean = pr.pairs ? pr.sum / pr.pairs : 0.5;
+        double sd = pr.pairs ? std::sqrt(pairVariance(pr) / pr.pairs) : 0.5;
+        std::printf("%-14s %-14s %7d %7d %7d %7d %7.1f%% %+5.0f %+4.0f/%+4.0f",
+                    bots[size_t(pr.a)]->name().c_str(), bots[size_t(pr.b)]->name().c_str(),
+                    pr.pairs, pr.wins, pr.draws, pr.losses, 100.0 * mean,
+                    eloOf(mean), eloOf(mean - 1.96 * sd) - eloOf(mean), eloOf(mean + 1.96 * sd) - eloOf(mean));
+        if (opt.sprt) {
+            std::printf(" %8.2f  %s", pr.llr,
+                        !pr.verdict ? "undecided" : pr.verdict[1] == '1' ? "H1: first is stronger" : "H0: no gain");
+        }
+        std::printf("\n");
+        botScore[size_t(pr.a)] += pr.wins + 0.5 * pr.draws;
+        botScore[size_t(pr.b)] += pr.losses + 0.5 * pr.draws;
+        botGames[size_t(pr.a)] += n;
+        botGames[size_t(pr.b)] += n;
+    }
+
+    std::printf("\n%-14s %7s %8s %9s %9s %9s %9s %9s\n", "bot", "games", "score", "elo/field",
+                "think ms", "p50", "p99", "max");
+    for (size_t b = 0; b < bots.size(); ++b) {
+        double score = botGames[b] ? botScore[b] / botGames[b] : 0.5;
+        const LatencyHistogram &h = think[b];
+        std::printf("%-14s %7.0f %7.1f%% %+9.0f %9.3f %9.3f %9.3f %9.3f\n", bots[b]->name().c_str(),
+                    botGames[b], 100.0 * score, eloOf(score), h.mean() / 1e6,
+                    double(h.percentile(50)) / 1e6, double(h.percentile(99)) / 1e6, double(h.max()) / 1e6);
+    }
+    return 0;
+}